@@ -310,6 +310,53 @@ IZOT_EXTERNAL_FN LonStatusCode IzotPropagateByIndex(signed index)
     return LonStatusNoError;
 }
 
+/*
+ * Propagates a list of bound output datapoints in one pass.
+ * Parameters:
+ *   indices: Indices of the datapoints to propagate
+ *   count: Number of entries in indices
+ *   results: Receives the status for each entry of indices; may be NULL
+ * Returns:
+ *   LonStatusNoError if every datapoint was scheduled or needed no update,
+ *   otherwise the status of the first datapoint that failed.
+ * Notes:
+ *   Each datapoint is handled like <IzotPropagateByIndex>, including its
+ *   <IzotDatapointUpdateCompleted> event, but the bound output list is
+ *   checked once for the whole batch and the queue space for each datapoint
+ *   is reserved before it is scheduled.
+ *
+ *   A datapoint that does not fit in the queue gets LonStatusNoBufferAvailable
+ *   and no completion event; propagate it again later.  An invalid index gets
+ *   LonStatusIndexInvalid.
+ */
+IZOT_EXTERNAL_FN LonStatusCode IzotPropagateBatch(const signed *indices, unsigned count,
+        LonStatusCode *results)
+{
+    return PropagateBatch(indices, count, results);
+}
+
+/*
+ * Propagates the bound output datapoints marked in a dirty bitmap.
+ * Parameters:
+ *   dirtyMap: One bit per datapoint index; bit (index % 8) of byte
+ *             (index / 8) marks the datapoint with that index
+ *   mapSize: Number of bytes in dirtyMap
+ * Returns:
+ *   LonStatusNoError if all marked datapoints were handled, or
+ *   LonStatusNoBufferAvailable if some are still marked.
+ * Notes:
+ *   The application sets the bit of each datapoint it changes during a scan
+ *   cycle and calls this function once at the end of the cycle.  The bit of
+ *   each datapoint scheduled is cleared.  If the queue fills up, the bits of
+ *   the datapoints not yet scheduled stay set for the next call.  Marked
+ *   datapoints that are not bound outputs are cleared without an update or
+ *   an <IzotDatapointUpdateCompleted> event.
+ */
+IZOT_EXTERNAL_FN LonStatusCode IzotPropagateDirty(IzotByte *dirtyMap, unsigned mapSize)
+{
+    return PropagateDirty(dirtyMap, mapSize);
+}
+
 /*
  * Propagates a Service message.
  * Parameters:
@@ -713,6 +760,9 @@ IZOT_EXTERNAL_FN LonStatusCode IzotQueryAddressConfig(unsigned index,
         IzotAddress *const pAddress)
 {
     IzotAddress *p = (IzotAddress *)AccessAddress(index);
+    if (p == NULL) {
+        return LonStatusInvalidAddrTableIndex;
+    }
     memcpy(pAddress, p, sizeof(IzotAddress));
     return LonStatusNoError;
 }
@@ -731,14 +781,17 @@ IZOT_EXTERNAL_FN LonStatusCode IzotUpdateAddressConfig(unsigned index,
         const IzotAddress *const pAddress)
 {
     uint32_t oldaddr, newaddr;
-    oldaddr = BROADCAST_PREFIX | 0x100 | eep->addrTable[index].Group.Group;
+    if (index >= gp->addrTableSize) {
+        return LonStatusInvalidAddrTableIndex;
+    }
+    oldaddr = BROADCAST_PREFIX | 0x100 | gp->addrTable[index].Group.Group;
     UpdateAddress((const IzotAddress *)pAddress, index);
 
 #if LINK_IS(UDP)
     // If the new update request for this entry is a group entry
     // then add the new group address
-    newaddr = BROADCAST_PREFIX | 0x100 | eep->addrTable[index].Group.Group;
-    if (IZOT_GET_ATTRIBUTE(eep->addrTable[index].Group, IZOT_ADDRESS_GROUP_TYPE) == 1 &&
+    newaddr = BROADCAST_PREFIX | 0x100 | gp->addrTable[index].Group.Group;
+    if (IZOT_GET_ATTRIBUTE(gp->addrTable[index].Group, IZOT_ADDRESS_GROUP_TYPE) == 1 &&
             oldaddr != newaddr) {
         RemoveIPMembership(oldaddr);
         AddIpMembership(newaddr);
@@ -768,7 +821,10 @@ IZOT_EXTERNAL_FN LonStatusCode IzotUpdateAddressConfig(unsigned index,
 IZOT_EXTERNAL_FN LonStatusCode IzotQueryDpConfig(signed index,
         IzotDatapointConfig *const pDatapointConfig)
 {
-    memcpy(pDatapointConfig, &eep->nvConfigTable[index], sizeof(IzotDatapointConfig));
+    if (index < 0 || index >= gp->nvTableCapacity) {
+        return LonStatusInvalidDatapointIndex;
+    }
+    memcpy(pDatapointConfig, &gp->nvConfigTable[index], sizeof(IzotDatapointConfig));
     return LonStatusNoError;
 }
 
@@ -788,7 +844,10 @@ IZOT_EXTERNAL_FN LonStatusCode IzotQueryDpConfig(signed index,
 IZOT_EXTERNAL_FN LonStatusCode IzotUpdateDpConfig(signed index,
         const IzotDatapointConfig *const pDatapointConfig)
 {
-    memcpy(&eep->nvConfigTable[index], pDatapointConfig, sizeof(IzotDatapointConfig));
+    if (index < 0 || index >= gp->nvTableCapacity) {
+        return LonStatusInvalidDatapointIndex;
+    }
+    memcpy(&gp->nvConfigTable[index], pDatapointConfig, sizeof(IzotDatapointConfig));
     OsalPrintLog(INFO_LOG, LonStatusNoError, "IzotUpdateDpConfig: NV index %d", index);
     RecomputeChecksum();
     LCS_WritePersistentNetworkImage();
@@ -913,6 +972,35 @@ IZOT_EXTERNAL_FN LonStatusCode IzotDatapointBind(int nvIndex, IzotByte address,
     return (status);
 }
 
+/*
+ * Sets the minimum and maximum send times of an output datapoint (NV).
+ * Parameters:
+ *   nvIndex: Datapoint (NV) index of a registered output datapoint
+ *   minSendTime: Minimum time between updates in milliseconds; 0 for none
+ *   maxSendTime: Maximum time between updates in milliseconds; 0 for none
+ * Returns:
+ *   LonStatusNoError if no error, otherwise a <LonStatusCode> error code.
+ * Notes:
+ *   Call this function after the datapoint is registered.  A propagate within
+ *   minSendTime of the previous update is held back, and the latest value is
+ *   sent when minSendTime has passed.  If maxSendTime passes without an update,
+ *   the LON Stack propagates the current value as a heartbeat.  Held back
+ *   updates and heartbeats generate <IzotDatapointUpdateCompleted> events
+ *   like other propagates.
+ *
+ *   If nvIndex is the first element of an array, the send times apply to each
+ *   element.  Set both times to 0 to remove them.  Up to NV_SEND_TIME_COUNT
+ *   datapoints can have send times.
+ */
+IZOT_EXTERNAL_FN LonStatusCode IzotDatapointSendTimes(int nvIndex, unsigned minSendTime,
+        unsigned maxSendTime)
+{
+    if (nvIndex < 0 || nvIndex >= gp->nvTableCapacity) {
+        return LonStatusIndexInvalid;
+    }
+    return SetNVSendTimes(nvIndex, minSendTime, maxSendTime);
+}
+
 /*
  * Requests a copy of alias configuration data.
  * Parameters:
@@ -929,8 +1017,10 @@ IZOT_EXTERNAL_FN LonStatusCode IzotQueryAliasConfig(unsigned index,
         IzotAliasConfig *const pAlias)
 {
     LonStatusCode status = LonStatusNoError;
-    if (pAlias) {
-        memcpy(pAlias, &eep->nvAliasTable[index], sizeof(IzotAliasConfig));
+    if (index >= gp->nvAliasTableSize) {
+        status = LonStatusInvalidDatapointIndex;
+    } else if (pAlias) {
+        memcpy(pAlias, &gp->nvAliasTable[index], sizeof(IzotAliasConfig));
     } else {
         status = LonStatusInvalidParameter;
         OsalPrintLog(ERROR_LOG, status,
@@ -953,7 +1043,10 @@ IZOT_EXTERNAL_FN LonStatusCode IzotQueryAliasConfig(unsigned index,
 IZOT_EXTERNAL_FN LonStatusCode IzotUpdateAliasConfig(unsigned index,
         const IzotAliasConfig *const pAlias)
 {
-    memcpy(&eep->nvAliasTable[index], pAlias, sizeof(IzotAliasConfig));
+    if (index >= gp->nvAliasTableSize) {
+        return LonStatusInvalidDatapointIndex;
+    }
+    memcpy(&gp->nvAliasTable[index], pAlias, sizeof(IzotAliasConfig));
     RecomputeChecksum();
     LCS_WritePersistentNetworkImage();
     return LonStatusNoError;
@@ -1097,7 +1190,7 @@ IZOT_EXTERNAL_FN int IzotPersistentSegGetMaxSize(
     int length = 0;
     switch (persistent_seg_type) {
     case IzotPersistentSegNetworkImage:
-        length = (sizeof(*eep) - sizeof(eep->readOnlyData));
+        length = (sizeof(*eep) - sizeof(eep->readOnlyData)) + LCS_ConfigTablesSize();
         break;
     case IzotPersistentSegApplicationData:
         length = IzotGetAppSegmentSize();
@@ -1228,6 +1321,10 @@ IZOT_EXTERNAL_FN LonStatusCode IzotCreateStack(
     memset(cp->key[1], 0, IZOT_AUTHENTICATION_KEY_LENGTH);
     DataPointCount = pInterface->StaticDatapoints;
     AliasTableCount = pInterface->Aliases;
+    cp->nvCnt = pInterface->MaxDatapoints > pInterface->StaticDatapoints
+                        ? pInterface->MaxDatapoints
+                        : pInterface->StaticDatapoints;
+    cp->aliasCnt = pInterface->Aliases;
     BindableMTagCount = pInterface->BindableMsgTags;
     OsalPrintLog(INFO_LOG, LonStatusNoError,
             "IzotCreateStack: Initialized with %d static datapoints, %d aliases, and %d "
@@ -1595,7 +1692,7 @@ unsigned IzotGetCurrentDatapointSize(const unsigned index)
     unsigned result = NV_LENGTH(index);
 
     if (izot_get_dp_size_handler &&
-            IZOT_GET_ATTRIBUTE(izot_dp_prop[index], IZOT_DATAPOINT_CHANGEABLE_TYPE)) {
+            IZOT_GET_ATTRIBUTE(gp->dpProp[index], IZOT_DATAPOINT_CHANGEABLE_TYPE)) {
         const unsigned application_size = izot_get_dp_size_handler(index);
         if (application_size && application_size != (unsigned)-1) {
             result = application_size;
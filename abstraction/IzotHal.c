@@ -51,8 +51,10 @@ extern void sync(void);
 #include <stdio.h>
 #include <string.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 
 #ifdef __APPLE__
 #include <ifaddrs.h>
@@ -62,6 +64,10 @@ extern void sync(void);
 
 #ifdef __linux__
 #include <linux/if_packet.h>
+#if USB_UPLINK_IS(EPOLL)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif  // USB_UPLINK_IS(EPOLL)
 #endif  // __linux__
 #include <errno.h>
 #include <fcntl.h>
@@ -120,8 +126,19 @@ static const char *configDirectoryDefault = "/var/lib/lon-device-stack";
 // Overridable via LON_STACK_DX_CONFIG_FILE environment variable
 static char configDirectory[512] = "";
 // LON Stack configuration directory
-static int storageFd[IzotPersistentSegNumSegmentTypes] = {-1};
+static int storageFd[IzotPersistentSegNumSegmentTypes] = {
+    -1,  // IzotPersistentSegNetworkImage
+    -1,  // IzotPersistentSegSecurityII
+    -1,  // IzotPersistentSegNodeDefinition
+    -1,  // IzotPersistentSegApplicationData
+    -1,  // IzotPersistentSegUniqueId
+    -1,  // IzotPersistentSegConnectionTable
+    -1,  // IzotPersistentSegIsi
+};
 // File descriptors for segment data storage devices
+static int iupImageFd = -1;           // Image update (IUP) image file
+static IzotByte *iupImageMap = NULL;  // Mapping of the IUP image file
+static size_t iupImageSize = 0;       // Size of the IUP image file in bytes
 static const char *iface = "eth0";  // Hardware dependent IP interface name
 #elif PROCESSOR_IS(STM32)
 USBH_HandleTypeDef hUsbHostFS;
@@ -702,6 +719,139 @@ LonStatusCode HalReadStorageSegment(const IzotPersistentSegType persistent_seg_t
 #endif
 }
 
+/*
+ * Opens the image update (IUP) image file and maps it into memory.
+ * Parameters:
+ *   size: size of the image file in bytes
+ *   image: pointer to the returned start of the mapped file
+ * Returns:
+ *   LonStatusNoError on success, or a LonStatusCode error code on failure.
+ * Notes:
+ *   The file holds the IUP persistent data and the passive image partition
+ *   and is created in the configuration directory.  A new or resized file
+ *   is filled with the erased flash value 0xFF.  Data written to the
+ *   mapping is in the file, but is only safe from a power failure after
+ *   HalSyncIupImage().
+ */
+LonStatusCode HalOpenIupImage(size_t size, IzotByte **image)
+{
+#if OS_IS(LINUX)
+    char image_file_path[sizeof(configDirectory) + sizeof("/iup_image")];
+    struct stat st;
+    void *map;
+
+    if (iupImageMap != NULL) {
+        // Already open
+        *image = iupImageMap;
+        return LonStatusNoError;
+    }
+    if (!LON_SUCCESS(HalInitStorage())) {
+        return persistentMemError;
+    }
+    snprintf(image_file_path, sizeof(image_file_path), "%s/iup_image", configDirectory);
+    iupImageFd = open(image_file_path, O_RDWR | O_CREAT, 0644);
+    if (iupImageFd == -1) {
+        OsalPrintLog(ERROR_LOG, LonStatusPersistentDataAccessError,
+                "HalOpenIupImage: Cannot open or create %s, %s system error (errno %d)",
+                image_file_path, strerror(errno), errno);
+        return LonStatusPersistentDataAccessError;
+    }
+    if (fstat(iupImageFd, &st) != 0 ||
+            ((size_t)st.st_size != size && ftruncate(iupImageFd, (off_t)size) != 0)) {
+        OsalPrintLog(ERROR_LOG, LonStatusPersistentDataAccessError,
+                "HalOpenIupImage: Cannot set size of %zu for %s, %s system error "
+                "(errno %d)",
+                size, image_file_path, strerror(errno), errno);
+        close(iupImageFd);
+        iupImageFd = -1;
+        return LonStatusPersistentDataAccessError;
+    }
+    map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, iupImageFd, 0);
+    if (map == MAP_FAILED) {
+        OsalPrintLog(ERROR_LOG, LonStatusPersistentDataAccessError,
+                "HalOpenIupImage: Cannot map %s, %s system error (errno %d)",
+                image_file_path, strerror(errno), errno);
+        close(iupImageFd);
+        iupImageFd = -1;
+        return LonStatusPersistentDataAccessError;
+    }
+    iupImageMap = map;
+    iupImageSize = size;
+    if ((size_t)st.st_size != size) {
+        memset(iupImageMap, 0xFF, size);
+    }
+    OsalPrintLog(INFO_LOG, LonStatusNoError, "HalOpenIupImage: Mapped %zu byte image %s",
+            size, image_file_path);
+    *image = iupImageMap;
+    return LonStatusNoError;
+#else
+    OsalPrintLog(ERROR_LOG, LonStatusPersistentDataAccessError,
+            "HalOpenIupImage: No image file support available");
+    return LonStatusPersistentDataAccessError;
+#endif  // OS_IS(LINUX)
+}
+
+/*
+ * Writes changes to a range of the mapped IUP image file to storage.
+ * Parameters:
+ *   start: offset in bytes from the start of the image file
+ *   size: number of bytes to write
+ * Returns:
+ *   LonStatusNoError on success, or a LonStatusCode error code on failure.
+ * Notes:
+ *   Returns when the range is in storage.  Only pages changed since the
+ *   last sync are written, so callers sync a batch of writes at once.
+ */
+LonStatusCode HalSyncIupImage(size_t start, size_t size)
+{
+#if OS_IS(LINUX)
+    size_t pageOffset = start % (size_t)sysconf(_SC_PAGESIZE);
+
+    if (iupImageMap == NULL || start + size > iupImageSize) {
+        return LonStatusPersistentDataAccessError;
+    }
+    // msync() requires a page aligned start
+    if (msync(iupImageMap + start - pageOffset, size + pageOffset, MS_SYNC) != 0) {
+        OsalPrintLog(ERROR_LOG, LonStatusPersistentDataAccessError,
+                "HalSyncIupImage: Cannot sync %zu bytes at offset %zu, %s system error "
+                "(errno %d)",
+                size, start, strerror(errno), errno);
+        return LonStatusPersistentDataAccessError;
+    }
+    return LonStatusNoError;
+#else
+    return LonStatusPersistentDataAccessError;
+#endif  // OS_IS(LINUX)
+}
+
+/*
+ * Unmaps and closes the IUP image file.
+ * Parameters:
+ *   None
+ * Returns:
+ *   LonStatusNoError on success, or a LonStatusCode error code on failure.
+ * Notes:
+ *   The whole file is synced first.
+ */
+LonStatusCode HalCloseIupImage(void)
+{
+#if OS_IS(LINUX)
+    LonStatusCode status = LonStatusNoError;
+
+    if (iupImageMap != NULL) {
+        status = HalSyncIupImage(0, iupImageSize);
+        munmap(iupImageMap, iupImageSize);
+        close(iupImageFd);
+        iupImageMap = NULL;
+        iupImageSize = 0;
+        iupImageFd = -1;
+    }
+    return status;
+#else
+    return LonStatusNoError;
+#endif  // OS_IS(LINUX)
+}
+
 /*****************************************************************
  * Section: USB Interface Function Declarations
  *****************************************************************/
@@ -1132,16 +1282,100 @@ LonStatusCode HalWriteUsb(int usb_fd, const void *buf, size_t len, size_t *bytes
         *bytes_written = 0;
     }
 #if OS_IS(LINUX)
+    // Write a single buffer with the gather write implementation
+    HalUsbIoVec iov;
+    iov.base = buf;
+    iov.len = len;
+    status = HalWriteUsbV(usb_fd, &iov, 1, bytes_written);
+#elif PROCESSOR_IS(STM32)
+    // Check the flag we set in HalOpenUsb() to ensure the U60 is fully enumerated
+    if (!is_usb_cdc_ready) {
+        status = LonStatusNotOpen;
+        OsalPrintLog(ERROR_LOG, status,
+                "HalWriteUsb: Attempt to write before LON USB interface is ready");
+        return status;  // Port is not ready
+    }
+
+    // Attempt to transmit using the STM32 USB Host Library
+    USBH_StatusTypeDef usbh_status =
+            USBH_CDC_Transmit(&hUsbHostFS, (uint8_t *)pData, (uint32_t)dataLen);
+    if (usbh_status == USBH_OK) {
+        // Success: Return the number of bytes written so the LON stack proceeds
+        if (bytes_written) {
+            *bytes_written = (size_t)dataLen;
+        }
+        return status;
+    } else if (usbh_status == USBH_BUSY) {
+        // The USB hardware is currently busy transmitting a previous packet.
+        // Returning 0 tells the LON stack that no bytes were written yet,
+        // allowing it to safely buffer/retry on the next tick without dropping
+        // data.
+        return status;
+    } else {
+        // Hardware error or disconnection
+        status = LonStatusInterfaceError;
+        OsalPrintLog(ERROR_LOG, status,
+                "HalWriteUsb: USB transmit error %d for LON USB interface, %s",
+                usbh_status,
+                (usbh_status == USBH_FAIL) ? "hardware error or disconnection"
+                                           : "unknown error");
+        return status;
+    }
+#else
+    // Placeholder: integrate with platform-specific open API when available.
+    if (bytes_written) {
+        *bytes_written = 0;
+    }
+    status = LonStatusNotImplemented;
+    OsalPrintLog(ERROR_LOG, status,
+            "HalWriteUsb: Implementation missing for the LON USB interface "
+            "on this platform");
+#endif
+    return status;
+}
+
+/*
+ * Writes data from multiple buffers to the LON USB network interface.
+ * Parameters:
+ *   fd: File descriptor of the opened LON USB network interface
+ *   iov: Array of buffer descriptors, written in order
+ *   iov_count: Number of entries in the iov array
+ *   bytes_written: Pointer to size_t to receive the number of bytes written
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful.
+ * Notes:
+ *   The entire set of buffers is written unless a non-recoverable error
+ *   occurs.  For Linux, the buffers are gathered with writev() and it retries
+ *   on EINTR and EAGAIN. For partial progress followed by error, the
+ *   already-written byte count is returned via bytes_written.
+ */
+LonStatusCode HalWriteUsbV(int usb_fd, const HalUsbIoVec *iov, int iov_count,
+        size_t *bytes_written)
+{
+    LonStatusCode status = LonStatusNoError;
+    if (bytes_written) {
+        *bytes_written = 0;
+    }
+    if (!iov || iov_count < 0) {
+        return LonStatusInvalidParameter;
+    }
+#if OS_IS(LINUX)
+    size_t len = 0;
+    for (int i = 0; i < iov_count; i++) {
+        len += iov[i].len;
+    }
 #if defined(__APPLE__)
     // Simulating successful write on macOS (no physical hardware)
     if (usb_fd == -1) {
         if (bytes_written) *bytes_written = len;
         OsalPrintLog(PACKET_TRACE_LOG, status,
-                "HalWriteUsb: Simulating write of %zu bytes on macOS", len);
+                "HalWriteUsbV: Simulating write of %zu bytes on macOS", len);
         return LonStatusNoError;
     }
 #endif
-    const uint8_t *p = (const uint8_t *)buf;
+    struct iovec vec[HAL_USB_MAX_IOV];
+    int first = 0;         // First buffer not yet completely written
+    size_t offset = 0;     // Bytes already written from iov[first]
     size_t total = 0;
     const int MAX_POLL_MS = 5000;  // Overall soft budget
     const int SLICE_MS = 100;      // Poll slice
@@ -1150,9 +1384,24 @@ LonStatusCode HalWriteUsb(int usb_fd, const void *buf, size_t len, size_t *bytes
     pfd.fd = usb_fd;
     pfd.events = POLLOUT;
     while (total < len) {
-        ssize_t n = write(usb_fd, p + total, len - total);
+        // Skip buffers already written, then gather the remaining buffers
+        while (first < iov_count && offset >= iov[first].len) {
+            offset -= iov[first].len;
+            first++;
+        }
+        int vec_count = 0;
+        for (int i = first; i < iov_count && vec_count < HAL_USB_MAX_IOV; i++) {
+            size_t skip = (i == first) ? offset : 0;
+            if (iov[i].len > skip) {
+                vec[vec_count].iov_base = (uint8_t *)iov[i].base + skip;
+                vec[vec_count].iov_len = iov[i].len - skip;
+                vec_count++;
+            }
+        }
+        ssize_t n = writev(usb_fd, vec, vec_count);
         if (n > 0) {
             total += (size_t)n;
+            offset += (size_t)n;
             continue;
         }
         if (n == -1) {
@@ -1168,7 +1417,7 @@ LonStatusCode HalWriteUsb(int usb_fd, const void *buf, size_t len, size_t *bytes
                     }
                     status = LonStatusTimeout;
                     OsalPrintLog(ERROR_LOG, status,
-                            "HalWriteUsb: Timeout after writing %zu/%zu bytes for "
+                            "HalWriteUsbV: Timeout after writing %zu/%zu bytes for "
                             "LON USB interface %d",
                             total, len, usb_fd);
                     return status;
@@ -1183,7 +1432,7 @@ LonStatusCode HalWriteUsb(int usb_fd, const void *buf, size_t len, size_t *bytes
                     }
                     status = LonStatusWriteFailed;
                     OsalPrintLog(ERROR_LOG, status,
-                            "HalWriteUsb: Write status poll error with %s system "
+                            "HalWriteUsbV: Write status poll error with %s system "
                             "error (errno %d) for LON USB interface %d",
                             strerror(errno), errno, usb_fd);
                     return status;
@@ -1195,12 +1444,14 @@ LonStatusCode HalWriteUsb(int usb_fd, const void *buf, size_t len, size_t *bytes
                 status = LonStatusInterfaceError;
             } else if (errno == ETIMEDOUT) {
                 status = LonStatusTimeout;
+            } else {
+                status = LonStatusWriteFailed;
             }
             if (bytes_written) {
                 *bytes_written = total;
             }
             OsalPrintLog(ERROR_LOG, status,
-                    "HalWriteUsb: Write failed after %zu/%zu bytes for LON USB "
+                    "HalWriteUsbV: Write failed after %zu/%zu bytes for LON USB "
                     "interface %d, %s system error (errno=%d)",
                     total, len, usb_fd, strerror(errno), errno);
             return status;
@@ -1210,56 +1461,30 @@ LonStatusCode HalWriteUsb(int usb_fd, const void *buf, size_t len, size_t *bytes
         *bytes_written = total;
     }
     OsalPrintLog(PACKET_TRACE_LOG, status,
-            "HalWriteUsb: Wrote %zu bytes to LON USB interface %d", total, usb_fd);
-    OsalPrintMessage(PACKET_TRACE_LOG, "HalWriteUsb: ", buf, (size_t)total);
-#elif PROCESSOR_IS(STM32)
-    // Check the flag we set in HalOpenUsb() to ensure the U60 is fully enumerated
-    if (!is_usb_cdc_ready) {
-        status = LonStatusNotOpen;
-        OsalPrintLog(ERROR_LOG, status,
-                "HalWriteUsb: Attempt to write before LON USB interface is ready");
-        return status;  // Port is not ready
+            "HalWriteUsbV: Wrote %zu bytes in %d buffers to LON USB interface %d",
+            total, iov_count, usb_fd);
+    for (int i = 0; i < iov_count; i++) {
+        OsalPrintMessage(PACKET_TRACE_LOG, "HalWriteUsbV: ", iov[i].base, iov[i].len);
     }
-
-    // Attempt to transmit using the STM32 USB Host Library
-    USBH_StatusTypeDef usbh_status =
-            USBH_CDC_Transmit(&hUsbHostFS, (uint8_t *)pData, (uint32_t)dataLen);
-    if (usbh_status == USBH_OK) {
-        // Success: Return the number of bytes written so the LON stack proceeds
-        if (bytes_written) {
-            *bytes_written = (size_t)dataLen;
+#else
+    // Write the buffers one at a time; stop on error or a partial write
+    size_t total = 0;
+    for (int i = 0; i < iov_count && LON_SUCCESS(status); i++) {
+        size_t written = 0;
+        status = HalWriteUsb(usb_fd, iov[i].base, iov[i].len, &written);
+        total += written;
+        if (written != iov[i].len) {
+            break;
         }
-        return status;
-    } else if (usbh_status == USBH_BUSY) {
-        // The USB hardware is currently busy transmitting a previous packet.
-        // Returning 0 tells the LON stack that no bytes were written yet,
-        // allowing it to safely buffer/retry on the next tick without dropping
-        // data.
-        return status;
-    } else {
-        // Hardware error or disconnection
-        status = LonStatusInterfaceError;
-        OsalPrintLog(ERROR_LOG, status,
-                "HalWriteUsb: USB transmit error %d for LON USB interface, %s",
-                usbh_status,
-                (usbh_status == USBH_FAIL) ? "hardware error or disconnection"
-                                           : "unknown error");
-        return status;
     }
-#else
-    // Placeholder: integrate with platform-specific open API when available.
     if (bytes_written) {
-        *bytes_written = 0;
+        *bytes_written = total;
     }
-    status = LonStatusNotImplemented;
-    OsalPrintLog(ERROR_LOG, status,
-            "HalWriteUsb: Implementation missing for the LON USB interface "
-            "on this platform");
 #endif
     return status;
 }
 
-#if USB_UPLINK_IS(POLLING)
+#if USB_UPLINK_IS(POLLING) || USB_UPLINK_IS(EPOLL)
 /*
  * Polls and reads data from the LON USB network interface.
  * Parameters:
@@ -1273,6 +1498,8 @@ LonStatusCode HalWriteUsb(int usb_fd, const void *buf, size_t len, size_t *bytes
  *   This function performs a non-blocking read. If no data is available,
  *   it returns LonStatusNoMessageAvailable. If data is available, it reads
  *   up to 'len' bytes and returns the number of bytes read via 'bytes_read'.
+ *   A read returns no data once the device hung up; HalWaitUsb() reports
+ *   the hang-up, and a read error such as EIO returns LonStatusReadFailed.
  *   Drivers can call this function periodically to retrieve incoming data.
  */
 LonStatusCode HalReadUsb(int usb_fd, void *buf, size_t len, ssize_t *bytes_read)
@@ -1300,6 +1527,9 @@ LonStatusCode HalReadUsb(int usb_fd, void *buf, size_t len, ssize_t *bytes_read)
         if (buf && len > 0) {
             memset(buf, 0, len);
         }
+        // With VMIN=0 and VTIME=0, a read with no data pending returns 0
+        // bytes; a hung up device fails with EIO, or is reported by
+        // HalWaitUsb()
         if (*bytes_read == 0 || errno == EAGAIN || errno == EWOULDBLOCK) {
             return LonStatusNoMessageAvailable;
         }
@@ -1326,7 +1556,239 @@ LonStatusCode HalReadUsb(int usb_fd, void *buf, size_t len, ssize_t *bytes_read)
 #endif
     return status;
 }
-#endif  // USB_UPLINK_IS(POLLING)
+#endif  // USB_UPLINK_IS(POLLING) || USB_UPLINK_IS(EPOLL)
+
+#if USB_UPLINK_IS(EPOLL)
+/*
+ * Creates a wait set for receive data on LON USB network interfaces.
+ * Parameters:
+ *   wait_fd: Pointer to receive the file descriptor of the wait set
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful
+ */
+LonStatusCode HalCreateUsbWaitSet(int *wait_fd)
+{
+    LonStatusCode status = LonStatusNoError;
+    if (!wait_fd) {
+        return LonStatusInvalidParameter;
+    }
+#if OS_IS(LINUX) && defined(__linux__)
+    *wait_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (*wait_fd < 0) {
+        status = LonStatusOpenFailed;
+        OsalPrintLog(ERROR_LOG, status,
+                "HalCreateUsbWaitSet: Failed to create wait set, %s system "
+                "error (errno %d)",
+                strerror(errno), errno);
+    }
+#else
+    // Placeholder: integrate with platform-specific wait API when available.
+    *wait_fd = -1;
+    status = LonStatusNotImplemented;
+    OsalPrintLog(ERROR_LOG, status,
+            "HalCreateUsbWaitSet: Implementation missing for the LON USB "
+            "interface on this platform");
+#endif
+    return status;
+}
+
+/*
+ * Arms a LON USB network interface in a wait set for one receive event.
+ * Parameters:
+ *   wait_fd: File descriptor of the wait set from HalCreateUsbWaitSet()
+ *   fd: File descriptor of the opened LON USB network interface
+ *   iface_index: Interface index reported by HalWaitUsb() for this interface
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful
+ */
+LonStatusCode HalArmUsbWait(int wait_fd, int usb_fd, int iface_index)
+{
+    LonStatusCode status = LonStatusNoError;
+#if OS_IS(LINUX) && defined(__linux__)
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.u32 = (uint32_t)iface_index;
+    if (epoll_ctl(wait_fd, EPOLL_CTL_MOD, usb_fd, &event) != 0 &&
+            (errno != ENOENT || epoll_ctl(wait_fd, EPOLL_CTL_ADD, usb_fd, &event) != 0)) {
+        status = LonStatusInterfaceError;
+        OsalPrintLog(ERROR_LOG, status,
+                "HalArmUsbWait: Failed to arm LON USB interface %d, %s "
+                "system error (errno %d)",
+                usb_fd, strerror(errno), errno);
+    }
+#else
+    // Placeholder: integrate with platform-specific wait API when available.
+    status = LonStatusNotImplemented;
+#endif
+    return status;
+}
+
+/*
+ * Removes a LON USB network interface from a wait set.
+ * Parameters:
+ *   wait_fd: File descriptor of the wait set from HalCreateUsbWaitSet()
+ *   fd: File descriptor of the opened LON USB network interface
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful
+ */
+LonStatusCode HalDisarmUsbWait(int wait_fd, int usb_fd)
+{
+    LonStatusCode status = LonStatusNoError;
+#if OS_IS(LINUX) && defined(__linux__)
+    if (epoll_ctl(wait_fd, EPOLL_CTL_DEL, usb_fd, NULL) != 0 && errno != ENOENT) {
+        status = LonStatusInterfaceError;
+        OsalPrintLog(ERROR_LOG, status,
+                "HalDisarmUsbWait: Failed to remove LON USB interface %d, %s "
+                "system error (errno %d)",
+                usb_fd, strerror(errno), errno);
+    }
+#else
+    // Placeholder: integrate with platform-specific wait API when available.
+    status = LonStatusNotImplemented;
+#endif
+    return status;
+}
+
+/*
+ * Adds a wakeup event to a wait set.
+ * Parameters:
+ *   wait_fd: File descriptor of the wait set from HalCreateUsbWaitSet()
+ *   wake_fd: Pointer to receive the file descriptor of the wakeup event
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful
+ */
+LonStatusCode HalCreateUsbWakeup(int wait_fd, int *wake_fd)
+{
+    LonStatusCode status = LonStatusNoError;
+    if (!wake_fd) {
+        return LonStatusInvalidParameter;
+    }
+#if OS_IS(LINUX) && defined(__linux__)
+    *wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (*wake_fd < 0) {
+        status = LonStatusOpenFailed;
+        OsalPrintLog(ERROR_LOG, status,
+                "HalCreateUsbWakeup: Failed to create wakeup event, %s system "
+                "error (errno %d)",
+                strerror(errno), errno);
+        return status;
+    }
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = (uint32_t)HAL_USB_WAKEUP_INDEX;
+    if (epoll_ctl(wait_fd, EPOLL_CTL_ADD, *wake_fd, &event) != 0) {
+        status = LonStatusOpenFailed;
+        OsalPrintLog(ERROR_LOG, status,
+                "HalCreateUsbWakeup: Failed to add wakeup event, %s system "
+                "error (errno %d)",
+                strerror(errno), errno);
+        close(*wake_fd);
+        *wake_fd = -1;
+    }
+#else
+    // Placeholder: integrate with platform-specific wait API when available.
+    *wake_fd = -1;
+    status = LonStatusNotImplemented;
+#endif
+    return status;
+}
+
+/*
+ * Signals a wakeup event to end a HalWaitUsb() call.
+ * Parameters:
+ *   wake_fd: File descriptor of the wakeup event from HalCreateUsbWakeup()
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful
+ */
+LonStatusCode HalSignalUsbWakeup(int wake_fd)
+{
+    LonStatusCode status = LonStatusNoError;
+#if OS_IS(LINUX) && defined(__linux__)
+    // EAGAIN only occurs if the counter is saturated, i.e. already signaled
+    if (eventfd_write(wake_fd, 1) != 0 && errno != EAGAIN) {
+        status = LonStatusWriteFailed;
+        OsalPrintLog(ERROR_LOG, status,
+                "HalSignalUsbWakeup: Failed to signal wakeup event, %s system "
+                "error (errno %d)",
+                strerror(errno), errno);
+    }
+#else
+    // Placeholder: integrate with platform-specific wait API when available.
+    status = LonStatusNotImplemented;
+#endif
+    return status;
+}
+
+/*
+ * Clears a wakeup event reported by HalWaitUsb().
+ * Parameters:
+ *   wake_fd: File descriptor of the wakeup event from HalCreateUsbWakeup()
+ * Returns:
+ *   None
+ */
+void HalClearUsbWakeup(int wake_fd)
+{
+#if OS_IS(LINUX) && defined(__linux__)
+    eventfd_t count;
+    (void)eventfd_read(wake_fd, &count);
+#else
+    (void)wake_fd;
+#endif
+}
+
+/*
+ * Waits for receive data on the LON USB network interfaces in a wait set.
+ * Parameters:
+ *   wait_fd: File descriptor of the wait set from HalCreateUsbWaitSet()
+ *   timeout_ms: Maximum time to wait in milliseconds
+ *   ready_ifaces: Array to receive the interface indices with receive data,
+ *             or HAL_USB_WAKEUP_INDEX for the wakeup event
+ *   hangup: Array to receive true for each ready interface that hung up or
+ *             failed
+ *   max_ready: Number of entries in the ready_ifaces and hangup arrays
+ *   ready_count: Pointer to receive the number of ready interfaces
+ * Returns:
+ *   LonStatusNoError on success, including a timeout with a ready count of
+ *   zero; LonStatusCode error code if unsuccessful
+ */
+LonStatusCode HalWaitUsb(int wait_fd, int timeout_ms, int *ready_ifaces,
+        bool *hangup, int max_ready, int *ready_count)
+{
+    LonStatusCode status = LonStatusNoError;
+    if (!ready_ifaces || !hangup || max_ready <= 0 || !ready_count) {
+        return LonStatusInvalidParameter;
+    }
+    *ready_count = 0;
+#if OS_IS(LINUX) && defined(__linux__)
+    struct epoll_event events[HAL_USB_MAX_WAIT_EVENTS];
+    if (max_ready > HAL_USB_MAX_WAIT_EVENTS) {
+        max_ready = HAL_USB_MAX_WAIT_EVENTS;
+    }
+    int n = epoll_wait(wait_fd, events, max_ready, timeout_ms);
+    if (n < 0) {
+        if (errno == EINTR) {
+            return status;  // Transient; report no ready interfaces
+        }
+        status = LonStatusReadFailed;
+        OsalPrintLog(ERROR_LOG, status,
+                "HalWaitUsb: Wait failed, %s system error (errno %d)",
+                strerror(errno), errno);
+        return status;
+    }
+    for (int i = 0; i < n; i++) {
+        ready_ifaces[i] = (int)events[i].data.u32;
+        hangup[i] = (events[i].events & (EPOLLHUP | EPOLLERR)) != 0;
+    }
+    *ready_count = n;
+#else
+    // Placeholder: integrate with platform-specific wait API when available.
+    status = LonStatusNotImplemented;
+#endif
+    return status;
+}
+#endif  // USB_UPLINK_IS(EPOLL)
 
 #if USB_SERVICE_IS(PUMP)
 /*
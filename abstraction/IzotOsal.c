@@ -12,6 +12,9 @@
  *          additional operating systems.
  */
 
+// This file implements the allocator that the static build hides from the stack
+#define OSAL_ALLOCATOR_IMPLEMENTATION
+
 #include "abstraction/IzotOsal.h"
 #include "lcs/lcs_node.h"
 
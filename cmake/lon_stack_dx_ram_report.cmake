@@ -0,0 +1,40 @@
+# lon_stack_dx_ram_report.cmake
+#
+# Writes the static RAM footprint of each object in the LON Stack DX
+# library to a report file.  Run with:
+#   cmake -DSIZE_TOOL=<size> -DLIBRARY=<library> -DREPORT=<file> -P lon_stack_dx_ram_report.cmake
+# With LON_STACK_STATIC_ALLOCATION, this is all of the RAM the stack uses
+# apart from its thread stacks.
+
+execute_process(
+    COMMAND "${SIZE_TOOL}" -t "${LIBRARY}"
+    OUTPUT_VARIABLE size_output
+    RESULT_VARIABLE size_result
+)
+if(NOT size_result EQUAL 0)
+    message(WARNING "RAM report: ${SIZE_TOOL} failed for ${LIBRARY}")
+    return()
+endif()
+
+set(report "LON Stack DX RAM footprint (data + bss bytes per object)\n\n")
+set(total_data 0)
+set(total_bss 0)
+string(REPLACE "\n" ";" size_lines "${size_output}")
+foreach(line IN LISTS size_lines)
+    # Berkeley format: text data bss dec hex filename
+    if(line MATCHES "^[ \t]*([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)[ \t]+[0-9]+[ \t]+[0-9a-fA-F]+[ \t]+([^ \t(]+)")
+        set(object "${CMAKE_MATCH_4}")
+        if(object STREQUAL "")
+            continue()
+        endif()
+        math(EXPR ram "${CMAKE_MATCH_2} + ${CMAKE_MATCH_3}")
+        math(EXPR total_data "${total_data} + ${CMAKE_MATCH_2}")
+        math(EXPR total_bss "${total_bss} + ${CMAKE_MATCH_3}")
+        string(APPEND report "  ${ram}\t${object}\n")
+    endif()
+endforeach()
+math(EXPR total_ram "${total_data} + ${total_bss}")
+string(APPEND report "\n  ${total_ram}\ttotal (${total_data} data, ${total_bss} bss)\n")
+
+file(WRITE "${REPORT}" "${report}")
+message(STATUS "LON Stack DX static RAM: ${total_ram} bytes; see ${REPORT}")
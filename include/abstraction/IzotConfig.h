@@ -172,6 +172,8 @@
 #define USB_UPLINK_ID_NA             0  // USB uplink type not specified
 #define USB_UPLINK_ID_POLLING        1  // Polled USB uplink
 #define USB_UPLINK_ID_INTERRUPT      2  // Interrupt-driven USB uplink
+#define USB_UPLINK_ID_EPOLL          3  // USB uplink read by one thread waiting
+                                        // on all interfaces (Linux)
 
 /*****************************************************************
  * Section: LON Stack Configuration Overrides
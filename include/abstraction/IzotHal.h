@@ -144,6 +144,38 @@ LonStatusCode HalWriteStorageSegment(
 LonStatusCode HalReadStorageSegment(
         const IzotPersistentSegType persistent_seg_type, IzotByte *buf, size_t seg_start, size_t start, size_t size);
 
+/*
+ * Opens the image update (IUP) image file and maps it into memory.
+ * Parameters:
+ *   size: size of the image file in bytes
+ *   image: pointer to the returned start of the mapped file
+ * Returns:
+ *   LonStatusNoError on success, or a LonStatusCode error code on failure.
+ * Notes:
+ *   Available on Linux, where the file takes the place of the IUP flash
+ *   blocks.  A new or resized file is filled with 0xFF.
+ */
+LonStatusCode HalOpenIupImage(size_t size, IzotByte **image);
+
+/*
+ * Writes changes to a range of the mapped IUP image file to storage.
+ * Parameters:
+ *   start: offset in bytes from the start of the image file
+ *   size: number of bytes to write
+ * Returns:
+ *   LonStatusNoError on success, or a LonStatusCode error code on failure.
+ */
+LonStatusCode HalSyncIupImage(size_t start, size_t size);
+
+/*
+ * Syncs, unmaps, and closes the IUP image file.
+ * Parameters:
+ *   None
+ * Returns:
+ *   LonStatusNoError on success, or a LonStatusCode error code on failure.
+ */
+LonStatusCode HalCloseIupImage(void);
+
 /*****************************************************************
  * Section: LON USB Interface Abstraction Function Declarations
  *****************************************************************/
@@ -228,7 +260,36 @@ void HalCloseUsb(
  */
 LonStatusCode HalWriteUsb(int fd, const void *buf, size_t len, size_t *bytes_written);
 
-#if USB_UPLINK_IS(POLLING)
+// Maximum number of buffers gathered into one write by HalWriteUsbV()
+#ifndef HAL_USB_MAX_IOV
+#define HAL_USB_MAX_IOV 16
+#endif
+
+// Buffer descriptor for HalWriteUsbV()
+typedef struct HalUsbIoVec {
+    const void *base;   // Start of the buffer
+    size_t len;         // Number of bytes in the buffer
+} HalUsbIoVec;
+
+/*
+ * Writes data from multiple buffers to the LON USB network interface.
+ * Parameters:
+ *   fd: File descriptor of the opened LON USB network interface
+ *   iov: Array of buffer descriptors, written in order
+ *   iov_count: Number of entries in the iov array
+ *   bytes_written: Pointer to size_t to receive the number of bytes written
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful.
+ * Notes:
+ *   Same semantics as HalWriteUsb() for the concatenated buffers.  For Linux,
+ *   the buffers are gathered with writev() so that several frames can be sent
+ *   with one system call; up to HAL_USB_MAX_IOV buffers are passed per call.
+ *   Other platforms write the buffers one at a time with HalWriteUsb().
+ */
+LonStatusCode HalWriteUsbV(int fd, const HalUsbIoVec *iov, int iov_count,
+        size_t *bytes_written);
+
+#if USB_UPLINK_IS(POLLING) || USB_UPLINK_IS(EPOLL)
 /*
  * Polls and reads data from the LON USB network interface.
  * Parameters:
@@ -242,10 +303,111 @@ LonStatusCode HalWriteUsb(int fd, const void *buf, size_t len, size_t *bytes_wri
  *   This function performs a non-blocking read. If no data is available,
  *   it returns LonStatusNoMessageAvailable. If data is available, it reads
  *   up to 'len' bytes and returns the number of bytes read via 'bytes_read'.
+ *   A read returns no data once the device hung up; HalWaitUsb() reports
+ *   the hang-up, and a read error such as EIO returns LonStatusReadFailed.
  *   Drivers can call this function periodically to retrieve incoming data.
  */
 LonStatusCode HalReadUsb(int fd, void *buf, size_t len, ssize_t *bytes_read);
-#endif  // USB_UPLINK_IS(POLLING)
+#endif  // USB_UPLINK_IS(POLLING) || USB_UPLINK_IS(EPOLL)
+
+#if USB_UPLINK_IS(EPOLL)
+// Maximum number of ready interfaces reported by one HalWaitUsb() call
+#ifndef HAL_USB_MAX_WAIT_EVENTS
+#define HAL_USB_MAX_WAIT_EVENTS 16
+#endif
+
+// Index reported by HalWaitUsb() for the wakeup event of HalCreateUsbWakeup()
+#define HAL_USB_WAKEUP_INDEX (-1)
+
+/*
+ * Creates a wait set for receive data on LON USB network interfaces.
+ * Parameters:
+ *   wait_fd: Pointer to receive the file descriptor of the wait set
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful
+ * Notes:
+ *   For Linux, the wait set is an epoll instance.
+ */
+LonStatusCode HalCreateUsbWaitSet(int *wait_fd);
+
+/*
+ * Arms a LON USB network interface in a wait set for one receive event.
+ * Parameters:
+ *   wait_fd: File descriptor of the wait set from HalCreateUsbWaitSet()
+ *   fd: File descriptor of the opened LON USB network interface
+ *   iface_index: Interface index reported by HalWaitUsb() for this interface
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful
+ * Notes:
+ *   Adds the interface to the wait set if it is not already a member.  The
+ *   interface is disarmed after it is reported by HalWaitUsb(); call this
+ *   function again after reading the available data to wait for more.
+ */
+LonStatusCode HalArmUsbWait(int wait_fd, int fd, int iface_index);
+
+/*
+ * Removes a LON USB network interface from a wait set.
+ * Parameters:
+ *   wait_fd: File descriptor of the wait set from HalCreateUsbWaitSet()
+ *   fd: File descriptor of the opened LON USB network interface
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful
+ */
+LonStatusCode HalDisarmUsbWait(int wait_fd, int fd);
+
+/*
+ * Adds a wakeup event to a wait set.
+ * Parameters:
+ *   wait_fd: File descriptor of the wait set from HalCreateUsbWaitSet()
+ *   wake_fd: Pointer to receive the file descriptor of the wakeup event
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful
+ * Notes:
+ *   For Linux, the wakeup event is an eventfd.  HalWaitUsb() reports
+ *   HAL_USB_WAKEUP_INDEX after HalSignalUsbWakeup() until the event is
+ *   cleared with HalClearUsbWakeup().
+ */
+LonStatusCode HalCreateUsbWakeup(int wait_fd, int *wake_fd);
+
+/*
+ * Signals a wakeup event to end a HalWaitUsb() call.
+ * Parameters:
+ *   wake_fd: File descriptor of the wakeup event from HalCreateUsbWakeup()
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful
+ */
+LonStatusCode HalSignalUsbWakeup(int wake_fd);
+
+/*
+ * Clears a wakeup event reported by HalWaitUsb().
+ * Parameters:
+ *   wake_fd: File descriptor of the wakeup event from HalCreateUsbWakeup()
+ * Returns:
+ *   None
+ */
+void HalClearUsbWakeup(int wake_fd);
+
+/*
+ * Waits for receive data on the LON USB network interfaces in a wait set.
+ * Parameters:
+ *   wait_fd: File descriptor of the wait set from HalCreateUsbWaitSet()
+ *   timeout_ms: Maximum time to wait in milliseconds
+ *   ready_ifaces: Array to receive the interface indices with receive data,
+ *             or HAL_USB_WAKEUP_INDEX for the wakeup event
+ *   hangup: Array to receive true for each ready interface that hung up or
+ *             failed
+ *   max_ready: Number of entries in the ready_ifaces and hangup arrays
+ *   ready_count: Pointer to receive the number of ready interfaces
+ * Returns:
+ *   LonStatusNoError on success, including a timeout with a ready count of
+ *   zero; LonStatusCode error code if unsuccessful
+ * Notes:
+ *   An interface that hung up or failed is reported once; read any data
+ *   left in it and then remove it with HalDisarmUsbWait().
+ */
+LonStatusCode HalWaitUsb(int wait_fd, int timeout_ms, int *ready_ifaces,
+        bool *hangup, int max_ready, int *ready_count);
+#endif  // USB_UPLINK_IS(EPOLL)
 
 #if USB_SERVICE_IS(PUMP)
 /*
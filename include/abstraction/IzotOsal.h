@@ -327,6 +327,12 @@ void *OsalAllocateMemory(size_t size);
  */
 void OsalFreeMemory(void *buf);
 
+#if STACK_STATIC_ALLOCATION && !defined(OSAL_ALLOCATOR_IMPLEMENTATION)
+// The static build places all protocol stack memory in static storage;
+// any use of the heap from the stack is a compile-time error
+#pragma GCC poison OsalAllocateMemory OsalFreeMemory
+#endif
+
 /*****************************************************************
  * Section: Message Reporting Abstraction Types and Function Declarations
  *****************************************************************/
@@ -114,7 +114,6 @@ extern "C" {
 
 #define MAX_DOMAINS                 2           // Maximum # of domains allowed
 #define MAX_CONNECTION_TBL_ENTRIES  255 
-#define NUM_ADDR_TBL_ENTRIES    	254         // Number of entries in address table
 #define NV_TABLE_SIZE				254         // Number of entries in NV table
 #define NUM_ADDR_TBL_SIZE
 #define ISI_MESSAGE_TAG             0x0F
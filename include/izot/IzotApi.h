@@ -212,6 +212,47 @@ IZOT_EXTERNAL_FN volatile void* IzotGetDatapointValue(const unsigned index);
 #define IzotPropagate(name) IzotPropagateByIndex(name.global_index)
 IZOT_EXTERNAL_FN LonStatusCode IzotPropagateByIndex(signed index);
 
+/*
+ * Propagates a list of bound output datapoints in one pass.
+ * Parameters:
+ *   indices: Indices of the datapoints to propagate
+ *   count: Number of entries in indices
+ *   results: Receives the status for each entry of indices; may be NULL
+ * Returns:
+ *   LonStatusNoError if every datapoint was scheduled or needed no update,
+ *   otherwise the status of the first datapoint that failed.
+ * Notes:
+ *   Each datapoint is handled like <IzotPropagateByIndex>, including its
+ *   <IzotDatapointUpdateCompleted> event, but the bound output list is
+ *   checked once for the whole batch and the queue space for each datapoint
+ *   is reserved before it is scheduled.
+ *
+ *   A datapoint that does not fit in the queue gets LonStatusNoBufferAvailable
+ *   and no completion event; propagate it again later.  An invalid index gets
+ *   LonStatusIndexInvalid.
+ */
+IZOT_EXTERNAL_FN LonStatusCode IzotPropagateBatch(const signed *indices, unsigned count,
+        LonStatusCode *results);
+
+/*
+ * Propagates the bound output datapoints marked in a dirty bitmap.
+ * Parameters:
+ *   dirtyMap: One bit per datapoint index; bit (index % 8) of byte
+ *             (index / 8) marks the datapoint with that index
+ *   mapSize: Number of bytes in dirtyMap
+ * Returns:
+ *   LonStatusNoError if all marked datapoints were handled, or
+ *   LonStatusNoBufferAvailable if some are still marked.
+ * Notes:
+ *   The application sets the bit of each datapoint it changes during a scan
+ *   cycle and calls this function once at the end of the cycle.  The bit of
+ *   each datapoint scheduled is cleared.  If the queue fills up, the bits of
+ *   the datapoints not yet scheduled stay set for the next call.  Marked
+ *   datapoints that are not bound outputs are cleared without an update or
+ *   an <IzotDatapointUpdateCompleted> event.
+ */
+IZOT_EXTERNAL_FN LonStatusCode IzotPropagateDirty(IzotByte *dirtyMap, unsigned mapSize);
+
 /*
  * Propagates a Service message.
  * Parameters:
@@ -563,6 +604,29 @@ IZOT_EXTERNAL_FN LonStatusCode IzotDatapointFlags(IzotDatapointDefinition* const
 IZOT_EXTERNAL_FN LonStatusCode IzotDatapointBind(int nvIndex, IzotByte address, IzotUbits16 selector, 
                 IzotBool turnAround, IzotServiceType service);
 
+/*
+ * Sets the minimum and maximum send times of an output datapoint (NV).
+ * Parameters:
+ *   nvIndex: Datapoint (NV) index of a registered output datapoint
+ *   minSendTime: Minimum time between updates in milliseconds; 0 for none
+ *   maxSendTime: Maximum time between updates in milliseconds; 0 for none
+ * Returns:
+ *   LonStatusNoError if no error, otherwise a <LonStatusCode> error code.
+ * Notes:
+ *   Call this function after the datapoint is registered.  A propagate within
+ *   minSendTime of the previous update is held back, and the latest value is
+ *   sent when minSendTime has passed.  If maxSendTime passes without an update,
+ *   the LON Stack propagates the current value as a heartbeat.  Held back
+ *   updates and heartbeats generate <IzotDatapointUpdateCompleted> events
+ *   like other propagates.
+ *
+ *   If nvIndex is the first element of an array, the send times apply to each
+ *   element.  Set both times to 0 to remove them.  Up to NV_SEND_TIME_COUNT
+ *   datapoints can have send times.
+ */
+IZOT_EXTERNAL_FN LonStatusCode IzotDatapointSendTimes(int nvIndex, unsigned minSendTime,
+        unsigned maxSendTime);
+
 /*
  * Requests a copy of alias configuration data.
  * Parameters:
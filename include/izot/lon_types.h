@@ -563,6 +563,32 @@ typedef IZOT_ENUM_BEGIN(IzotServiceLedPhysicalState){
     be scheduled to be sent out at any point in time */
 #define MAX_NV_OUT 5
 
+/* Set to 1 to coalesce propagates of a network output variable that is
+    already scheduled. The pending update sends the current value when it
+    is transmitted, so a fast-changing variable uses one queue entry and
+    the channel carries its latest value rather than every intermediate
+    one. A coalesced propagate has no completion event of its own; the
+    completion event of the pending update covers it. Synchronous
+    variables are never coalesced. */
+#ifndef NV_OUT_COALESCING
+#define NV_OUT_COALESCING 0
+#endif
+
+/* Number of network variable poll lookups remembered. A poll whose
+    selector and direction are found here is answered without searching
+    the network variable and alias tables, and a variable whose value
+    has not changed since the last poll is sent without converting it
+    from host to network format again. Must be at least 1. */
+#ifndef NV_POLL_CACHE_SIZE
+#define NV_POLL_CACHE_SIZE 8
+#endif
+
+/* Maximum number of output variables (array elements count separately)
+    with a minimum or maximum send time. See IzotDatapointSendTimes(). */
+#ifndef NV_SEND_TIME_COUNT
+#define NV_SEND_TIME_COUNT 16
+#endif
+
 /* To implement synchronous variables, the values of the
     variables are to be stored along with index in the queue.
     Define the maximum size (in bytes) of a network variable
@@ -593,11 +619,11 @@ typedef IZOT_ENUM_BEGIN(IzotServiceLedPhysicalState){
 #define MAX_LON_MSG_EX_LEN 1280
 #define MAX_EXP_LON_MSG_EX_LEN (2 * MAX_LON_MSG_EX_LEN + 4)
 
-#define NUM_ADDR_TBL_ENTRIES                                                             \
-    254 /* # of address table entries; maximum supported value is 255 */
-
 #define RECEIVE_TRANS_COUNT 16 /* Can be > 16 for Ref. Impl */
 
+/* Upper limits of the datapoint and alias tables.  Each stack sizes its
+   tables from the counts in IzotStackInterfaceData when it is created; the
+   address table limit is NUM_ADDR_TBL_ENTRIES in lcs_custom.h. */
 #define NV_TABLE_SIZE 254 /* Check management tool for any restriction on maximum size */
 
 #define NV_ALIAS_TABLE_SIZE                                                              \
@@ -625,6 +651,31 @@ typedef IZOT_ENUM_BEGIN(IzotServiceLedPhysicalState){
 #endif
 #endif
 
+/*******************************************************************************
+    STACK_ARENA_SIZE is the initial size in bytes of the arena that holds
+    the layer queues and the receive records.  The arena is allocated on
+    the first reset and reused by every later reset.  If a reset needs
+    more space, for example after the buffer configuration is changed,
+    the rest comes from the heap for that reset and the arena is
+    reallocated at the needed size on the next reset.  gp->arenaUsed
+    holds the number of bytes used by the last reset.
+    Each allocation from the arena starts on a STACK_ARENA_ALIGNMENT
+    boundary so that no two queues share a cache line.
+    If STACK_STATIC_ALLOCATION is set (CMake option
+    LON_STACK_STATIC_ALLOCATION), each stack's arena is a static array of
+    STACK_ARENA_SIZE bytes, the stack does not use OsalAllocateMemory(),
+    and a reset that needs more than the arena fails.
+*******************************************************************************/
+#ifndef STACK_STATIC_ALLOCATION
+#define STACK_STATIC_ALLOCATION 0
+#endif
+#ifndef STACK_ARENA_SIZE
+#define STACK_ARENA_SIZE 16384
+#endif
+#ifndef STACK_ARENA_ALIGNMENT
+#define STACK_ARENA_ALIGNMENT 64
+#endif
+
 // LON/IP constants
 #define BROADCAST_PREFIX 0xEFC00000
 #define IP_ADDRESS_LEN 4
@@ -2529,7 +2580,12 @@ typedef IZOT_STRUCT_BEGIN(IzotStackInterfaceData)
                                        and dynamic NVs */
     uint8_t Domains;                 /* Number of domain in the node (1 or 2) */
     uint16_t Addresses;              /* Maximum number of address table entries
-                                       (0..4096) */
+                                       (0..4096).  Datapoint and alias
+                                       configurations hold an 8-bit address
+                                       index, so bindings can only use the
+                                       first 255 entries; entries from 255 up
+                                       only hold group memberships for receive
+                                       timers and IP multicast. */
     uint16_t Aliases;                /* Maximum number of alias tables (0..8192) */
     uint16_t BindableMsgTags;        /* Number of bindable message tags (0.. 4096) */
     const char *NodeSdString;        /* Node self documentation string */
@@ -34,6 +34,9 @@
  *                          program with the given properties.
  *          Propagate():    Sends all output network variables in the device.
  *          PropagateNV():  Sends a specific output network variable.
+ *          PropagateBatch(): Sends a list of output network variables.
+ *          PropagateDirty(): Sends the output network variables marked in
+ *                          a bitmap.
  *          Poll():         Polls all input network variables in the device.
  *          PollNV():       Polls a specific input network variable.
  *          GoOffline():    Puts the application offline.
@@ -216,6 +219,17 @@ void PropagateNV(IzotBits16 nvIndex);
 /* To send an array element or any other simple variable.*/
 void PropagateArrayNV(IzotBits16 arrayNVIndex, IzotBits16 index);
 
+/* To send a list of variables like PropagateNV, with a status for each */
+LonStatusCode PropagateBatch(const int nvIndices[], unsigned count,
+        LonStatusCode results[]);
+
+/* To send the bound output variables marked in a bitmap and clear their bits */
+LonStatusCode PropagateDirty(IzotByte dirtyMap[], unsigned mapSize);
+
+/* To limit how often an output variable is sent and to send heartbeats */
+LonStatusCode SetNVSendTimes(IzotBits16 nvIndex, uint32_t minSendTime,
+        uint32_t maxSendTime);
+
 /* To poll all input network variables */
 void Poll(void);
 
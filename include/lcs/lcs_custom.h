@@ -72,6 +72,25 @@
 
 #define NON_GROUP_TIMER 8
 
+/* Upper limit of the address table.  Each stack sizes its address table
+    from the count in IzotStackInterfaceData when it is created.  Datapoint
+    and alias bindings use 8-bit address indices, so only the first 255
+    address table entries can be bound; the remaining entries of an
+    extended address table hold group memberships for receive timers and
+    IP multicast, and are updated with IzotUpdateAddressConfig().  Group
+    entries are indexed for lookup by group; subnet/node entries are not
+    indexed.  The static build reserves every table at its limit, so it
+    keeps the classic 254 entries.  STACK_STATIC_ALLOCATION is private to
+    the stack library, so this limit is defined here rather than in
+    lon_types.h. */
+#ifndef NUM_ADDR_TBL_ENTRIES
+#if STACK_STATIC_ALLOCATION
+#define NUM_ADDR_TBL_ENTRIES 254  /* # of address table entries */
+#else
+#define NUM_ADDR_TBL_ENTRIES 4096 /* # of address table entries */
+#endif
+#endif
+
 /* If the device is a member of group A, then typical LON applications
     set group size to 1 more than actual group size if node is not
     a member of group A. This is done so that the number of
@@ -93,6 +112,22 @@
     timer value in all target nodes. */
 #define TS_RESET_DELAY_TIME 2000
 
+/* Transmit scheduling of the non-priority network output queue (nwOutQ).
+    With NW_TX_SCHEDULER_WEIGHTED, responses (including acknowledgements,
+    challenges, and replies), retries of acknowledged and request
+    messages, and new messages take turns in proportion to their weights
+    while more than one of them is waiting for the queue; a class that is
+    alone may use the whole queue. With NW_TX_SCHEDULER_FIFO each layer
+    queues a message whenever there is room, in the order LCS_Service()
+    calls the layers. Priority messages use nwOutPriQ, which the network
+    layer always serves first. */
+#define NW_TX_SCHEDULER_FIFO 0
+#define NW_TX_SCHEDULER_WEIGHTED 1
+#define NW_TX_SCHEDULER NW_TX_SCHEDULER_WEIGHTED
+#define NW_TX_WEIGHT_RESPONSE 4
+#define NW_TX_WEIGHT_RETRY 2
+#define NW_TX_WEIGHT_NEW 1
+
 typedef IzotByte DomainId[IZOT_DOMAIN_ID_MAX_LENGTH];
 typedef IzotByte AuthKey[IZOT_AUTHENTICATION_KEY_LENGTH];
 
@@ -102,9 +137,14 @@ typedef struct {
     /* ReadOnlyData Members */
     IzotUniqueId UniqueNodeId;
     IzotByte twoDomains;
-    IzotByte addressCnt;
+    IzotUbits16 addressCnt;  /* Address table entries; only the first 255
+                                can be bound, see NUM_ADDR_TBL_ENTRIES */
     char progId[IZOT_PROGRAM_ID_LENGTH];
 
+    /* Table sizes; see InitEEPROM() */
+    IzotUbits16 nvCnt;     /* Static and dynamic datapoints */
+    IzotUbits16 aliasCnt;  /* Alias table entries */
+
     char *szSelfDoc;
 
     /* ConfigData Members */
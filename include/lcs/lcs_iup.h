@@ -150,6 +150,31 @@
 #define IUP_COMMIT_RESPONSE_ACTION_TIME 20
 
 #define MAX_PACKET_COUNT_IN_CONFIRM_RESPONSE 20
+
+// Packets whose received markers fit in the IUP persistent data block
+#define IUP_MAX_PACKET_COUNT (EEPROM_BLOCK_SIZE - sizeof(IupPersistent))
+
+// Bytes of consecutive packets collected in RAM before they are written
+// to the passive partition in one flash write
+#ifndef IUP_WRITE_BUFFER_SIZE
+#define IUP_WRITE_BUFFER_SIZE 2048
+#endif
+
+// Bytes of the image added to the digest per MD5 event timer expiry
+#ifndef IUP_MD5_CHUNK_SIZE
+#define IUP_MD5_CHUNK_SIZE 512
+#endif
+
+// Size of the passive partition in the Linux IUP image file, which follows
+// the IUP persistent data block
+#ifndef IUP_IMAGE_PARTITION_SIZE
+#define IUP_IMAGE_PARTITION_SIZE 0x100000
+#endif
+
+// Bytes written to the Linux IUP image file before they are synced
+#ifndef IUP_IMAGE_SYNC_SIZE
+#define IUP_IMAGE_SYNC_SIZE 0x10000
+#endif
 #define IZOT_RESET_TIME_AFTER_SWITCHOVER 60
 
 typedef IZOT_STRUCT_BEGIN(IUP_ImageIdentifier)
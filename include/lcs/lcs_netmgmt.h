@@ -86,6 +86,15 @@ typedef enum {
 #define NME_UPDATE_NV_ALIAS_CONFIG    0x13
 #define	NME_QUERY_NV_ALIAS_CONFIG     0x14
 
+/* Expanded NM commands for ranges of NV, alias and address table entries */
+#define NME_QUERY_CONFIG_RANGE        0x15
+#define NME_UPDATE_CONFIG_RANGE       0x16
+
+/* Tables of NME_QUERY_CONFIG_RANGE and NME_UPDATE_CONFIG_RANGE */
+#define NME_CONFIG_TABLE_NV           0
+#define NME_CONFIG_TABLE_ALIAS        1
+#define NME_CONFIG_TABLE_ADDRESS      2
+
 /* Expanded NM command for mapping announcement */
 #define NME_QUERY_LS_ADDR_MAPPING_ANNOUNCEMENT      0x18
 #define NME_QUERY_IP_ADDRESS						0x19
@@ -205,5 +214,7 @@ Section: Function Prototypes
 void HandleNM(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr);
 void HandleND(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr);
 void HandleProxyResponse(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr);
+void NMNDRespond(NtwkMgmtMsgType msgType, LonStatusCode success,
+        APPReceiveParam *appReceiveParamPtr, APDU *apduPtr);
 
 #endif	// _LCS_NETMGMT_H
@@ -31,7 +31,12 @@
   ------------------------------------------------------------------------------*/
 LonStatusCode NetworkLayerReset(void);
 void   NetworkLayerSend(void);
+IzotByte NWOutQAvailable(Queue *nwQueuePtr, NWTxClass txClass);
+void   NWOutQWrite(Queue *nwQueuePtr, NWTxClass txClass);
+void   NWGetTxStats(NWTxStats *txStatsOut);
+uint32_t NWGetRxFiltered(void);
 void   NetworkLayerReceive(void);
+IzotByte NWAcceptFrame(const IzotByte *npduIn, IzotUbits16 npduSizeIn);
 
 #endif
 
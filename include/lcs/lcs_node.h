@@ -69,15 +69,18 @@ extern "C" {
 #define TID_TABLE_SIZE 10
 
 /* Given a valid primary index of a network variable, get its address */
-#define NV_ADDRESS(i) (nmp->nvFixedTable[i].nvAddress)
+#define NV_ADDRESS(i) (gp->nvFixedTable[i].nvAddress)
 
 /* Given a valid primary index of a network variable, get its length */
-#define NV_LENGTH(i) (nmp->nvFixedTable[i].nvLength)
+#define NV_LENGTH(i) (gp->nvFixedTable[i].nvLength)
 
 /* Given a valid primary index of a network variable, check if it is sync */
 #define NV_SYNC(i) 0  //Sync datapoints are not supported in DX stack
 
 #define ADDR_INDEX(hi, lo) (hi << 4 | lo)
+
+/* Returned by AddrTableIndex() if there is no entry for the group */
+#define ADDR_INDEX_NONE 0xFFFF
 /*Used to correct the responses in the NmQuerySiData() function*/
 #define OFFSET_OF_SI_DATA_BUFFER_IN_SNVT_STRUCT 6
 
@@ -186,6 +189,19 @@ typedef struct __attribute__((__packed__)) {
     void *nvAddress;    /* Ptr to variable's data */
 } NVFixedStruct;
 
+#define IZOT_DATAPOINT_PERSIST_MASK 0x01 /* Added for to store persistent flag */
+#define IZOT_DATAPOINT_PERSIST_SHIFT 0
+#define IZOT_DATAPOINT_PERSIST_FIELD Attribute
+
+#define IZOT_DATAPOINT_CHANGEABLE_TYPE_MASK                                              \
+    0x02 /* Added for to store changeble type flag */
+#define IZOT_DATAPOINT_CHANGEABLE_TYPE_SHIFT 1
+#define IZOT_DATAPOINT_CHANGEABLE_TYPE_FIELD Attribute
+typedef struct __attribute__((packed)) {
+    const IzotByte *ibolSeq;
+    IzotByte Attribute;
+} IzotDpProperty;
+
 typedef struct {
     IzotByte stats[LcsNumStats * 2];
     IzotByte eepromLock;
@@ -502,6 +518,85 @@ typedef struct {
     IzotBits16 dim;     /* The dimension of the array */
 } NVArrayTbl;
 
+/* Result of a network variable poll lookup. matchingIndex is the
+   matching primary or alias index, -1 if there is none, or
+   NV_POLL_AMBIGUOUS if the poll is ignored. hostValue and netValue hold
+   the last value sent for a variable with an IBOL sequence, in host and
+   network format; valueLength is 0 if no value is held. */
+#define NV_POLL_AMBIGUOUS (-2)
+typedef struct {
+    IzotByte valid;
+    IzotByte direction;
+    IzotUbits16 selector;
+    IzotBits16 matchingIndex;
+    IzotUbits16 valueLength;
+    IzotByte hostValue[MAX_NV_LENGTH];
+    IzotByte netValue[MAX_NV_LENGTH];
+} NVPollCacheEntry;
+
+/* Classes of non-priority network layer traffic. See NW_TX_SCHEDULER. */
+typedef enum {
+    NW_TX_RESPONSE, /* Acknowledgements, responses, challenges, and replies */
+    NW_TX_RETRY,    /* Retries of acknowledged and request messages */
+    NW_TX_NEW,      /* New messages */
+
+    NW_TX_CLASS_COUNT
+} NWTxClass;
+
+typedef struct {
+    uint32_t queued;   /* Messages written to nwOutQ */
+    uint32_t deferred; /* Attempts refused for lack of room or turn */
+} NWTxStats;
+
+/* A domain of this node as matched by NetworkLayerReceive() and
+   NWAcceptFrame(). key holds the domain length in its first byte followed
+   by the domain ID, zero padded; a domain that cannot match has
+   NW_DOMAIN_NO_MATCH. subnetNode holds the subnet and node bytes of the
+   domain table entry. Bit g of groups is set if the address table has an
+   entry for group g in the domain. */
+#define NW_DOMAIN_NO_MATCH UINT64_MAX
+typedef struct {
+    uint64_t key;
+    IzotByte subnetNode[2];
+    IzotByte groups[256 / 8];
+} NWDomainMatch;
+
+#if PHYSICAL_IS(LON_PL_PROXY)
+/* Forwarding state of one hop of an LTEP repeat chain, see ProcessLTEP().
+   The first fields are the key: the source and receiving domain, and the
+   raw proxy header, next hop address and txctrl bytes of the received
+   message. The remaining fields are built from the key once and reused
+   for every message of the chain. */
+#ifndef PROXY_FORWARD_CACHE_SIZE
+#define PROXY_FORWARD_CACHE_SIZE 4
+#endif
+typedef struct {
+    IzotByte inUse;
+    IzotByte domainIndex;       /* As received, may be FLEX_DOMAIN */
+    IzotReceiveSubnetNode src;
+    IzotByte header;            /* ProxyHeader */
+    IzotByte hop[2];            /* ProxySubnetNodeAddress of the next hop */
+    IzotByte txctrl;            /* ProxyTxCtrl */
+    IzotSendAddress addr;       /* Address of the next hop */
+    IzotByte nextHeader;        /* ProxyHeader with one less address */
+    IzotByte alt;
+    IzotByte offset;            /* Offset of nextHeader in the APDU data */
+    IzotUbits16 adjust;         /* Transmit timer adjustment for the last retry */
+} ProxyForward;
+#endif  //  PHYSICAL_IS(LON_PL_PROXY)
+
+/* Send time limits of an output network variable. While minTimer runs,
+   updates are held back and pending is set; the latest value is sent
+   when it expires. When maxTimer expires the value is sent again. */
+typedef struct {
+    IzotBits16 nvIndex;    /* Primary index of the variable */
+    uint32_t minSendTime;  /* In milliseconds; 0 for no minimum */
+    uint32_t maxSendTime;  /* In milliseconds; 0 for no heartbeat */
+    LonTimer minTimer;
+    LonTimer maxTimer;
+    IzotByte pending;
+} NVSendTime;
+
 typedef struct {
     IzotBool8 downloading;        // true => doing a download
     IzotBool8 switchoverFailure;  // true => switchover failed
@@ -533,6 +628,36 @@ typedef struct {
     IzotByte        mallocStorage[MALLOC_SIZE];
 #endif
 
+    /* Arena for the layer queues and receive records; see STACK_ARENA_SIZE */
+    void           *arenaBlock;     // Block returned by OsalAllocateMemory()
+    IzotByte       *arena;          // Aligned start of the arena
+    size_t          arenaSize;      // Usable size of the arena in bytes
+    size_t          arenaUsed;      // Bytes allocated since the last reset
+    void           *arenaOverflow;  // Heap blocks used when the arena is full
+
+    /* Address, datapoint and alias tables, sized from the counts given to
+       IzotCreateStack() and allocated once by InitEEPROM(). The address,
+       datapoint configuration and alias tables are part of the network
+       image; see LCS_SaveConfigTables(). */
+    void                *tableBlock;       // Block holding all of the tables
+    IzotUbits16          addrTableSize;    // Address table entries
+    IzotUbits16          nvTableCapacity;  // Datapoint entries; nmp->nvTableSize are used
+    IzotUbits16          nvAliasTableSize; // Alias table entries
+    IzotAddress         *addrTable;
+    IzotDatapointConfig *nvConfigTable;
+    IzotAliasConfig     *nvAliasTable;
+    IzotByte             tablesChanged;    // TRUE ==> tables changed since the
+                                           // last network image write
+    NVFixedStruct       *nvFixedTable;
+    IzotDpProperty      *dpProp;
+
+    /* Address table indices of the group entries, ordered by domain and
+       group; see GroupAddrEntries().  Rebuilt on demand after the address
+       table changes. */
+    IzotUbits16         *addrGroupIndex;
+    IzotUbits16          addrGroupCount;
+    IzotByte             addrGroupIndexValid;
+
     /* Variables for Transaction Control Sublayer */
     TransCtrlRecord priTransCtrlRec;
 
@@ -627,6 +752,24 @@ typedef struct {
     Queue nwOutPriQ;
     IzotUbits16 nwOutPriBufSize;
     IzotUbits16 nwOutPriQCnt;
+
+    /* Transmit scheduling of nwOutQ, see NWOutQAvailable(). A class sets
+       its bit in nwTxWaiting when it is refused; NetworkLayerSend()
+       moves the bits to nwTxWaitingLast, so a class counts as waiting
+       until one pass of LCS_Service() after it last asked. */
+    IzotByte nwTxCredit[NW_TX_CLASS_COUNT];
+    IzotByte nwTxWaiting;
+    IzotByte nwTxWaitingLast;
+    NWTxStats nwTxStats[NW_TX_CLASS_COUNT];
+
+    /* Domains of this node for NetworkLayerReceive() and NWAcceptFrame().
+       Rebuilt from the domain and address tables on the next receive
+       after nwDomainMatchValid is cleared, which is done for every
+       configuration change by RecomputeChecksum(), and by UpdateDomain()
+       and UpdateAddress(). */
+    NWDomainMatch nwDomainMatch[MAX_DOMAINS];
+    IzotByte nwDomainMatchValid;
+    uint32_t nwRxFiltered;  /* NPDUs dropped by NWAcceptFrame(), see NWGetRxFiltered() */
 #if LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS) || LINK_IS(SPI_MIP)
     /* Input Queue For Link Layer */
     IzotByte *lkInQ;
@@ -719,6 +862,40 @@ typedef struct {
     IzotByte nvOutCanSchedule; /* TRUE --> can continue to schedule. */
     IzotBits16 nvOutIndex;     /* current primary index scheduled.   */
 
+    /* Bound output network variables, so that propagating all outputs
+       does not scan every network variable and the alias table for each.
+       nvOutBound holds the primary index of each bound output variable
+       in ascending order. The aliases of nvOutBound[i] are
+       nvOutBoundAlias[nvOutBoundAliasStart[i]] up to, but not including,
+       nvOutBoundAlias[nvOutBoundAliasStart[i + 1]]. The lists are rebuilt
+       on the next propagate after nvOutBoundValid is cleared, which is
+       done for every configuration change by RecomputeChecksum(). */
+    IzotBits16 *nvOutBound;             // nvTableCapacity entries
+    IzotUbits16 *nvOutBoundAliasStart;  // nvTableCapacity + 1 entries
+    IzotBits16 *nvOutBoundAlias;        // nvAliasTableSize entries
+    IzotUbits16 nvOutBoundCount;
+    IzotByte nvOutBoundValid;
+#if NV_OUT_COALESCING
+    /* One bit per primary index; set while an update for the variable is
+       in nvOutIndexQ and not yet started. See NV_OUT_COALESCING. */
+    IzotByte *nvOutPending;  // (nvTableCapacity + 7) / 8 bytes
+#endif
+
+    /* Recent network variable poll lookups, indexed by selector and
+       direction. See NV_POLL_CACHE_SIZE. The entries are discarded on
+       the next poll after nvPollCacheValid is cleared, which is done
+       together with nvOutBoundValid. */
+    NVPollCacheEntry nvPollCache[NV_POLL_CACHE_SIZE];
+    IzotByte nvPollCacheValid;
+
+    /* Output variables with send time limits. nvSendTimeSlot[i] is the
+       position of primary index i in nvSendTime if it is listed there;
+       it is only valid if that entry names i, so it needs no
+       initialization. */
+    NVSendTime nvSendTime[NV_SEND_TIME_COUNT];
+    IzotUbits16 nvSendTimeCount;
+    IzotByte *nvSendTimeSlot;  // nvTableCapacity entries
+
     /* Queue of nvIndex for network input variables.
        This queue stores the input variables that scheduled
        to be polled. Each item exactly 2 bytes to store the index
@@ -775,6 +952,13 @@ typedef struct {
 #if PHYSICAL_IS(LON_PL_PROXY)
     /* Proxy repeating buffer wait timer */
     LonTimer proxyBufferWait;
+
+    /* Recent repeat chains, replaced round robin. Cleared on the next
+       proxy message after proxyForwardValid is cleared by
+       RecomputeChecksum(), since the addresses use the domain subnet. */
+    ProxyForward proxyForward[PROXY_FORWARD_CACHE_SIZE];
+    IzotByte proxyForwardNext;
+    IzotByte proxyForwardValid;
 #endif  //  PHYSICAL_IS(LON_PL_PROXY)
 
     /* Miscellaneous non-volatile data */
@@ -787,7 +971,7 @@ typedef struct {
 
 typedef struct {
     IzotByte domain;
-    IzotByte address;
+    IzotUbits16 address;
     IzotByte nv;
     IzotByte alias;
 } Dimensions;
@@ -796,11 +980,10 @@ typedef struct {
     IzotReadOnlyData readOnlyData;
     IzotConfigData configData;
     IzotDomain domainTable[MAX_DOMAINS];
-    IzotAddress addrTable[NUM_ADDR_TBL_ENTRIES];
-    IzotDatapointConfig nvConfigTable[NV_TABLE_SIZE];
-    IzotAliasConfig nvAliasTable[NV_ALIAS_TABLE_SIZE];  // Checksum for config structure
-    IzotByte configCheckSum;                            // Exclusive or of successive
-                                                        // bytes in config structure
+    // The address, datapoint configuration and alias tables follow this
+    // structure in the network image; see ProtocolStackData
+    IzotByte configCheckSum;  // Exclusive or of successive bytes in the config
+                              // structure, domain table and tables
     LonStatusCode errorLog;
     Dimensions dimensions;
     IzotByte nvInitCount;
@@ -821,23 +1004,10 @@ typedef struct {
     StatsStruct stats;
     SNVTstruct snvt;
     IzotByte resetCause;
-    NVFixedStruct nvFixedTable[NV_TABLE_SIZE];
     IzotUbits16 nvTableSize; /* Config or Fixed */
     RxStats rxStat;
 } NmMap; /* Memory Map */
 
-#define IZOT_DATAPOINT_PERSIST_MASK 0x01 /* Added for to store persistent flag */
-#define IZOT_DATAPOINT_PERSIST_SHIFT 0
-#define IZOT_DATAPOINT_PERSIST_FIELD Attribute
-
-#define IZOT_DATAPOINT_CHANGEABLE_TYPE_MASK                                              \
-    0x02 /* Added for to store changeble type flag */
-#define IZOT_DATAPOINT_CHANGEABLE_TYPE_SHIFT 1
-#define IZOT_DATAPOINT_CHANGEABLE_TYPE_FIELD Attribute
-typedef struct __attribute__((packed)) {
-    const IzotByte *ibolSeq;
-    IzotByte Attribute;
-} IzotDpProperty;
 /*-------------------------------------------------------------------
   Section: Global Variables
   -------------------------------------------------------------------*/
@@ -852,7 +1022,6 @@ extern SNVTCapabilityInfo capability_info;
 extern SNVTCapabilityInfo *snvt_capability_info;
 extern SIHeaderExt header_ext;
 extern SIHeaderExt *si_header_ext;
-extern IzotDpProperty izot_dp_prop[NV_TABLE_SIZE];
 
 /*-------------------------------------------------------------------
   Section: Function Prototypes
@@ -863,6 +1032,8 @@ LonStatusCode UpdateDomain(const IzotDomain *domainInp, IzotByte indexIn,
 IzotAddress *AccessAddress(IzotUbits16 indexIn);
 LonStatusCode UpdateAddress(const IzotAddress *addrEntryInp, IzotUbits16 indexIn);
 IzotUbits16 AddrTableIndex(IzotByte domainIndexIn, IzotByte groupIn);
+IzotUbits16 GroupAddrEntries(IzotByte domainIndexIn, IzotByte groupIn,
+        const IzotUbits16 **entriesOut);
 IzotByte IsGroupMember(IzotByte domainIndex, IzotByte groupIn, IzotByte *groupMemberOut);
 LonStatusCode DecodeBufferSize(IzotByte bufSizeIn, uint16_t *decodedSizeOut);
 LonStatusCode DecodeBufferCnt(IzotByte bufCntIn, uint16_t *decodedCountOut);
@@ -877,10 +1048,16 @@ IzotAliasConfig *AccessAlias(IzotUbits16 indexIn);
 void UpdateAlias(IzotAliasConfig *aliasStructInp, IzotUbits16 indexIn);
 IzotUbits16 AliasTableIndex(char varNameIn[]);
 LonStatusCode NodeReset(IzotByte firstReset);
+void *StackArenaAllocate(size_t size);
+LonStatusCode StackQueueInit(Queue *queue_out, char *queue_name, size_t entry_size,
+        size_t queue_capacity);
 void NodeReset_wrapper(void);
 LonStatusCode InitEEPROM(uint32_t app_signature);
 IzotByte CheckSum8(void *data, IzotUbits16 lengthIn);
 IzotByte ComputeConfigCheckSum(void);
+size_t LCS_ConfigTablesSize(void);
+void LCS_SaveConfigTables(IzotByte *image);
+void LCS_LoadConfigTables(const IzotByte *image);
 IzotBits16 GetPrimaryIndex(IzotBits16 nvIndexIn);
 IzotDatapointConfig *GetNVStructPtr(IzotBits16 nvIndexIn);
 IzotByte IsTagBound(IzotByte tagin);
@@ -21,6 +21,14 @@
 #define NUM_LON_NI 1 
 #endif
 
+#ifndef LON_NI_BONDING
+// Set to 1 if all LON network interfaces of a MULTIPLE_USB_MIPS link are
+// attached to the same channel.  Each downlink frame is then sent through
+// one ready interface, chosen by downlink queue depth and ack latency, and
+// an uplink frame received by more than one interface is passed up once.
+#define LON_NI_BONDING 0
+#endif
+
 // The base LON Stack version on which this implementation is based.
 // The base firmware version number is reported in the ND_QUERY_STATUS
 // response as an implementation-defined value.
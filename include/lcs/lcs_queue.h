@@ -15,7 +15,8 @@
  *          For queues, the user must specify the size of each item and the
  *          total capacity when initializing.  For ring buffers, the user 
  *          specifies the total byte capacity.  The data storage for both 
- *          structures is allocated within the initialization functions.
+ *          structures is allocated within the initialization functions,
+ *          or provided by the caller with QueueInitStorage().
  */
 
 #ifndef _LCS_QUEUE_H
@@ -26,23 +27,26 @@
 
 #include "izot/lon_types.h"
 
-// Maximum static capacity for any RingBuffer instance. Can be overridden
-// before including this header (e.g., via compiler flag) if larger bursts are needed.
-#ifndef RING_BUFFER_MAX_CAPACITY
-#define RING_BUFFER_MAX_CAPACITY 2048
+// Default capacity for a RingBuffer instance. Can be overridden before
+// including this header (e.g., via compiler flag) if larger bursts are needed.
+// Ring buffer capacities are rounded up to a power of two.
+#ifndef RING_BUFFER_DEFAULT_CAPACITY
+#define RING_BUFFER_DEFAULT_CAPACITY 2048
 #endif
 
 typedef struct RingBuffer {
-    size_t   size;      // active capacity in bytes (<= RING_BUFFER_MAX_CAPACITY)
+    size_t   size;      // active capacity in bytes (power of two)
+    size_t   mask;      // size - 1; wraps head and tail positions
     size_t   head;      // write position
     size_t   tail;      // read position
     size_t   count;     // bytes currently stored
-    uint8_t  data[RING_BUFFER_MAX_CAPACITY]; // internal storage
+    uint8_t  *data;     // storage from RingBufferInit() or RingBufferInitStorage()
 } RingBuffer;
 
 /*****************************************************************
  * Section: Queue Operations Function Declarations
  *****************************************************************/
+#if !STACK_STATIC_ALLOCATION
 /*
  * Initializes a queue with the specified capacity and entry size.
  * Parameters:
@@ -59,6 +63,24 @@ typedef struct RingBuffer {
  *  queue size is initialized to zero, and the entry size is stored.
  */
 LonStatusCode QueueInit(Queue *queue_out, char *queue_name, size_t entry_size, size_t queue_capacity);
+#endif  // !STACK_STATIC_ALLOCATION
+
+/*
+ * Initializes a queue in storage provided by the caller.
+ * Parameters:
+ *   queue_out: Pointer to the queue to initialize.
+ *   queue_name: Optional name of the queue (for debugging); not copied
+ *   entry_size: Size of each entry in the queue in bytes.
+ *   queue_capacity: Capacity of the queue in entries.
+ *   storage: At least entry_size * queue_capacity bytes for the entries.
+ * Returns:
+ *   LonStatusNoError if successful; LonStatusCode error code if unsuccessful.
+ * Notes:
+ *   The caller owns the storage and the name, which must remain valid
+ *   for as long as the queue is used.
+ */
+LonStatusCode QueueInitStorage(Queue *queue_out, char *queue_name, size_t entry_size,
+        size_t queue_capacity, void *storage);
 
 /* 
  * Returns the current size of a queue.
@@ -104,15 +126,32 @@ void *QueueTail(Queue *queue_in);
 /*****************************************************************
  * Section: Ring Buffer Operations Function Declarations
  *****************************************************************/
+#if !STACK_STATIC_ALLOCATION
 /*
  * Initializes a ring buffer with the specified capacity.
  * Parameters:
  *   rb: Pointer to the ring buffer to initialize.
- *   capacity: Capacity of the ring buffer in bytes.
+ *   capacity: Capacity of the ring buffer in bytes; rounded up to a power of two.
  * Returns:
  *   LonStatusNoError if successful; LonStatusCode error code if unsuccessful.
+ * Notes:
+ *   The data storage for the ring buffer is allocated within this function
+ *   and is reused if the ring buffer is initialized again with the same
+ *   capacity.
  */
 LonStatusCode RingBufferInit(RingBuffer *rb, size_t capacity);
+#endif  // !STACK_STATIC_ALLOCATION
+
+/*
+ * Initializes a ring buffer in storage provided by the caller.
+ * Parameters:
+ *   rb: Pointer to the ring buffer to initialize.
+ *   storage: Storage for the ring buffer data.
+ *   size: Size of the storage in bytes; must be a power of two.
+ * Returns:
+ *   LonStatusNoError if successful; LonStatusCode error code if unsuccessful.
+ */
+LonStatusCode RingBufferInitStorage(RingBuffer *rb, uint8_t *storage, size_t size);
 
 /*
  * Returns the available space in a ring buffer.
@@ -172,4 +211,55 @@ size_t RingBufferPeek(const RingBuffer *rb, uint8_t *dst, size_t len);
  */
 size_t RingBufferRead(RingBuffer *rb, uint8_t *dst, size_t len);
 
+/*
+ * Reserves the contiguous free space at the write position of a ring buffer
+ * so that a producer can fill it in place.
+ * Parameters:
+ *   rb: Pointer to the ring buffer.
+ *   span: Pointer to receive the start of the free span.
+ * Returns:
+ *   Number of contiguous bytes available at *span; 0 if the ring is full.
+ * Notes:
+ *   Call RingBufferWriteCommit() with the number of bytes filled.  The span
+ *   ends at the end of the storage; a second reserve after the commit returns
+ *   the free space at the start of the storage.  Only one producer may hold a
+ *   reservation at a time.
+ */
+size_t RingBufferWriteReserve(RingBuffer *rb, uint8_t **span);
+
+/*
+ * Commits bytes written to a span returned by RingBufferWriteReserve().
+ * Parameters:
+ *   rb: Pointer to the ring buffer.
+ *   len: Number of bytes written to the reserved span.
+ * Returns:
+ *   Number of bytes actually committed.
+ */
+size_t RingBufferWriteCommit(RingBuffer *rb, size_t len);
+
+/*
+ * Returns the contiguous stored data at the read position of a ring buffer
+ * so that a consumer can process it in place.
+ * Parameters:
+ *   rb: Pointer to the ring buffer.
+ *   span: Pointer to receive the start of the stored data.
+ * Returns:
+ *   Number of contiguous bytes available at *span; 0 if the ring is empty.
+ * Notes:
+ *   Call RingBufferReadConsume() to remove the processed bytes.  Only one
+ *   consumer may process a span at a time.
+ */
+size_t RingBufferReadPeekContiguous(const RingBuffer *rb, const uint8_t **span);
+
+/*
+ * Removes bytes from the read position of a ring buffer after they have been
+ * processed in place.
+ * Parameters:
+ *   rb: Pointer to the ring buffer.
+ *   len: Number of bytes to remove.
+ * Returns:
+ *   Number of bytes actually removed.
+ */
+size_t RingBufferReadConsume(RingBuffer *rb, size_t len);
+
 #endif  // _LCS_QUEUE_H
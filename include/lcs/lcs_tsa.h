@@ -61,5 +61,6 @@ void AuthSend(void);
 void AuthReceive(void);
 
 LonStatusCode TSA_AddressConversion(IzotSendAddress* pSrc, DestinationAddress *pDst);
+void TSA_RefreshAuthKeySchedules(void);
 
 #endif
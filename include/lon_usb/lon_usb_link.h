@@ -95,11 +95,32 @@
 #define MAX_BYTES_PER_USB_PARSE_CHUNK 128
 #endif
 
+// USB receive ring buffer capacity in bytes per interface; rounded up to a
+// power of two
+#ifndef LON_USB_UPLINK_RING_CAPACITY
+#define LON_USB_UPLINK_RING_CAPACITY RING_BUFFER_DEFAULT_CAPACITY
+#endif
+
 // Maximum bytes to parse from the USB receive ring buffer per parse window
 #ifndef MAX_BYTES_PER_USB_PARSE_WINDOW
 #define MAX_BYTES_PER_USB_PARSE_WINDOW 512
 #endif
 
+// Maximum time in milliseconds for the USB reader thread to wait for receive
+// data before checking for interfaces paused for a full receive ring buffer
+#ifndef LON_USB_READER_WAIT_MS
+#define LON_USB_READER_WAIT_MS 100
+#endif
+
+#if USB_UPLINK_IS(EPOLL) && !LINK_IS(MULTIPLE_USB_MIPS)
+#error "USB_UPLINK_ID_EPOLL requires LINK_ID_MULTIPLE_USB_MIPS"
+#endif
+
+// Maximum number of downlink code packets gathered into one USB write
+#ifndef MAX_DOWNLINK_BATCH_CODE_PACKETS
+#define MAX_DOWNLINK_BATCH_CODE_PACKETS 4
+#endif
+
 // Maximum number of LON USB interfaces supported
 #ifndef MAX_IFACE_STATES
 #define MAX_IFACE_STATES 4
@@ -139,6 +160,7 @@ typedef struct LonDownlinkStats {
   size_t bytes_sent;        // Total bytes sent
   size_t tx_aborted_errors; // Incomplete downlink transmit errors
   size_t tx_rejects;        // Downlink message rejects by network interface
+  size_t tx_writes;         // USB write calls for downlink frames
 } LonDownlinkStats;
 
 // USB RX staging statistics structure; tracks ring-buffer receive staging
@@ -496,6 +518,9 @@ typedef struct LonUsbLinkState {
   char lon_dev_name[FILENAME_MAX];
   char usb_dev_name[DEVICE_NAME_MAX];
   int usb_fd; // USB device file descriptor
+  bool rx_paused; // True if the USB reader thread stopped reading this
+                  // interface because its receive ring buffer is full;
+                  // protected by queue_lock
 
   // LON USB interface type (MIP/U50 vs MIP/U61)
   LonUsbIfaceType lon_usb_iface_type;
@@ -542,6 +567,8 @@ typedef struct LonUsbLinkState {
   int uplink_ack_timeouts;          // Uplink ack timeout count
   int uplink_ack_timeout_phase;     // Uplink ack timeout phase, incremented on
                                     // repeated timeouts
+  OsalTickCount downlink_ack_latency; // Average time in ms ticks from sending
+                                      // a downlink frame to its ack
   LonNiCommand uplink_expected_rsp; // Expected uplink response command
 
   // Downlink packet state machine
@@ -556,11 +583,22 @@ typedef struct LonUsbLinkState {
   // can be processed at a time due to the state lock
   LonUsbQueueBuffer
       downlink_buffer; // Current downlink buffer from the head of the downlink
-                       // queue; this buffer is expanded to
-                       // exp_downlink_ni_data_frame[] in WriteDownlinkMessage()
-  uint8_t exp_downlink_ni_data_frame[MAX_EXP_LON_MSG_EX_LEN];
-  // Expanded downlink data frame used to build the message
-  // data frame to be written to the USB interface
+                       // queue; WriteDownlinkMessage() adds runs of this
+                       // buffer to the downlink batch, so it must not be
+                       // overwritten until the batch is written
+  // Downlink transmit batch; code packets and message runs are gathered here
+  // by WriteDownlinkCodePacket() and WriteDownlinkMessage() and written with
+  // one HalWriteUsbV() call by WriteDownlinkBatch()
+  HalUsbIoVec downlink_batch_iov[HAL_USB_MAX_IOV];
+  int downlink_batch_iov_count; // Entries used in downlink_batch_iov[]
+  LonFrameHeader downlink_batch_cps[MAX_DOWNLINK_BATCH_CODE_PACKETS];
+  // Code packets referenced by downlink_batch_iov[]
+  int downlink_batch_cp_count;  // Entries used in downlink_batch_cps[]
+  uint8_t downlink_batch_trailer[2]; // Message checksum and stuffed FRAME_SYNC
+  int downlink_batch_msgs;           // Messages in the batch (0 or 1)
+  size_t downlink_batch_msg_bytes;   // Expanded message bytes in the batch
+  bool downlink_batching; // True while LonUsbDownlinkSend() gathers frames;
+                          // false to write each frame when it is built
   int downlink_seq_number;     // Downlink sequence number
   int downlink_ack_seq_number; // Downlink sequence number to be acknowledged
                                // Set to NO_ACK_REQUIRED if no ack is pending
@@ -663,6 +701,22 @@ bool LonUsbLinkReady(void);
 bool LonUsbLinkReady(int iface_index);
 #endif // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
 
+/*
+ * Reads the downlink load of a LON USB network interface (multiple USB MIPS
+ * only).
+ * Parameters:
+ *   iface_index: LON interface index returned by OpenLonUsbLink()
+ *   queued: receives the number of downlink messages waiting to be sent
+ *   ack_latency: receives the average time in ms ticks from sending a
+ *             downlink frame to its ack
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful
+ */
+#if LINK_IS(MULTIPLE_USB_MIPS)
+LonStatusCode GetLonUsbLinkLoad(int iface_index, size_t *queued,
+                                OsalTickCount *ack_latency);
+#endif // LINK_IS(MULTIPLE_USB_MIPS)
+
 /*
  * Writes a downlink message to the LON USB network interface.
  * Parameters:
@@ -726,6 +780,25 @@ void LonUsbMsgIsr(
     uint8_t *usb_data, size_t usb_data_len);
 #endif // USB_UPLINK_IS(INTERRUPT)
 
+/*
+ * Waits for uplink data from any LON USB network interface.
+ * Parameters:
+ *   wait_ms: maximum time to wait in milliseconds
+ * Returns:
+ *   LonStatusNoError if uplink data was received since the last call;
+ *   LonStatusTimeout if no uplink data was received within wait_ms;
+ *   LonStatusCode error code if unsuccessful
+ * Notes:
+ *   The USB reader thread signals when it stages received bytes for any
+ *   interface.  An application can call this function between calls to the
+ *   LON Stack event pump instead of polling each interface.  Follow a
+ *   successful return by calling ReadLonUsbMsg() until no message is
+ *   available for each interface.
+ */
+#if USB_UPLINK_IS(EPOLL)
+LonStatusCode WaitLonUsbUplink(unsigned int wait_ms);
+#endif // USB_UPLINK_IS(EPOLL)
+
 /*
  * Closes a LON USB network interface (multiple USB MIPS only).
  * Parameters:
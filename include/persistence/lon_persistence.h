@@ -105,6 +105,20 @@ extern void IzotPersistentMemCommitCheck(void);
  */
 extern void IzotPersistentMemSetCommitFlag(void);
 
+/*
+ * Function: IzotPersistentImageAllocate
+ * This function returns a buffer for a serialized segment image, or NULL
+ * if none is available.  The static build returns one static buffer that
+ * all segments share.
+ */
+extern IzotByte *IzotPersistentImageAllocate(size_t length);
+
+/*
+ * Function: IzotPersistentImageFree
+ * This function releases a buffer returned by IzotPersistentImageAllocate().
+ */
+extern void IzotPersistentImageFree(IzotByte *image);
+
 /*
  * Function: IzotPersistentSegRestore
  * This function restores the specified memory segment contents to RAM.
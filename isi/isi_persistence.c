@@ -97,7 +97,10 @@ LtPersistenceLossReason serializeIsiNvdSegPersistentData(IzotByte **pBuffer, siz
     IzotByte *pBuf;
 
     // Allocate memory for the serialization
-    *pBuffer = (IzotByte *)OsalAllocateMemory(image_len);
+    *pBuffer = IzotPersistentImageAllocate(image_len);
+    if (*pBuffer == NULL) {
+        return LT_PERSISTENT_WRITE_FAILURE;
+    }
     memset(*pBuffer, 0, image_len);
     *len = image_len;
     pBuf = *pBuffer;
@@ -126,7 +129,10 @@ LtPersistenceLossReason serializeIsiNvdSegConnectionTable(IzotByte **pBuffer, si
     size_t image_len = IsiGetConnectionTableSize() * sizeof(IsiConnection);
 
     // Allocate memory for the serialization
-    *pBuffer = (IzotByte *)OsalAllocateMemory(image_len);
+    *pBuffer = IzotPersistentImageAllocate(image_len);
+    if (*pBuffer == NULL) {
+        return LT_PERSISTENT_WRITE_FAILURE;
+    }
     *len = image_len;
 
     memcpy((void *)*pBuffer, (const void *)IsiGetConnection(0), image_len);
@@ -239,7 +245,7 @@ void savePersistentData(IzotPersistentSegType persistent_seg_type)
         }
 
         if (pImage != NULL) {
-            OsalFreeMemory(pImage);
+            IzotPersistentImageFree(pImage);
         }
     }
 }
@@ -274,13 +280,13 @@ LtPersistenceLossReason restorePersistentData(IzotPersistentSegType persistent_s
         } else {
             nVersion = hdr.version;
             imageLen = hdr.length;
-            pBuffer = (IzotByte *)OsalAllocateMemory(imageLen);
+            pBuffer = IzotPersistentImageAllocate(imageLen);
             if (pBuffer == NULL ||
                     IzotPersistentSegRead(returnedSegType, sizeof(hdr), imageLen,
                             pBuffer) != 0 ||
                     !ValidatePersistenceChecksum(&hdr, pBuffer)) {
                 reason = LT_CORRUPTION;
-                OsalFreeMemory(pBuffer);
+                IzotPersistentImageFree(pBuffer);
                 pBuffer = NULL;
             }
         }
@@ -300,7 +306,7 @@ LtPersistenceLossReason restorePersistentData(IzotPersistentSegType persistent_s
     }
 
     if (pBuffer != NULL) {
-        OsalFreeMemory(pBuffer);
+        IzotPersistentImageFree(pBuffer);
     }
 
     return reason;
@@ -96,6 +96,13 @@
 #define MAX_STOP_OFFSET 0xFFFF
 #define IBOL_FINISH 0xFF
 
+#if NV_OUT_COALESCING
+// Pending bits of primary network output variables; see NV_OUT_COALESCING
+#define NV_OUT_PENDING(i) (gp->nvOutPending[(i) / 8] & (1 << ((i) % 8)))
+#define SET_NV_OUT_PENDING(i) (gp->nvOutPending[(i) / 8] |= (1 << ((i) % 8)))
+#define CLEAR_NV_OUT_PENDING(i) (gp->nvOutPending[(i) / 8] &= ~(1 << ((i) % 8)))
+#endif  // NV_OUT_COALESCING
+
 /*****************************************************************
  * Section: Globals
  *****************************************************************/
@@ -118,6 +125,9 @@ static int dpPropInitCount;
 static void ProcessNV(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr);
 static void ProcessNVUpdate(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr);
 static void ProcessNVPoll(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr);
+static NVPollCacheEntry *FindPolledNV(IzotUbits16 selector, IzotByte nvDirection);
+static void GetPolledValue(NVPollCacheEntry *entry, IzotUbits16 primaryIndex,
+        IzotByte *ndi, IzotUbits16 len);
 static void HandleMsgCompletion(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr);
 static void HandleResponse(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr);
 static void HandleNormal(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr);
@@ -128,7 +138,15 @@ static void ReinitMsgOut();
 static void ReinitRespOut();
 
 static LonStatusCode PropagateThisIndex(IzotBits16 nvIndexIn, IzotBits16 primaryIndex);
-static void PropagateThisPrimary(IzotBits16 nvIndexIn);
+static LonStatusCode PropagateThisPrimary(IzotBits16 nvIndexIn);
+static LonStatusCode PropagateBoundOutput(IzotUbits16 position);
+static IzotUbits16 BoundOutputEntries(IzotUbits16 position);
+static IzotUbits16 NvOutIndexQSpace(void);
+static NVSendTime *FindSendTime(IzotBits16 nvIndex);
+static void CheckSendTimes(void);
+static void RefreshBoundOutputs(void);
+static IzotBits16 FindBoundOutput(IzotBits16 nvIndexIn);
+static IzotByte IsAddrIndexBound(IzotByte addrIndex);
 static void SendVar(void);
 
 static LonStatusCode PollThisIndex(IzotBits16 nvIndexIn);
@@ -162,8 +180,8 @@ LonStatusCode AllocSendUnackd(PktCtrl ctrl, MsgTag tag, IzotSendAddress *pSrc,
         DestinType code, IzotByte data0, int len, IzotByte *pData)
 {
     Queue *nwOutQPtr = (ctrl & PKT_PRIORITY) ? &gp->nwOutPriQ : &gp->nwOutQ;
-    LonStatusCode sts =
-            QueueFull(nwOutQPtr) ? LonStatusNoBufferAvailable : LonStatusNoError;
+    LonStatusCode sts = NWOutQAvailable(nwOutQPtr, NW_TX_NEW) ? LonStatusNoError
+                                                              : LonStatusNoBufferAvailable;
     if (sts == LonStatusNoError && len + 1 > gp->nwOutBufSize) {
         OsalPrintLog(ERROR_LOG, LonStatusInvalidBufferLength,
                 "AllocSendUnackd: Invalid buffer length");
@@ -189,7 +207,7 @@ LonStatusCode AllocSendUnackd(PktCtrl ctrl, MsgTag tag, IzotSendAddress *pSrc,
             if (len > 1) {
                 memcpy(&apduPtr->data[1], pData, len - 1);
             }
-            QueueWrite(nwOutQPtr);
+            NWOutQWrite(nwOutQPtr, NW_TX_NEW);
         }
     }
     return sts;
@@ -286,7 +304,7 @@ LonStatusCode AppLayerInit(void)
     gp->unboundSelector = 0x3FFF;  // Countdown as we assign
     gp->nvArrayTblSize = 0;
     gp->nextBindableMsgTag = 0;
-    gp->nextNonbindableMsgTag = NUM_ADDR_TBL_ENTRIES;
+    gp->nextNonbindableMsgTag = gp->addrTableSize;
 
     /***************************************************************************
       The SNVT area has the following layout (as expected by LON tools:
@@ -356,6 +374,7 @@ LonStatusCode AppLayerInit(void)
     nmp->snvt.aliasPtr->aliasCount = 0x3F;  // host based node
     nmp->snvt.aliasPtr->hostAlias = hton16(AliasTableCount);
     nmp->nvTableSize = 0;
+    gp->nvSendTimeCount = 0;
     gp->initialized = true;
     OsalPrintLog(INFO_LOG, status, "AppLayerInit: Application layer initialized");
     return status;
@@ -373,6 +392,7 @@ LonStatusCode AppLayerInit(void)
 LonStatusCode AppLayerReset(void)
 {
     IzotUbits16 queueItemSize;
+    IzotUbits16 i;
     LonStatusCode status = LonStatusNoError;
 
     gp->resetOk = TRUE;
@@ -397,9 +417,9 @@ LonStatusCode AppLayerReset(void)
     }
     queueItemSize = gp->appInBufSize + sizeof(APPReceiveParam);
 
-    if (!LON_SUCCESS(status = QueueInit(&gp->appInQ, "application layer input",
+    if (!LON_SUCCESS(status = StackQueueInit(&gp->appInQ, "application layer input",
                              queueItemSize, gp->appInQCnt)) ||
-            !LON_SUCCESS(status = QueueInit(&gp->appCeRspInQ,
+            !LON_SUCCESS(status = StackQueueInit(&gp->appCeRspInQ,
                                  "application layer CE response input", queueItemSize,
                                  gp->appInQCnt))) {
         OsalPrintLog(ERROR_LOG, LonStatusStackInitializationFailure,
@@ -429,7 +449,7 @@ LonStatusCode AppLayerReset(void)
         return status;
     }
     queueItemSize = gp->appOutBufSize + sizeof(APPSendParam);
-    if (!LON_SUCCESS(status = QueueInit(&gp->appOutQ, "application layer output",
+    if (!LON_SUCCESS(status = StackQueueInit(&gp->appOutQ, "application layer output",
                              queueItemSize, gp->appOutQCnt))) {
         OsalPrintLog(ERROR_LOG, status, "APPReset: Unable to initialize output queue");
         gp->resetOk = FALSE;
@@ -450,7 +470,7 @@ LonStatusCode AppLayerReset(void)
     }
     queueItemSize = gp->appOutPriBufSize + sizeof(APPSendParam);
     if (!LON_SUCCESS(
-                status = QueueInit(&gp->appOutPriQ, "application layer priority output",
+                status = StackQueueInit(&gp->appOutPriQ, "application layer priority output",
                         queueItemSize, gp->appOutPriQCnt))) {
         OsalPrintLog(ERROR_LOG, status,
                 "APPReset: Unable to initialize priority output queue");
@@ -461,7 +481,7 @@ LonStatusCode AppLayerReset(void)
     // Allocate and initialize queue for NV output variable scheduling
     gp->nvOutIndexQCnt = MAX_NV_OUT;
     gp->nvOutIndexBufSize = 2 + MAX_NV_LENGTH;
-    if (!LON_SUCCESS(status = QueueInit(&gp->nvOutIndexQ, "application layer NV output",
+    if (!LON_SUCCESS(status = StackQueueInit(&gp->nvOutIndexQ, "application layer NV output",
                              gp->nvOutIndexBufSize, gp->nvOutIndexQCnt))) {
         OsalPrintLog(ERROR_LOG, status,
                 "APPReset: Unable to initialize output NV index queue");
@@ -472,10 +492,20 @@ LonStatusCode AppLayerReset(void)
                                          // transactions complete successfully
     gp->nvOutCanSchedule = TRUE;
     gp->nvOutIndex = 0;  // Not relevant initially
+    gp->nvOutBoundValid = FALSE;  // Rebuilt on first propagate
+    gp->nvPollCacheValid = FALSE;  // Cleared on first poll
+    for (i = 0; i < gp->nvSendTimeCount; i++) {
+        gp->nvSendTime[i].pending = FALSE;
+        SetLonTimer(&gp->nvSendTime[i].minTimer, 0);
+        SetLonTimer(&gp->nvSendTime[i].maxTimer, gp->nvSendTime[i].maxSendTime);
+    }
+#if NV_OUT_COALESCING
+    memset(gp->nvOutPending, 0, (gp->nvTableCapacity + 7) / 8);
+#endif  // NV_OUT_COALESCING
 
     // Allocate and initialize queue for NV input variable scheduling
     gp->nvInIndexQCnt = MAX_NV_IN;
-    if (!LON_SUCCESS(status = QueueInit(&gp->nvInIndexQ, "application layer NV input", 2,
+    if (!LON_SUCCESS(status = StackQueueInit(&gp->nvInIndexQ, "application layer NV input", 2,
                              gp->nvInIndexQCnt))) {
         OsalPrintLog(ERROR_LOG, status,
                 "APPReset: Unable to initialize input NV index queue");
@@ -848,6 +878,9 @@ void AppLayerSend(void)
         }
     }
 
+    /* Schedule held back updates and heartbeats that are due. */
+    CheckSendTimes();
+
     /* Process one NV output variable scheduled, if any. */
     SendVar();
 
@@ -1217,7 +1250,7 @@ void MsgSend(void)
     // table entry and the explicit address is unbound or turnaround.
     // An explicit address can be used to override implicit addressing.
     // Explicit messages cannot use turnaround addressing.
-    if (appSendParamPtr->tag < NUM_ADDR_TBL_ENTRIES &&
+    if (appSendParamPtr->tag < gp->addrTableSize &&
             gp->msgOut.addr.Unassigned.Type == IzotAddressUnassigned) {
         addrIndex = appSendParamPtr->tag;
         ap = AccessAddress(addrIndex);
@@ -1411,7 +1444,7 @@ IzotBits16 AddNV(NVDefinition *dp)
         return (-1); /* Network variable name and address is a must. */
     }
 
-    if (nmp->nvTableSize + dim > NV_TABLE_SIZE) {
+    if (nmp->nvTableSize + dim > gp->nvTableCapacity) {
         /* Not enough space in the NV table */
         OsalPrintLog(ERROR_LOG, LonStatusNoSpaceInNvTable, "No space in the NV table");
         return (-1);
@@ -1554,7 +1587,7 @@ IzotBits16 AddNV(NVDefinition *dp)
     for (i = nmp->nvTableSize; i < nmp->nvTableSize + dim; i++) {
         // nv config table is updated only once for a given NV.
         if (i >= eep->nvInitCount) {
-            IzotDatapointConfig *p = &eep->nvConfigTable[i];
+            IzotDatapointConfig *p = &gp->nvConfigTable[i];
             IZOT_SET_ATTRIBUTE_P(p, IZOT_DATAPOINT_PRIORITY, dp->priority);
             IZOT_SET_ATTRIBUTE_P(p, IZOT_DATAPOINT_DIRECTION, dp->direction);
             IZOT_SET_ATTRIBUTE_P(p, IZOT_DATAPOINT_SELHIGH, selectorVal >> 8);
@@ -1578,9 +1611,9 @@ IzotBits16 AddNV(NVDefinition *dp)
             return (-1);
         }
 
-        nmp->nvFixedTable[i].nvLength = dp->nvLength;
+        gp->nvFixedTable[i].nvLength = dp->nvLength;
         /* For arrays, make sure we compute the address of each item. */
-        nmp->nvFixedTable[i].nvAddress =
+        gp->nvFixedTable[i].nvAddress =
                 (char *)dp->varAddr + (i - nmp->nvTableSize) * dp->nvLength;
 
         if (dp->auth) {
@@ -1723,14 +1756,16 @@ IzotBits16 AddNV(NVDefinition *dp)
     nmp->snvt.length = hton16(sizeNeeded);
 
     nmp->nvTableSize += dim;
+    gp->nvOutBoundValid = FALSE;
+    gp->nvPollCacheValid = FALSE;
 
     for (i = 0; i < dim; i++) {
         if (dp->ibol) {
-            izot_dp_prop[dpPropInitCount].ibolSeq = dp->ibol;
+            gp->dpProp[dpPropInitCount].ibolSeq = dp->ibol;
         }
-        IZOT_SET_ATTRIBUTE(izot_dp_prop[dpPropInitCount], IZOT_DATAPOINT_PERSIST,
+        IZOT_SET_ATTRIBUTE(gp->dpProp[dpPropInitCount], IZOT_DATAPOINT_PERSIST,
                 dp->persist);
-        IZOT_SET_ATTRIBUTE(izot_dp_prop[dpPropInitCount], IZOT_DATAPOINT_CHANGEABLE_TYPE,
+        IZOT_SET_ATTRIBUTE(gp->dpProp[dpPropInitCount], IZOT_DATAPOINT_CHANGEABLE_TYPE,
                 dp->changeable);
         dpPropInitCount++;
     }
@@ -1891,8 +1926,8 @@ void IzotPrepareNetworkData(IzotByte *ndi, IzotUbits16 dpIndex, IzotUbits16 dpLe
         IzotByte *hdi)
 {
     memcpy(ndi, hdi, dpLen);
-    if (izot_dp_prop[dpIndex].ibolSeq) {
-        IzotHdiToNdi(izot_dp_prop[dpIndex].ibolSeq, hdi, ndi, MAX_STOP_OFFSET);
+    if (gp->dpProp[dpIndex].ibolSeq) {
+        IzotHdiToNdi(gp->dpProp[dpIndex].ibolSeq, hdi, ndi, MAX_STOP_OFFSET);
     }
 }
 
@@ -1916,7 +1951,7 @@ void IzotUpdateUnion(IzotByte *data, IzotByte offset, uint16_t len, signed index
     if (index < 0) {
         //TODO IBOL Sequence for properties in files
     } else {
-        ibol = izot_dp_prop[index].ibolSeq;
+        ibol = gp->dpProp[index].ibolSeq;
     }
 
     OsalPrintLog(INFO_LOG, LonStatusNoError, "IzotUpdateUnion: Offset %d, size %d",
@@ -1975,20 +2010,21 @@ static void ProcessNV(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
  *   all. Note that it is not meaningful to have a primary and an alias of that
  *   primary to have the same selector. If the incoming variable is connected to two
  *   different primary variables on this node, then the incoming variable should not have
- *   been polled.
+ *   been polled. The lookup and the value sent are remembered by
+ *   FindPolledNV() and GetPolledValue() for repeated polls.
  *   Reference: The Technology Device Data Book Rev 3. Page 9-54
  */
 static void ProcessNVPoll(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 {
-    IzotBits16 i;
     IzotByte nvDirection;
-    IzotUbits16 selector, thisSelector;
+    IzotUbits16 selector;
     IzotBits16 matchingIndex;
     IzotUbits16 matchingPrimaryIndex;
     Queue *tsaOutQPtr;
     TSASendParam *tsaSendParamPtr;
     APDU *apduRespPtr;
-    IzotDatapointConfig *thisNVStrPtr, *matchingNVStrPtr;
+    IzotDatapointConfig *matchingNVStrPtr;
+    NVPollCacheEntry *pollEntry = NULL;
     IzotByte authOK;
     IzotByte noData; /* Should data go out? */
 
@@ -2024,29 +2060,14 @@ static void ProcessNVPoll(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
     /* If application is not running, then we should return with no data */
     /* We know that the node is configured at this point */
     if (AppPgmRuns()) {
-        /* Search for matching network variable. Search both primary
-           and alias entries */
-        for (i = 0; i < nmp->nvTableSize + NV_ALIAS_TABLE_SIZE; i++) {
-            thisNVStrPtr = GetNVStructPtr(i);
-            thisSelector =
-                    (IZOT_GET_ATTRIBUTE_P(thisNVStrPtr, IZOT_DATAPOINT_SELHIGH) << 8) |
-                    thisNVStrPtr->SelectorLow;
-
-            if (IZOT_GET_ATTRIBUTE_P(thisNVStrPtr, IZOT_DATAPOINT_DIRECTION) ==
-                            nvDirection &&
-                    thisSelector == selector) {
-                if (matchingIndex == -1) {
-                    matchingIndex = i; /* First match. */
-                } else if (GetPrimaryIndex(matchingIndex) == GetPrimaryIndex(i)) {
-                    /* We have two distinct primary variables with same
-                       selector. Ignore this message. */
-                    SendNullResponse(appReceiveParamPtr->reqId);
-                    QueueDropHead(&gp->appInQ);
-                    return;
-                }
-            } else {
-                continue; /* Skip this entry. Does not match. */
-            }
+        pollEntry = FindPolledNV(selector, nvDirection);
+        matchingIndex = pollEntry->matchingIndex;
+        if (matchingIndex == NV_POLL_AMBIGUOUS) {
+            /* We have two distinct primary variables with same
+               selector. Ignore this message. */
+            SendNullResponse(appReceiveParamPtr->reqId);
+            QueueDropHead(&gp->appInQ);
+            return;
         }
     }
 
@@ -2086,14 +2107,7 @@ static void ProcessNVPoll(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
         /* Send a response with data */
         if (NV_LENGTH(matchingPrimaryIndex) + 2 <= gp->tsaRespBufSize) {
             uint16_t len = NV_LENGTH(matchingPrimaryIndex);
-            IzotByte ndi[len];
-            memcpy(ndi, NV_ADDRESS(matchingPrimaryIndex), len);
-            if (izot_dp_prop[matchingPrimaryIndex].ibolSeq) {
-                IzotHdiToNdi(izot_dp_prop[matchingPrimaryIndex].ibolSeq,
-                        NV_ADDRESS(matchingPrimaryIndex), ndi, MAX_STOP_OFFSET);
-            }
-
-            memcpy(&apduRespPtr->data[1], ndi, len);
+            GetPolledValue(pollEntry, matchingPrimaryIndex, &apduRespPtr->data[1], len);
             tsaSendParamPtr->apduSize = 2 + len;
         } else {
             tsaSendParamPtr->apduSize = 2;
@@ -2106,6 +2120,99 @@ static void ProcessNVPoll(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
     return;
 }
 
+/*
+ * Finds the network variable addressed by a poll message.
+ * Parameters:
+ *   selector: Selector from the poll message
+ *   nvDirection: Direction from the poll message
+ * Returns:
+ *   Pointer to the poll cache entry holding the result of the lookup
+ * Notes:
+ *   Searches both primary and alias entries, as described for
+ *   ProcessNVPoll(), unless the result for this selector and direction is
+ *   already in gp->nvPollCache. The cache is direct mapped; a new lookup
+ *   replaces the entry it maps to. All entries are discarded after a
+ *   configuration change or a new network variable.
+ */
+static NVPollCacheEntry *FindPolledNV(IzotUbits16 selector, IzotByte nvDirection)
+{
+    NVPollCacheEntry *entry;
+    IzotDatapointConfig *thisNVStrPtr;
+    IzotUbits16 thisSelector;
+    IzotBits16 matchingIndex = -1;
+    IzotBits16 i;
+
+    if (!gp->nvPollCacheValid) {
+        memset(gp->nvPollCache, 0, sizeof(gp->nvPollCache));
+        gp->nvPollCacheValid = TRUE;
+    }
+    entry = &gp->nvPollCache[(selector ^ nvDirection) % NV_POLL_CACHE_SIZE];
+    if (entry->valid && entry->selector == selector && entry->direction == nvDirection) {
+        return entry;
+    }
+
+    for (i = 0; i < nmp->nvTableSize + gp->nvAliasTableSize; i++) {
+        thisNVStrPtr = GetNVStructPtr(i);
+        thisSelector = (IZOT_GET_ATTRIBUTE_P(thisNVStrPtr, IZOT_DATAPOINT_SELHIGH) << 8) |
+                       thisNVStrPtr->SelectorLow;
+
+        if (IZOT_GET_ATTRIBUTE_P(thisNVStrPtr, IZOT_DATAPOINT_DIRECTION) != nvDirection ||
+                thisSelector != selector) {
+            continue; /* Skip this entry. Does not match. */
+        }
+        if (matchingIndex == -1) {
+            matchingIndex = i; /* First match. */
+        } else if (GetPrimaryIndex(matchingIndex) == GetPrimaryIndex(i)) {
+            matchingIndex = NV_POLL_AMBIGUOUS;
+            break;
+        }
+    }
+
+    entry->valid = TRUE;
+    entry->selector = selector;
+    entry->direction = nvDirection;
+    entry->matchingIndex = matchingIndex;
+    entry->valueLength = 0;
+    return entry;
+}
+
+/*
+ * Copies the value of a polled network variable in network format.
+ * Parameters:
+ *   entry: Poll cache entry returned by FindPolledNV()
+ *   primaryIndex: The primary index of the polled network variable
+ *   ndi: Receives the value in network format
+ *   len: Current length of the network variable
+ * Returns:
+ *   None
+ * Notes:
+ *   A variable with an IBOL sequence is converted from host format only if
+ *   its value differs from the one converted for the previous poll. The
+ *   application may change the value without calling the stack, so the
+ *   value itself, not a write counter, decides whether the entry is used.
+ */
+static void GetPolledValue(NVPollCacheEntry *entry, IzotUbits16 primaryIndex,
+        IzotByte *ndi, IzotUbits16 len)
+{
+    const IzotByte *ibolSeq = gp->dpProp[primaryIndex].ibolSeq;
+
+    memcpy(ndi, NV_ADDRESS(primaryIndex), len);
+    if (ibolSeq == NULL) {
+        return;
+    }
+    if (len > MAX_NV_LENGTH) {
+        IzotHdiToNdi(ibolSeq, NV_ADDRESS(primaryIndex), ndi, MAX_STOP_OFFSET);
+        return;
+    }
+    if (entry->valueLength != len || memcmp(entry->hostValue, ndi, len) != 0) {
+        memcpy(entry->hostValue, ndi, len);
+        memcpy(entry->netValue, ndi, len);
+        IzotHdiToNdi(ibolSeq, entry->hostValue, entry->netValue, MAX_STOP_OFFSET);
+        entry->valueLength = len;
+    }
+    memcpy(ndi, entry->netValue, len);
+}
+
 /*
  * Processes an incoming network variable (NV) update message.
  * Parameters:
@@ -2172,7 +2279,7 @@ static void ProcessNVUpdate(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
     /* Go through network input variables looking for a match. Once
        a match is found, update it and break. */
     matchingIndex = -1;
-    for (i = 0; i < nmp->nvTableSize + NV_ALIAS_TABLE_SIZE; i++) {
+    for (i = 0; i < nmp->nvTableSize + gp->nvAliasTableSize; i++) {
         thisNVStrPtr = GetNVStructPtr(i);
         thisSelector = (IZOT_GET_ATTRIBUTE_P(thisNVStrPtr, IZOT_DATAPOINT_SELHIGH) << 8) |
                        thisNVStrPtr->SelectorLow;
@@ -2226,11 +2333,11 @@ static void ProcessNVUpdate(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
             gp->nvInDataStatus = LonStatusNoError;
         }
 
-        if (izot_dp_prop[matchingPrimaryIndex].ibolSeq) {
+        if (gp->dpProp[matchingPrimaryIndex].ibolSeq) {
             IzotByte arg1 = 0;
             IzotByte arg2 = 0;
             int byte_index = 0;
-            const IzotByte *ibol_seq = izot_dp_prop[matchingPrimaryIndex].ibolSeq;
+            const IzotByte *ibol_seq = gp->dpProp[matchingPrimaryIndex].ibolSeq;
 
             IzotNdiToHdi(&apduPtr->data[1], hdi, ibol_seq);
             dplength = 0;  //Back to zero , updating as per original structured size
@@ -2286,7 +2393,7 @@ static void ProcessNVUpdate(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
             gp->nvArrayIndex = matchingPrimaryIndex - thisBaseIndex;
             IzotDatapointUpdateOccurred(thisBaseIndex, &(gp->nvInAddr));
 
-            if (IZOT_GET_ATTRIBUTE(izot_dp_prop[thisBaseIndex], IZOT_DATAPOINT_PERSIST)) {
+            if (IZOT_GET_ATTRIBUTE(gp->dpProp[thisBaseIndex], IZOT_DATAPOINT_PERSIST)) {
                 LCS_WritePersistentAppData();
             }
         }
@@ -2360,66 +2467,307 @@ static LonStatusCode PropagateThisIndex(IzotBits16 nvIndexIn, IzotBits16 primary
  * Parameters:
  *   nvIndexIn: The primary index of the network variable
  * Returns:
- *   None
+ *   The status passed with the completion event generated here, or
+ *   LonStatusNoError if the variable was scheduled
  * Notes:
- *   If the variable is bound then this schedules the primary and any alias
- *   entries for this primary using PropagateThisIndex. If nothing was scheduled
- *   then generate failure completion event. else generate success completion event.
- *   After scheduling the primary and all related alias entries, this function adds
- *   -1 to the queue to indicate end.
+ *   If the variable is a bound output then this schedules it with
+ *   PropagateBoundOutput. A bound variable that is not an output cannot be
+ *   scheduled and gets a failure completion event; an unbound variable gets
+ *   a success completion event.
  */
-void PropagateThisPrimary(IzotBits16 nvIndexIn)
+static LonStatusCode PropagateThisPrimary(IzotBits16 nvIndexIn)
+{
+    IzotUbits16 dim;
+    IzotBits16 baseIndex;
+    IzotBits16 position;
+    LonStatusCode status;
+
+    position = FindBoundOutput(nvIndexIn);
+    if (position >= 0) {
+        return PropagateBoundOutput((IzotUbits16)position);
+    }
+    IsArrayNV(nvIndexIn, &dim, &baseIndex);
+    gp->nvArrayIndex = nvIndexIn - baseIndex;
+    status = IsNVBound(nvIndexIn) ? LonStatusOutputDpPropagateFailure : LonStatusNoError;
+    IzotDatapointUpdateCompleted(baseIndex, status);
+    return status;
+}
+
+/*
+ * Schedules a bound output network variable for propagation.
+ * Parameters:
+ *   position: Position of the variable in gp->nvOutBound
+ * Returns:
+ *   LonStatusNoError if anything was scheduled (or coalesced), otherwise
+ *   LonStatusOutputDpPropagateFailure
+ * Notes:
+ *   This schedules the primary and the alias entries for this primary using
+ *   PropagateThisIndex. If nothing was scheduled then generate failure
+ *   completion event. After scheduling the primary and all related alias
+ *   entries, this function adds -1 to the queue to indicate end. With
+ *   NV_OUT_COALESCING, nothing is scheduled for a variable whose previous
+ *   update has not started yet; that update sends the current value. An
+ *   update within the minimum send time of the variable is held back until
+ *   CheckSendTimes() sends it.
+ */
+static LonStatusCode PropagateBoundOutput(IzotUbits16 position)
 {
     IzotBits16 *indexPtr;
     Queue *indexQPtr;
     IzotUbits16 count, dim;
     IzotBits16 baseIndex;
-    IzotBits16 j;
+    IzotBits16 nvIndex;
+    IzotUbits16 j;
     IzotUbits16 queueSpace;
+    NVSendTime *sendTime;
 
+    nvIndex = gp->nvOutBound[position];
     indexQPtr = &gp->nvOutIndexQ;
 
-    queueSpace = QueueCapacity(indexQPtr) - QueueEntries(indexQPtr);
+    sendTime = FindSendTime(nvIndex);
+    if (sendTime != NULL && LonTimerRunning(&sendTime->minTimer)) {
+        sendTime->pending = TRUE;
+        return LonStatusNoError;  // Sent when the minimum send time expires
+    }
 
-    /* Schedule primary network output variables for NVUpdate. */
-    if (IsNVBound(nvIndexIn)) {
-        /* We need space for at least 2 entries to schedule.
-           i.e we need to reserve one space for -1 at the end. */
-        count = 0;
-        if (queueSpace > 1 &&
-                PropagateThisIndex(nvIndexIn, nvIndexIn) == LonStatusNoError) {
+#if NV_OUT_COALESCING
+    if (!NV_SYNC(nvIndex) && NV_OUT_PENDING(nvIndex)) {
+        if (sendTime != NULL) {
+            sendTime->pending = FALSE;
+            SetLonTimer(&sendTime->maxTimer, sendTime->maxSendTime);
+        }
+        return LonStatusNoError;  // Coalesced with the update already scheduled
+    }
+#endif  // NV_OUT_COALESCING
+
+    queueSpace = NvOutIndexQSpace();
+
+    /* We need space for at least 2 entries to schedule.
+       i.e we need to reserve one space for -1 at the end. */
+    count = 0;
+    if (queueSpace > 1 && PropagateThisIndex(nvIndex, nvIndex) == LonStatusNoError) {
+        count++;
+        queueSpace--;
+    }
+    /* Schedule all alias entries that map to this primary entry.
+       If queue does not have much space, stop scheduling rest. */
+    for (j = gp->nvOutBoundAliasStart[position];
+            j < gp->nvOutBoundAliasStart[position + 1] && queueSpace > 1; j++) {
+        if (PropagateThisIndex(gp->nvOutBoundAlias[j], nvIndex) == LonStatusNoError) {
             count++;
             queueSpace--;
         }
-        /* Schedule all alias entries that map to this primary entry.
-           If queue does not have much space, stop scheduling rest. */
+    }
+    if (count == 0) {
+        IsArrayNV(nvIndex, &dim, &baseIndex);
+        gp->nvArrayIndex = nvIndex - baseIndex;
+        IzotDatapointUpdateCompleted(baseIndex, LonStatusOutputDpPropagateFailure);
+        return LonStatusOutputDpPropagateFailure;
+    }
+    /* Schedule a -1 to indicate end of indices for this primary. */
+    /* There should be at least one space left in queue */
+    indexPtr = QueueTail(indexQPtr);
+    *indexPtr = -1;
+    QueueWrite(indexQPtr);
+#if NV_OUT_COALESCING
+    SET_NV_OUT_PENDING(nvIndex);
+#endif  // NV_OUT_COALESCING
+    if (sendTime != NULL) {
+        sendTime->pending = FALSE;
+        SetLonTimer(&sendTime->minTimer, sendTime->minSendTime);
+        SetLonTimer(&sendTime->maxTimer, sendTime->maxSendTime);
+    }
+    return LonStatusNoError;
+}
 
-        for (j = nmp->nvTableSize;
-                j < nmp->nvTableSize + NV_ALIAS_TABLE_SIZE && queueSpace > 1; j++) {
-            if (GetPrimaryIndex(j) != nvIndexIn) {
+/*
+ * Counts the nvOutIndexQ entries that PropagateBoundOutput needs.
+ * Parameters:
+ *   position: Position of the variable in gp->nvOutBound
+ * Returns:
+ *   Number of entries for the primary, its aliases and the -1 end marker,
+ *   or 0 if the update is coalesced with one already scheduled
+ */
+static IzotUbits16 BoundOutputEntries(IzotUbits16 position)
+{
+#if NV_OUT_COALESCING
+    IzotBits16 nvIndex = gp->nvOutBound[position];
+
+    if (!NV_SYNC(nvIndex) && NV_OUT_PENDING(nvIndex)) {
+        return 0;
+    }
+#endif  // NV_OUT_COALESCING
+    return gp->nvOutBoundAliasStart[position + 1] - gp->nvOutBoundAliasStart[position] + 2;
+}
+
+/*
+ * Returns the number of free entries in gp->nvOutIndexQ.
+ */
+static IzotUbits16 NvOutIndexQSpace(void)
+{
+    return QueueCapacity(&gp->nvOutIndexQ) - QueueEntries(&gp->nvOutIndexQ);
+}
+
+/*
+ * Returns the send time limits of a primary network variable, or NULL if
+ * it has none.
+ */
+static NVSendTime *FindSendTime(IzotBits16 nvIndex)
+{
+    IzotByte slot = gp->nvSendTimeSlot[nvIndex];
+
+    if (slot < gp->nvSendTimeCount && gp->nvSendTime[slot].nvIndex == nvIndex) {
+        return &gp->nvSendTime[slot];
+    }
+    return NULL;
+}
+
+/*
+ * Sends held back updates and heartbeats of output network variables.
+ * Parameters:
+ *   None
+ * Returns:
+ *   None
+ * Notes:
+ *   Called by AppLayerSend(). An update held back by the minimum send time
+ *   is scheduled once that time has passed, and the current value is sent
+ *   again when the maximum send time has passed without an update. Both
+ *   wait while the queue lacks space for all entries of the variable
+ *   rather than failing. A variable that is not bound sends nothing; its
+ *   heartbeat timer is only restarted.
+ */
+static void CheckSendTimes(void)
+{
+    NVSendTime *sendTime;
+    IzotBits16 position;
+    IzotUbits16 i;
+
+    for (i = 0; i < gp->nvSendTimeCount; i++) {
+        sendTime = &gp->nvSendTime[i];
+        if (LonTimerRunning(&sendTime->minTimer) ||
+                (!sendTime->pending &&
+                        (sendTime->maxSendTime == 0 ||
+                                LonTimerRunning(&sendTime->maxTimer)))) {
+            continue;
+        }
+        position = FindBoundOutput(sendTime->nvIndex);
+        if (position < 0) {
+            sendTime->pending = FALSE;
+            SetLonTimer(&sendTime->maxTimer, sendTime->maxSendTime);
+        } else if (BoundOutputEntries((IzotUbits16)position) <= NvOutIndexQSpace()) {
+            PropagateBoundOutput((IzotUbits16)position);
+        }
+    }
+}
+
+/*
+ * Rebuilds the list of bound output network variables if needed.
+ * Parameters:
+ *   None
+ * Returns:
+ *   None
+ * Notes:
+ *   A primary output variable is listed if its own address table entry or
+ *   that of any of its aliases is bound (see IsNVBound()). All aliases of a
+ *   listed primary are recorded with it, bound or not, because
+ *   PropagateThisIndex decides for each alias whether it is sent. The list
+ *   is rebuilt only after gp->nvOutBoundValid has been cleared by a
+ *   configuration change, a reset, or a new network variable.
+ */
+static void RefreshBoundOutputs(void)
+{
+    IzotBits16 primary;
+    IzotBits16 aliasIndex;
+    IzotUbits16 i;
+    IzotUbits16 aliasCount;
+    IzotByte bound;
+
+    if (gp->nvOutBoundValid) {
+        return;
+    }
+
+    gp->nvOutBoundCount = 0;
+    gp->nvOutBoundAliasStart[0] = 0;
+    for (primary = 0; primary < nmp->nvTableSize; primary++) {
+        if (IZOT_GET_ATTRIBUTE(gp->nvConfigTable[primary], IZOT_DATAPOINT_DIRECTION) !=
+                IzotDatapointDirectionIsOutput) {
+            continue;
+        }
+        bound = IsAddrIndexBound(ADDR_INDEX(
+                IZOT_GET_ATTRIBUTE(gp->nvConfigTable[primary], IZOT_DATAPOINT_ADDRESS_HIGH),
+                IZOT_GET_ATTRIBUTE(gp->nvConfigTable[primary], IZOT_DATAPOINT_ADDRESS_LOW)));
+
+        /* Aliases are appended after those of the previous listed primary;
+           they are dropped again if this primary turns out to be unbound. */
+        aliasCount = gp->nvOutBoundAliasStart[gp->nvOutBoundCount];
+        for (i = 0; i < gp->nvAliasTableSize; i++) {
+            aliasIndex = (IzotBits16)(i + nmp->nvTableSize);
+            if (GetPrimaryIndex(aliasIndex) != primary) {
                 continue;
             }
-            if (PropagateThisIndex(j, nvIndexIn) == LonStatusNoError) {
-                count++;
-                queueSpace--;
+            gp->nvOutBoundAlias[aliasCount++] = aliasIndex;
+            if (!bound) {
+                bound = IsAddrIndexBound(ADDR_INDEX(
+                        IZOT_GET_ATTRIBUTE(gp->nvAliasTable[i].Alias,
+                                IZOT_DATAPOINT_ADDRESS_HIGH),
+                        IZOT_GET_ATTRIBUTE(gp->nvAliasTable[i].Alias,
+                                IZOT_DATAPOINT_ADDRESS_LOW)));
             }
         }
-        if (count == 0) {
-            IsArrayNV(nvIndexIn, &dim, &baseIndex);
-            gp->nvArrayIndex = nvIndexIn - baseIndex;
-            IzotDatapointUpdateCompleted(baseIndex, LonStatusOutputDpPropagateFailure);
+        if (bound) {
+            gp->nvOutBound[gp->nvOutBoundCount++] = primary;
+            gp->nvOutBoundAliasStart[gp->nvOutBoundCount] = aliasCount;
+        }
+    }
+    gp->nvOutBoundValid = TRUE;
+}
+
+/*
+ * Finds a primary network variable in the list of bound outputs.
+ * Parameters:
+ *   nvIndexIn: The primary index of the network variable
+ * Returns:
+ *   The position of the variable in gp->nvOutBound, or -1 if it is not a
+ *   bound output
+ * Notes:
+ *   Rebuilds the list first if a configuration change invalidated it.
+ */
+static IzotBits16 FindBoundOutput(IzotBits16 nvIndexIn)
+{
+    IzotBits16 low = 0;
+    IzotBits16 high;
+    IzotBits16 middle;
+
+    RefreshBoundOutputs();
+    high = (IzotBits16)gp->nvOutBoundCount - 1;
+    while (low <= high) {
+        middle = (low + high) / 2;
+        if (gp->nvOutBound[middle] == nvIndexIn) {
+            return middle;
+        }
+        if (gp->nvOutBound[middle] < nvIndexIn) {
+            low = middle + 1;
         } else {
-            /* Schedule a -1 to indicate end of indices for this primary. */
-            /* There should be at least one space left in queue */
-            indexPtr = QueueTail(indexQPtr);
-            *indexPtr = -1;
-            QueueWrite(indexQPtr);
+            high = middle - 1;
         }
-    } else {
-        IsArrayNV(nvIndexIn, &dim, &baseIndex);
-        gp->nvArrayIndex = nvIndexIn - baseIndex;
-        IzotDatapointUpdateCompleted(baseIndex, LonStatusNoError);
     }
+    return -1;
+}
+
+/*
+ * Determines whether an address table index refers to a bound entry.
+ * Parameters:
+ *   addrIndex: Address table index from a network variable or alias entry
+ * Returns:
+ *   TRUE if the index is valid and the entry is assigned or a turnaround entry
+ * Notes:
+ *   Same test as used by IsNVBound().
+ */
+static IzotByte IsAddrIndexBound(IzotByte addrIndex)
+{
+    return addrIndex < gp->addrTableSize &&
+           (gp->addrTable[addrIndex].SubnetNode.Type != IzotAddressUnassigned ||
+                   gp->addrTable[addrIndex].Turnaround.Turnaround == 1);
 }
 
 /*
@@ -2441,15 +2789,18 @@ void PropagateThisPrimary(IzotBits16 nvIndexIn)
  *   know how to generate the destination address. It is possible that not all
  *   variables can be scheduled due to space limitation in the queues. For guranteed
  *   scheduling of all possible network ouput variables, the nv output queue
- *   should be large enough.
+ *   should be large enough. Only the variables in the bound output list
+ *   (see RefreshBoundOutputs) are visited, so unbound variables and inputs
+ *   get no completion event.
  */
 void Propagate(void)
 {
-    IzotBits16 i;
+    IzotUbits16 i;
 
-    /* Schedule primary network output variables. */
-    for (i = 0; i < nmp->nvTableSize; i++) {
-        PropagateThisPrimary(i);
+    /* Schedule bound primary network output variables. */
+    RefreshBoundOutputs();
+    for (i = 0; i < gp->nvOutBoundCount; i++) {
+        PropagateBoundOutput(i);
     }
 }
 
@@ -2548,6 +2899,193 @@ void PropagateArrayNV(IzotBits16 arrayNVIndexIn, IzotBits16 indexIn)
     PropagateThisPrimary(nvIndex);
 }
 
+/*
+ * Propagates a list of output network variables in one pass.
+ * Parameters:
+ *   nvIndices: Indices of the network variables to propagate
+ *   count: Number of entries in nvIndices
+ *   results: Receives the status for each entry of nvIndices; may be NULL
+ * Returns:
+ *   LonStatusNoError if every variable was scheduled or needed no update,
+ *   otherwise the status of the first one that failed
+ * Notes:
+ *   Each index is handled like PropagateNV(), so the first index of an
+ *   array propagates the whole array. The bound output list is refreshed
+ *   once for the batch, and the queue space for all primaries and aliases
+ *   of an index is checked before any of them is scheduled. An index that
+ *   does not fit is not scheduled at all and gets LonStatusNoBufferAvailable
+ *   without a completion event, so the caller can propagate it again later;
+ *   the following indices are still tried. An index that is not a valid
+ *   primary index gets LonStatusIndexInvalid. Otherwise the result is the
+ *   status of the completion event, as for PropagateNV().
+ */
+LonStatusCode PropagateBatch(const int nvIndices[], unsigned count,
+        LonStatusCode results[])
+{
+    LonStatusCode batchStatus = LonStatusNoError;
+    LonStatusCode status;
+    IzotUbits16 dim;
+    IzotBits16 baseIndex;
+    IzotBits16 nvIndex;
+    IzotBits16 position;
+    IzotUbits16 needed;
+    unsigned i;
+    IzotBits16 j;
+
+    RefreshBoundOutputs();
+    for (i = 0; i < count; i++) {
+        if (nvIndices[i] < 0 || nvIndices[i] >= nmp->nvTableSize) {
+            status = LonStatusIndexInvalid;
+        } else {
+            nvIndex = (IzotBits16)nvIndices[i];
+            IsArrayNV(nvIndex, &dim, &baseIndex);
+            if (nvIndex != baseIndex) {
+                dim = 1; /* nvIndex is not the first item of array */
+            }
+            needed = 0;
+            for (j = nvIndex; j < nvIndex + dim; j++) {
+                position = FindBoundOutput(j);
+                if (position >= 0) {
+                    needed += BoundOutputEntries((IzotUbits16)position);
+                }
+            }
+            if (needed > NvOutIndexQSpace()) {
+                status = LonStatusNoBufferAvailable;
+            } else {
+                status = LonStatusNoError;
+                for (j = nvIndex; j < nvIndex + dim; j++) {
+                    if (PropagateThisPrimary(j) != LonStatusNoError) {
+                        status = LonStatusOutputDpPropagateFailure;
+                    }
+                }
+            }
+        }
+        if (results != NULL) {
+            results[i] = status;
+        }
+        if (status != LonStatusNoError && batchStatus == LonStatusNoError) {
+            batchStatus = status;
+        }
+    }
+    return batchStatus;
+}
+
+/*
+ * Propagates the output network variables marked in a dirty bitmap.
+ * Parameters:
+ *   dirtyMap: One bit per primary network variable index; bit (i % 8) of
+ *             byte (i / 8) marks index i
+ *   mapSize: Number of bytes in dirtyMap
+ * Returns:
+ *   LonStatusNoError if every marked variable was handled, or
+ *   LonStatusNoBufferAvailable if the queue filled up first
+ * Notes:
+ *   Only the bound output list is visited, as in Propagate(), and a marked
+ *   variable is scheduled only if all its entries fit in the queue. The
+ *   bit of each scheduled variable is cleared. When the queue fills up the
+ *   bits of the variables not yet scheduled stay set for the next call;
+ *   otherwise the whole map is cleared, including the bits of unbound
+ *   variables, which like Propagate() get no completion event.
+ */
+LonStatusCode PropagateDirty(IzotByte dirtyMap[], unsigned mapSize)
+{
+    IzotUbits16 i;
+    IzotBits16 nvIndex;
+
+    RefreshBoundOutputs();
+    for (i = 0; i < gp->nvOutBoundCount; i++) {
+        nvIndex = gp->nvOutBound[i];
+        if ((unsigned)nvIndex / 8 >= mapSize) {
+            break; /* gp->nvOutBound is sorted */
+        }
+        if (!(dirtyMap[nvIndex / 8] & (1 << (nvIndex % 8)))) {
+            continue;
+        }
+        if (BoundOutputEntries(i) > NvOutIndexQSpace()) {
+            return LonStatusNoBufferAvailable;
+        }
+        PropagateBoundOutput(i);
+        dirtyMap[nvIndex / 8] &= ~(1 << (nvIndex % 8));
+    }
+    memset(dirtyMap, 0, mapSize);
+    return LonStatusNoError;
+}
+
+/*
+ * Sets the minimum and maximum send times of an output network variable.
+ * Parameters:
+ *   nvIndexIn: The primary index of the network variable
+ *   minSendTime: Minimum time between updates in milliseconds; 0 for none
+ *   maxSendTime: Maximum time between updates in milliseconds; 0 for none
+ * Returns:
+ *   LonStatusNoError on success, LonStatusIndexInvalid if nvIndexIn is not
+ *   an output network variable, LonStatusInvalidParameter if minSendTime is
+ *   greater than a non-zero maxSendTime, or LonStatusNoBufferAvailable if
+ *   NV_SEND_TIME_COUNT variables already have send times
+ * Notes:
+ *   If nvIndexIn is the first item of an array, the limits apply to each
+ *   item, as for PropagateNV(). Setting both times to 0 removes the limits.
+ *   The heartbeat timer starts now, so the first heartbeat is due
+ *   maxSendTime after this call unless the variable is propagated earlier.
+ */
+LonStatusCode SetNVSendTimes(IzotBits16 nvIndexIn, uint32_t minSendTime,
+        uint32_t maxSendTime)
+{
+    NVSendTime *sendTime;
+    IzotUbits16 dim;
+    IzotBits16 baseIndex;
+    IzotBits16 i;
+    IzotUbits16 needed = 0;
+
+    if (nvIndexIn < 0 || nvIndexIn >= nmp->nvTableSize ||
+            IZOT_GET_ATTRIBUTE(gp->nvConfigTable[nvIndexIn], IZOT_DATAPOINT_DIRECTION) !=
+                    IzotDatapointDirectionIsOutput) {
+        return LonStatusIndexInvalid;
+    }
+    if (maxSendTime != 0 && minSendTime > maxSendTime) {
+        return LonStatusInvalidParameter;
+    }
+    IsArrayNV(nvIndexIn, &dim, &baseIndex);
+    if (nvIndexIn != baseIndex) {
+        dim = 1; /* nvIndexIn is not the first item of array */
+    }
+    for (i = nvIndexIn; i < nvIndexIn + dim; i++) {
+        if (FindSendTime(i) == NULL) {
+            needed++;
+        }
+    }
+    if ((minSendTime != 0 || maxSendTime != 0) &&
+            gp->nvSendTimeCount + needed > NV_SEND_TIME_COUNT) {
+        return LonStatusNoBufferAvailable;
+    }
+
+    for (i = nvIndexIn; i < nvIndexIn + dim; i++) {
+        sendTime = FindSendTime(i);
+        if (minSendTime == 0 && maxSendTime == 0) {
+            if (sendTime != NULL) {
+                /* Move the last entry into the freed one */
+                *sendTime = gp->nvSendTime[--gp->nvSendTimeCount];
+                gp->nvSendTimeSlot[sendTime->nvIndex] =
+                        (IzotByte)(sendTime - gp->nvSendTime);
+            }
+            continue;
+        }
+        if (sendTime == NULL) {
+            gp->nvSendTimeSlot[i] = (IzotByte)gp->nvSendTimeCount;
+            sendTime = &gp->nvSendTime[gp->nvSendTimeCount++];
+            sendTime->nvIndex = i;
+            sendTime->pending = FALSE;
+        }
+        sendTime->minSendTime = minSendTime;
+        sendTime->maxSendTime = maxSendTime;
+        if (minSendTime == 0) {
+            SetLonTimer(&sendTime->minTimer, 0);
+        }
+        SetLonTimer(&sendTime->maxTimer, maxSendTime);
+    }
+    return LonStatusNoError;
+}
+
 /*
  * Generates NV Update message for the given index.
  * Parameters:
@@ -2646,8 +3184,8 @@ static void SendVar()
          * as input buffer inavailability.  Network management tools are expected
          * to assign an address table entry even if using unackd service. */
         /* *** END INFORMATIVE - Unbound Network Variable */
-        turnAroundOnly = addrIndex == 0xFF || eep->addrTable[addrIndex].SubnetNode.Type ==
-                                                      IzotAddressUnassigned;
+        turnAroundOnly = addrIndex >= gp->addrTableSize ||
+                         gp->addrTable[addrIndex].SubnetNode.Type == IzotAddressUnassigned;
 
         if (IZOT_GET_ATTRIBUTE_P(nvStrPtr, IZOT_DATAPOINT_PRIORITY)) {
             ctrl = PKT_PRIORITY;
@@ -2685,7 +3223,7 @@ static void SendVar()
             }
         } else if (IZOT_GET_ATTRIBUTE_P(nvStrPtr, IZOT_DATAPOINT_SERVICE) ==
                            IzotServiceUnacknowledged &&
-                   QueueFull(nwOutQPtr)) {
+                   !NWOutQAvailable(nwOutQPtr, NW_TX_NEW)) {
             return;
         } else if (IZOT_GET_ATTRIBUTE_P(nvStrPtr, IZOT_DATAPOINT_SERVICE) !=
                            IzotServiceUnacknowledged &&
@@ -2716,7 +3254,7 @@ static void SendVar()
        we update that input variable, and then send NVUpdateOccurs event
        to the application program. We break as soon as first match is found. */
     if (IZOT_GET_ATTRIBUTE_P(nvStrPtr, IZOT_DATAPOINT_TURNAROUND)) {
-        for (i = 0; i < nmp->nvTableSize + NV_ALIAS_TABLE_SIZE; i++) {
+        for (i = 0; i < nmp->nvTableSize + gp->nvAliasTableSize; i++) {
             nvStrPtrIn = GetNVStructPtr(i);
             selectorIn = (IZOT_GET_ATTRIBUTE_P(nvStrPtrIn, IZOT_DATAPOINT_SELHIGH) << 8) |
                          nvStrPtrIn->SelectorLow;
@@ -2763,11 +3301,18 @@ static void SendVar()
            be initialized when HandleMsgCompletion gets NV_UPDATE_LAST_TAG_VALUE.
            Explicit initialization here will fix the problem. */
         gp->nvOutIndex = GetPrimaryIndex(nvIndex);
+#if NV_OUT_COALESCING
+        CLEAR_NV_OUT_PENDING(primaryIndex);
+#endif  // NV_OUT_COALESCING
         QueueDropHead(indexQPtr);
         return;
     }
 
     gp->nvOutCanSchedule = FALSE; /* Only one index at a time */
+#if NV_OUT_COALESCING
+    /* The update has started; a change from now on needs a new update. */
+    CLEAR_NV_OUT_PENDING(primaryIndex);
+#endif  // NV_OUT_COALESCING
     QueueDropHead(indexQPtr);
 
     /* Build and send network variable update message. */
@@ -2894,7 +3439,7 @@ void PollThisPrimary(IzotBits16 nvIndexIn)
         /* Schedule all alias entries that map to this primary entry.
            If queue does not have much space, stop scheduling rest. */
         for (j = nmp->nvTableSize;
-                j < nmp->nvTableSize + NV_ALIAS_TABLE_SIZE && queueSpace > 1; j++) {
+                j < nmp->nvTableSize + gp->nvAliasTableSize && queueSpace > 1; j++) {
             if (GetPrimaryIndex(j) != nvIndexIn) {
                 continue;
             }
@@ -3143,8 +3688,8 @@ static void PollVar(void)
         /* The variable is turnaround only if addrIndex is 0xF or it is unbound
            (turnaround or not) */
         turnAroundOnly =
-                (addrIndex == 0xFF) ||
-                (eep->addrTable[addrIndex].SubnetNode.Type == IzotAddressUnassigned);
+                (addrIndex >= gp->addrTableSize) ||
+                (gp->addrTable[addrIndex].SubnetNode.Type == IzotAddressUnassigned);
     } else {
         tsaOutQPtr = &gp->tsaOutQ;
     }
@@ -3184,7 +3729,7 @@ static void PollVar(void)
        to the application program. */
     if (IZOT_GET_ATTRIBUTE_P(nvStrPtr, IZOT_DATAPOINT_TURNAROUND)) {
         matchingIndexOut = -1;
-        for (i = 0; i < nmp->nvTableSize + NV_ALIAS_TABLE_SIZE; i++) {
+        for (i = 0; i < nmp->nvTableSize + gp->nvAliasTableSize; i++) {
             nvStrPtrOut = GetNVStructPtr(i);
             /* Skip input network variables */
             if (IZOT_GET_ATTRIBUTE_P(nvStrPtrOut, IZOT_DATAPOINT_DIRECTION) ==
@@ -3295,7 +3840,7 @@ static void PollVar(void)
 MsgTag NewMsgTag(BindNoBind bindStatusIn)
 {
     if (bindStatusIn == BIND) {
-        if (gp->nextBindableMsgTag < NUM_ADDR_TBL_ENTRIES && nmp->snvt.mtagCount < 0xFF) {
+        if (gp->nextBindableMsgTag < gp->addrTableSize && nmp->snvt.mtagCount < 0xFF) {
             nmp->snvt.mtagCount++;
             return (gp->nextBindableMsgTag++);
         } else {
@@ -3408,4 +3953,5 @@ void GoUnconfigured(void)
         IZOT_SET_ATTRIBUTE(eep->domainTable[i], IZOT_DOMAIN_NONCLONE, 0);
         IZOT_SET_ATTRIBUTE(eep->domainTable[i], IZOT_DOMAIN_NODE, 0);
     }
+    gp->nwDomainMatchValid = FALSE;
 }
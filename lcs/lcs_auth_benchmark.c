@@ -0,0 +1,266 @@
+/*
+ * lcs_auth_benchmark.c
+ *
+ * Copyright (c) 2026 EnOcean
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ *
+ * Title:   LON Authentication Micro-benchmark
+ * Purpose: Measures the cost of Encrypt() in lcs_tsa.c for classic and
+ *          OMA authentication and checks its output against the
+ *          byte-at-a-time definition of the algorithm.
+ * Notes:   Each run first compares Encrypt() with the reference
+ *          implementation below for random keys, random numbers, and
+ *          APDUs of every length up to the maximum, then times both
+ *          for a set of APDU sizes.  A mismatch is reported and makes
+ *          the program exit with a non-zero status.
+ *
+ *          Build with -DLON_STACK_BUILD_AUTH_BENCHMARK=ON and run with
+ *          -h for the command line options.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lcs/lcs_tsa.h"
+
+// Default number of messages encrypted per timed size
+#ifndef AUTH_BENCHMARK_DEFAULT_ITERATIONS
+#define AUTH_BENCHMARK_DEFAULT_ITERATIONS 200000
+#endif
+
+// Number of random messages checked for each APDU length
+#define AUTH_BENCHMARK_CHECKS_PER_LENGTH 8
+
+extern void Encrypt(IzotByte randIn[], APDU *apduIn, IzotUbits16 apduSizeIn,
+        IzotByte *pKey, IzotByte encryptValueOut[], IzotByte isOma, OmaAddress *pOmaDest);
+
+/*****************************************************************
+ * Section: Function Definitions
+ *****************************************************************/
+
+/*
+ * Computes an authentication value the way Encrypt() did before the
+ * key was expanded: one key bit test per message byte, with the OMA
+ * destination copied in front of the APDU.
+ * Parameters:
+ *   randIn: 8-byte random number
+ *   apduBytes: APDU bytes starting with the code
+ *   apduSize: number of APDU bytes
+ *   pKey: 6-byte classic key, or 12-byte OMA key
+ *   encryptValueOut: 8-byte result
+ *   isOma: true for OMA authentication
+ *   pOmaDest: OMA destination address; used only for OMA
+ * Returns:
+ *   None
+ */
+static void ReferenceEncrypt(const IzotByte randIn[], const IzotByte *apduBytes,
+        IzotUbits16 apduSize, const IzotByte *pKey, IzotByte encryptValueOut[],
+        IzotByte isOma, const OmaAddress *pOmaDest)
+{
+    IzotByte buffer[MAX_DATA_SIZE + sizeof(OmaAddress)];
+    int keyLength = IZOT_AUTHENTICATION_KEY_LENGTH;
+    int keyIterations = IZOT_AUTHENTICATION_KEY_LENGTH;
+    int i, j, k;
+    IzotByte m, n;
+
+    if (isOma) {
+        memcpy(buffer, pOmaDest, sizeof(OmaAddress));
+        memcpy(&buffer[sizeof(OmaAddress)], apduBytes, apduSize);
+        apduBytes = buffer;
+        apduSize += sizeof(OmaAddress);
+        keyLength = IZOT_OMA_AUTHENTICATION_KEY_LENGTH;
+        keyIterations = IZOT_OMA_AUTHENTICATION_KEY_LENGTH +
+                        IZOT_OMA_AUTHENTICATION_KEY_LENGTH / 2;
+    }
+
+    memcpy(encryptValueOut, randIn, 8);
+
+    while (apduSize > 0) {
+        for (i = 0; i < keyIterations; i++) {
+            for (j = 7; j >= 0; j--) {
+                k = (j + 1) % 8;
+                m = apduSize > 0 ? apduBytes[--apduSize] : 0;
+                n = ~(encryptValueOut[j] + j);
+                if (pKey[i % keyLength] & (1 << (7 - j))) {
+                    encryptValueOut[j] = encryptValueOut[k] + m + ((n << 1) + (n >> 7));
+                } else {
+                    encryptValueOut[j] = encryptValueOut[k] + m - ((n >> 1) + (n << 7));
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Fills a buffer with pseudo-random bytes.
+ * Parameters:
+ *   data: buffer to fill
+ *   length: number of bytes
+ * Returns:
+ *   None
+ */
+static void RandomBytes(void *data, size_t length)
+{
+    IzotByte *bytes = data;
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        bytes[i] = (IzotByte)(rand() >> 7);
+    }
+}
+
+/*
+ * Returns a monotonic time stamp in nanoseconds.
+ */
+static double NowNanoseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1e9 + (double)now.tv_nsec;
+}
+
+/*
+ * Compares Encrypt() with ReferenceEncrypt() for every APDU length.
+ * Parameters:
+ *   isOma: true for OMA authentication
+ * Returns:
+ *   Number of mismatches
+ */
+static int CheckEncrypt(IzotByte isOma)
+{
+    IzotByte apdu[MAX_DATA_SIZE];
+    IzotByte key[IZOT_OMA_AUTHENTICATION_KEY_LENGTH];
+    IzotByte randIn[8];
+    IzotByte expected[8];
+    IzotByte actual[8];
+    OmaAddress omaDest;
+    int mismatches = 0;
+    int length, check;
+
+    for (length = 1; length <= MAX_DATA_SIZE; length++) {
+        for (check = 0; check < AUTH_BENCHMARK_CHECKS_PER_LENGTH; check++) {
+            RandomBytes(apdu, length);
+            RandomBytes(key, sizeof(key));
+            RandomBytes(randIn, sizeof(randIn));
+            RandomBytes(&omaDest, sizeof(omaDest));
+            ReferenceEncrypt(randIn, apdu, length, key, expected, isOma, &omaDest);
+            Encrypt(randIn, (APDU *)apdu, length, key, actual, isOma, &omaDest);
+            if (memcmp(expected, actual, sizeof(actual)) != 0) {
+                if (mismatches++ == 0) {
+                    printf("Mismatch: %s key, %d byte APDU\n",
+                            isOma ? "OMA" : "classic", length);
+                }
+            }
+        }
+    }
+    return mismatches;
+}
+
+/*
+ * Times Encrypt() and ReferenceEncrypt() for one APDU size and key type,
+ * using one key for all messages as a node does between key updates.
+ * Parameters:
+ *   isOma: true for OMA authentication
+ *   apduSize: number of APDU bytes per message
+ *   iterations: number of messages encrypted by each implementation
+ * Returns:
+ *   None
+ */
+static void TimeEncrypt(IzotByte isOma, int apduSize, long iterations)
+{
+    IzotByte apdu[MAX_DATA_SIZE];
+    IzotByte key[IZOT_OMA_AUTHENTICATION_KEY_LENGTH];
+    IzotByte randIn[8];
+    IzotByte result[8];
+    IzotByte sink = 0;
+    OmaAddress omaDest;
+    double start, reference, expanded;
+    long i;
+
+    RandomBytes(apdu, apduSize);
+    RandomBytes(key, sizeof(key));
+    RandomBytes(randIn, sizeof(randIn));
+    RandomBytes(&omaDest, sizeof(omaDest));
+
+    start = NowNanoseconds();
+    for (i = 0; i < iterations; i++) {
+        randIn[0] = (IzotByte)i;
+        ReferenceEncrypt(randIn, apdu, apduSize, key, result, isOma, &omaDest);
+        sink ^= result[0];
+    }
+    reference = (NowNanoseconds() - start) / iterations;
+
+    start = NowNanoseconds();
+    for (i = 0; i < iterations; i++) {
+        randIn[0] = (IzotByte)i;
+        Encrypt(randIn, (APDU *)apdu, apduSize, key, result, isOma, &omaDest);
+        sink ^= result[0];
+    }
+    expanded = (NowNanoseconds() - start) / iterations;
+
+    printf("%-7s %4d bytes: reference %8.1f ns, Encrypt %8.1f ns, %5.2fx (%02X)\n",
+            isOma ? "OMA" : "classic", apduSize, reference, expanded,
+            expanded > 0 ? reference / expanded : 0.0, sink);
+}
+
+static void Usage(const char *program)
+{
+    printf("Usage: %s [options]\n", program);
+    printf("  -n count    Messages encrypted per timed size (default %d)\n",
+            AUTH_BENCHMARK_DEFAULT_ITERATIONS);
+    printf("  -s seed     Random seed (default 1)\n");
+    printf("  -c          Check results only; skip the timing runs\n");
+}
+
+int main(int argc, char *argv[])
+{
+    static const int sizes[] = {2, 8, 32, 64, MAX_DATA_SIZE};
+    long iterations = AUTH_BENCHMARK_DEFAULT_ITERATIONS;
+    unsigned seed = 1;
+    int check_only = 0;
+    int mismatches;
+    int option;
+    size_t i;
+
+    while ((option = getopt(argc, argv, "n:s:ch")) != -1) {
+        switch (option) {
+        case 'n':
+            iterations = strtol(optarg, NULL, 0);
+            break;
+        case 's':
+            seed = (unsigned)strtoul(optarg, NULL, 0);
+            break;
+        case 'c':
+            check_only = 1;
+            break;
+        default:
+            Usage(argv[0]);
+            return option == 'h' ? 0 : 1;
+        }
+    }
+    if (iterations <= 0) {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    srand(seed);
+    mismatches = CheckEncrypt(FALSE) + CheckEncrypt(TRUE);
+    printf("Checked %d APDU lengths per key type: %d mismatches\n", MAX_DATA_SIZE,
+            mismatches);
+    if (mismatches || check_only) {
+        return mismatches ? 1 : 0;
+    }
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        TimeEncrypt(FALSE, sizes[i], iterations);
+    }
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        TimeEncrypt(TRUE, sizes[i], iterations);
+    }
+    return 0;
+}
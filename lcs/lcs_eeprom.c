@@ -41,6 +41,7 @@ EEPROM eeprom[NUM_STACKS];
 void LCS_WritePersistentNetworkImage(void)
 {
     eep->nodeState = IZOT_GET_ATTRIBUTE(eep->readOnlyData, IZOT_READONLY_NODE_STATE);
+    gp->tablesChanged = FALSE;
     IzotPersistentSegSetCommitFlag(IzotPersistentSegNetworkImage);
     IzotPersistentDataHasBeenUpdated();
 }
@@ -12,6 +12,13 @@
 #include "lcs/lcs_iup.h"
 #include <string.h>
 
+#if !IUP_IS(NO_IUP)
+#include "lcs/lcs_netmgmt.h"
+#endif
+#if !IUP_IS(NO_IUP) && OS_IS(LINUX)
+#include "abstraction/IzotHal.h"
+#endif
+
 #define F1(x, y, z) (z ^ (x & (y ^ z)))
 #define F2(x, y, z) F1(z, x, y)
 #define F3(x, y, z) (x ^ y ^ z)
@@ -48,9 +55,25 @@ typedef union {  // overlay two bytes on a 16-bit word
  * Section: IUP Structures
  *****************************************************************/
 
-#if !IUP_IS(NO_IUP)
+#if !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
 struct partition_entry *part = NULL;
 mdev_t *device = NULL;
+#elif !IUP_IS(NO_IUP) && OS_IS(LINUX)
+// The IUP image file holds the IUP persistent data block at IUP_FLASH_OFFSET,
+// followed by the passive partition
+#define IUP_FLASH_OFFSET 0
+#define IUP_IMAGE_FILE_SIZE (EEPROM_BLOCK_SIZE + IUP_IMAGE_PARTITION_SIZE)
+
+struct partition_entry {
+    uint32_t start;
+    uint32_t size;
+};
+
+static struct partition_entry iupPartition = {
+        IUP_FLASH_OFFSET + EEPROM_BLOCK_SIZE, IUP_IMAGE_PARTITION_SIZE};
+struct partition_entry *part = &iupPartition;
+static IzotByte *iupImage;         // Mapped IUP image file
+static uint32_t iupUnsyncedBytes;  // Bytes written since the last sync
 #endif
 
 IzotByte iupImageValidated;
@@ -67,6 +90,15 @@ static uint32_t iupPersistDataLen = sizeof(iupPersistData);
 static IzotUbits16 iupRcvdPckCount;
 static IzotByte validationOnceStarted;
 static IzotByte digestBytes[MD5_DIGEST_LENGTH];
+
+// Received packets; bit (n - 1) % 8 of byte (n - 1) / 8 is set for packet n.
+// The markers in the IUP persistent data follow once the packet is in flash.
+static IzotByte iupRcvdBitmap[(IUP_MAX_PACKET_COUNT + 7) / 8];
+
+// Run of consecutive received packets not yet written to flash
+static IzotByte iupWriteBuffer[IUP_WRITE_BUFFER_SIZE];
+static IzotUbits16 iupWriteFirstPacket;
+static IzotUbits16 iupWritePacketCount;
 #endif
 
 static IzotByte saltBytes[SALT_LENGTH];
@@ -98,29 +130,179 @@ uint32_t swaplong(uint32_t int_32)
  * Section: Function Definitions
  *****************************************************************/
 
+/*
+ * Writes the changes to the IUP image file to storage.
+ * Parameters:
+ *   None
+ * Returns:
+ *   None
+ * Notes:
+ *   The partition is synced before the persistent data, so a packet
+ *   marker is not in storage before its packet.  The kernel may still
+ *   write pages back earlier on its own; the digest check of the image
+ *   catches a packet lost that way.  On FreeRTOS, flash writes are
+ *   already in storage.
+ */
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
+static void iupFlashSync(void)
+{
+#if OS_IS(LINUX)
+    if (iupImage != NULL && iupUnsyncedBytes != 0) {
+        HalSyncIupImage(part->start, part->size);
+        HalSyncIupImage(IUP_FLASH_OFFSET, EEPROM_BLOCK_SIZE);
+        iupUnsyncedBytes = 0;
+    }
+#endif  // OS_IS(LINUX)
+}
+
+/*
+ * Returns the mapped IUP image file, opening it on first use.
+ * Parameters:
+ *   addr: Address of the first byte to access
+ *   len: Number of bytes to access
+ * Returns:
+ *   Pointer to the byte at addr, or NULL if the range is not available.
+ */
+#if OS_IS(LINUX)
+static IzotByte *iupFlashMap(uint32_t addr, uint32_t len)
+{
+    if (iupImage == NULL &&
+            HalOpenIupImage(IUP_IMAGE_FILE_SIZE, &iupImage) != LonStatusNoError) {
+        iupImage = NULL;
+        return NULL;
+    }
+    if (addr > IUP_IMAGE_FILE_SIZE || len > IUP_IMAGE_FILE_SIZE - addr) {
+        return NULL;
+    }
+    return &iupImage[addr];
+}
+#endif  // OS_IS(LINUX)
+
+/*
+ * Reads from the flash holding the IUP persistent data and the passive
+ * partition.
+ * Parameters:
+ *   data: Buffer for the data
+ *   len: Number of bytes to read
+ *   addr: Flash address to read from
+ * Returns:
+ *   0 on success, otherwise a non-zero value
+ */
+static int iupFlashRead(IzotByte *data, uint32_t len, uint32_t addr)
+{
+#if PLATFORM_IS(FRTOS_ARM_EABI)
+    return iflash_drv_read(NULL, data, len, addr);
+#else
+    IzotByte *flash = iupFlashMap(addr, len);
+
+    if (flash == NULL) {
+        return IUP_ERROR;
+    }
+    memcpy(data, flash, len);
+    return IUP_ERROR_NONE;
+#endif  // PLATFORM_IS(FRTOS_ARM_EABI)
+}
+
+/*
+ * Writes to the flash holding the IUP persistent data and the passive
+ * partition.
+ * Parameters:
+ *   toPartition: TRUE to write through the passive partition device
+ *   data: Data to write
+ *   len: Number of bytes to write
+ *   addr: Flash address to write to
+ * Returns:
+ *   0 on success, otherwise a non-zero value
+ * Notes:
+ *   On Linux, the data is synced with the next IUP_IMAGE_SYNC_SIZE bytes
+ *   written, or by the next iupFlashSync().
+ */
+static int iupFlashWrite(IzotByte toPartition, IzotByte *data, uint32_t len, uint32_t addr)
+{
+#if PLATFORM_IS(FRTOS_ARM_EABI)
+    return iflash_drv_write(toPartition ? device : NULL, data, len, addr);
+#else
+    IzotByte *flash = iupFlashMap(addr, len);
+
+    (void)toPartition;  // One mapped file holds all of the flash
+    if (flash == NULL) {
+        return IUP_ERROR;
+    }
+    memcpy(flash, data, len);
+    iupUnsyncedBytes += len;
+    if (iupUnsyncedBytes >= IUP_IMAGE_SYNC_SIZE) {
+        iupFlashSync();
+    }
+    return IUP_ERROR_NONE;
+#endif  // PLATFORM_IS(FRTOS_ARM_EABI)
+}
+
+/*
+ * Erases a range of the flash holding the IUP persistent data and the
+ * passive partition.
+ * Parameters:
+ *   inPartition: TRUE to erase through the passive partition device
+ *   addr: Flash address of the range
+ *   len: Number of bytes to erase
+ * Returns:
+ *   0 on success, otherwise a negative value
+ */
+static int iupFlashErase(IzotByte inPartition, uint32_t addr, uint32_t len)
+{
+#if PLATFORM_IS(FRTOS_ARM_EABI)
+    return iflash_drv_erase(inPartition ? device : NULL, addr, len);
+#else
+    IzotByte *flash = iupFlashMap(addr, len);
+
+    (void)inPartition;  // One mapped file holds all of the flash
+    if (flash == NULL) {
+        return IUP_ERROR;
+    }
+    memset(flash, EEPROM_NOT_WRITTEN, len);
+    iupUnsyncedBytes += len;
+    return IUP_ERROR_NONE;
+#endif  // PLATFORM_IS(FRTOS_ARM_EABI)
+}
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
+
 /*
  * Returns TRUE if given packet is missed.
  * Parameters:
  *   packetNumber: The packet number to check
  * Returns:
- *   TRUE if packet is missed, FALSE otherwise
+ *   TRUE if packet is missed, FALSE otherwise.  A packet number outside
+ *   the image is never missed, so it is dropped.
  */
-#if !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
 static IzotByte isPacketMissed(IzotUbits16 packetNumber)
 {
-    IzotByte isPktWritten = 0;
+    IzotUbits16 bit = packetNumber - 1;
+
+    if (packetNumber == 0 || packetNumber > iupPersistData.initData.IupPacketCount) {
+        return FALSE;
+    }
+    return (iupRcvdBitmap[bit / 8] & (1 << (bit % 8))) ? FALSE : TRUE;
+}
 
-    // Read only one byte for particular packet number at respective location
-    iflash_drv_read(NULL, &isPktWritten, 1,
-            IUP_FLASH_OFFSET + iupPersistDataLen + packetNumber - 1);
+/*
+ * Marks a packet as received or missed in the received packet bitmap.
+ * Parameters:
+ *   packetNumber: The packet number, from 1 to the packet count
+ *   received: TRUE if the packet is received
+ * Returns:
+ *   None
+ */
+static void setPacketReceived(IzotUbits16 packetNumber, IzotByte received)
+{
+    IzotUbits16 bit = packetNumber - 1;
 
-    if (isPktWritten == EEPROM_NOT_WRITTEN) {  // packet is not received before
-        return TRUE;
+    if (received) {
+        iupRcvdBitmap[bit / 8] |= (IzotByte)(1 << (bit % 8));
     } else {
-        return FALSE;
+        iupRcvdBitmap[bit / 8] &= (IzotByte)~(1 << (bit % 8));
     }
 }
-#endif  // !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
 
 /*
  * Writes the IUP data into EEPROM.
@@ -131,12 +313,12 @@ static IzotByte isPacketMissed(IzotUbits16 packetNumber)
  * Returns:
  *   None
  */
-#if !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
 static void writeIupPersistData(IzotByte *data, uint32_t len, uint32_t addr)
 {
-    iflash_drv_write(NULL, data, len, addr);
+    iupFlashWrite(FALSE, data, len, addr);
 }
-#endif  // !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
 
 /*
  * Erases the IUP data from EEPROM and takes the appropriate action.
@@ -145,12 +327,67 @@ static void writeIupPersistData(IzotByte *data, uint32_t len, uint32_t addr)
  * Returns:
  *   None
  */
-#if !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
 void EraseIupPersistData(void)
 {
-    iflash_drv_erase(NULL, IUP_FLASH_OFFSET, EEPROM_BLOCK_SIZE);
+    iupFlashErase(FALSE, IUP_FLASH_OFFSET, EEPROM_BLOCK_SIZE);
 }
-#endif  // !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
+
+/*
+ * Writes the buffered run of packets to the passive partition, then
+ * writes their received markers to the IUP persistent data.
+ * Parameters:
+ *   None
+ * Returns:
+ *   IUP_ERROR_NONE if the packets were written, otherwise IUP_ERROR
+ * Notes:
+ *   The markers are written after the data, so a power failure between
+ *   the two writes only causes the packets to be sent again.  Packets that
+ *   could not be written are marked missed, so the next confirm request
+ *   reports them.
+ */
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
+static int flushIupWriteBuffer(void)
+{
+    IzotUbits16 packetLen = iupPersistData.initData.IupPacketLen;
+    IzotUbits16 first = iupWriteFirstPacket;
+    IzotUbits16 count = iupWritePacketCount;
+    IzotByte markers[32];
+    IzotUbits16 i, n;
+
+    if (count == 0) {
+        return IUP_ERROR_NONE;
+    }
+    iupWritePacketCount = 0;
+
+    if (iupFlashWrite(TRUE, iupWriteBuffer, (uint32_t)count * packetLen,
+                part->start + ((first - 1) * packetLen)) != 0) {
+        OsalPrintLog(ERROR_LOG, LonStatusIupImageWriteFailure,
+                "flushIupWriteBuffer: Failed to write packets %d to %d", first,
+                first + count - 1);
+        for (i = 0; i < count; i++) {
+            setPacketReceived(first + i, FALSE);
+        }
+        iupRcvdPckCount -= count;
+        return IUP_ERROR;
+    }
+
+    memset(markers, EEPROM_WRITTEN, sizeof(markers));
+    for (i = 0; i < count; i += n) {
+        n = (IzotUbits16)(count - i);
+        if (n > sizeof(markers)) {
+            n = sizeof(markers);
+        }
+        writeIupPersistData(markers, n, IUP_FLASH_OFFSET + iupPersistDataLen + first - 1 + i);
+    }
+
+    OsalPrintLog(INFO_LOG, LonStatusNoError,
+            "flushIupWriteBuffer: Packets %d to %d at address %X", first,
+            first + count - 1, part->start + ((first - 1) * packetLen));
+    return IUP_ERROR_NONE;
+}
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
 
 /*
  * Reads the IUP data from EEPROM and takes the appropriate action.
@@ -161,31 +398,49 @@ void EraseIupPersistData(void)
  */
 void readIupPersistData(void)
 {
-#if !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
-    IzotUbits16 pktNumber;
-    IzotByte isPktWritten = 0;
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
+    IzotUbits16 pktNumber, i, n;
+    IzotByte markers[64];
     IzotByte data[iupPersistDataLen];
 
+#if PLATFORM_IS(FRTOS_ARM_EABI)
     part = rfget_get_passive_firmware();
+#endif  // PLATFORM_IS(FRTOS_ARM_EABI)
 
-    iflash_drv_read(NULL, data, 1, IUP_FLASH_OFFSET);
+    data[0] = 0;
+    iupFlashRead(data, 1, IUP_FLASH_OFFSET);
 
     if (data[0] == IUP_PERSIST_DATA_VALID) {
         OsalPrintLog(DETAIL_TRACE_LOG, LonStatusNoError,
                 "readIupPersistData: Found IUP persistent data");
 
+#if PLATFORM_IS(FRTOS_ARM_EABI)
         iflash_drv_init();
         device = flash_drv_open(part->device);
+#endif  // PLATFORM_IS(FRTOS_ARM_EABI)
 
-        iflash_drv_read(NULL, data, iupPersistDataLen, IUP_FLASH_OFFSET);
+        iupFlashRead(data, iupPersistDataLen, IUP_FLASH_OFFSET);
         memcpy(&iupPersistData, (IupPersistent *)&data, iupPersistDataLen);
 
+        // Rebuild the received packet bitmap from the persisted markers
+        memset(iupRcvdBitmap, 0, sizeof(iupRcvdBitmap));
+        iupRcvdPckCount = 0;
+        iupWritePacketCount = 0;
+        if (iupPersistData.initData.IupPacketCount > IUP_MAX_PACKET_COUNT) {
+            iupPersistData.initData.IupPacketCount = IUP_MAX_PACKET_COUNT;
+        }
         for (pktNumber = 0; pktNumber < iupPersistData.initData.IupPacketCount;
-                pktNumber++) {
-            iflash_drv_read(NULL, &isPktWritten, 1,
-                    IUP_FLASH_OFFSET + iupPersistDataLen + pktNumber);
-            if (isPktWritten != EEPROM_NOT_WRITTEN) {
-                iupRcvdPckCount++;
+                pktNumber += n) {
+            n = iupPersistData.initData.IupPacketCount - pktNumber;
+            if (n > sizeof(markers)) {
+                n = sizeof(markers);
+            }
+            iupFlashRead(markers, n, IUP_FLASH_OFFSET + iupPersistDataLen + pktNumber);
+            for (i = 0; i < n; i++) {
+                if (markers[i] != EEPROM_NOT_WRITTEN) {
+                    setPacketReceived(pktNumber + i + 1, TRUE);
+                    iupRcvdPckCount++;
+                }
             }
         }
         OsalPrintLog(INFO_LOG, LonStatusNoError,
@@ -195,7 +450,7 @@ void readIupPersistData(void)
         OsalPrintLog(INFO_LOG, LonStatusNoError,
                 "readIupPersistData: No IUP persistent data found");
     }
-#endif  // !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
 }
 
 /*
@@ -207,11 +462,13 @@ void readIupPersistData(void)
  */
 int InitUpdateProcess(void)
 {
-#if !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
     // Check whether transfer in process.
     // If yes then stop the previous transfer in process
     iupPersistData.iupMode = 1;
     iupRcvdPckCount = 0;  // Set the rcvd packet count to zero
+    memset(iupRcvdBitmap, 0, sizeof(iupRcvdBitmap));
+    iupWritePacketCount = 0;
     iupPersistData.iupConfirmResultSucceed = FALSE;
     iupCommitTimerStarted = FALSE;
     iupImageValidated = FALSE;
@@ -223,6 +480,7 @@ int InitUpdateProcess(void)
             "InitUpdateProcess: Erasing IUP persistent data in Init stage");
     EraseIupPersistData();
 
+#if PLATFORM_IS(FRTOS_ARM_EABI)
     iflash_drv_init();
     device = flash_drv_open(part->device);
     if (device == NULL) {
@@ -230,8 +488,9 @@ int InitUpdateProcess(void)
                 "InitUpdateProcess: Flash driver initialization is required before open");
         return IUP_ERROR;
     }
+#endif  // PLATFORM_IS(FRTOS_ARM_EABI)
 
-    if (iflash_drv_erase(device, part->start, part->size) < 0) {
+    if (iupFlashErase(TRUE, part->start, part->size) < 0) {
         OsalPrintLog(ERROR_LOG, LonStatusInitializationFailed,
                 "InitUpdateProcess: Failed to erase partition");
         return IUP_ERROR;
@@ -240,10 +499,11 @@ int InitUpdateProcess(void)
     writeIupPersistData((IzotByte *)&iupPersistData.iupMode,
             sizeof(iupPersistData.iupMode) + sizeof(iupPersistData.initData),
             IUP_FLASH_OFFSET);
+    iupFlashSync();
 
     OsalPrintLog(INFO_LOG, LonStatusNoError,
             "InitUpdateProcess: Image Update Process (IUP) initialization completed");
-#endif  // !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
     return IUP_ERROR_NONE;
 }
 
@@ -258,13 +518,15 @@ int VerifyImage(void)
 {
     int error = IUP_ERROR_NONE;
 
-#if !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
     OsalPrintLog(INFO_LOG, LonStatusNoError,
             "VerifyImage: Validating firmware start from %X... IupImageLen = %d",
             part->start, iupPersistData.initData.IupImageLen);
 
+#if PLATFORM_IS(FRTOS_ARM_EABI)
     // Then validate firmware data in flash
     error = verify_load_firmware(part->start, iupPersistData.initData.IupImageLen);
+#endif  // PLATFORM_IS(FRTOS_ARM_EABI)
 
     if (error) {
         OsalPrintLog(ERROR_LOG, LonStatusInvalidFirmwareImage,
@@ -273,7 +535,7 @@ int VerifyImage(void)
         OsalPrintLog(INFO_LOG, LonStatusNoError,
                 "VerifyImage: Validation done successfully");
     }
-#endif  // !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
     return error;
 }
 
@@ -420,7 +682,7 @@ void MD5Init(MD5Context *ctx)
  * Returns:
  *   None
  */
-void MD5Update(MD5Context *ctx, IzotByte *buf, IzotByte len)
+void MD5Update(MD5Context *ctx, IzotByte *buf, uint32_t len)
 {
     uint32_t t;
 
@@ -519,23 +781,25 @@ void MD5Final(uint8_t *digest, MD5Context *ctx)
  */
 void ComputeMD5Digest(void)
 {
-    int salt_index = 0;
     MD5Init(&md5c);
 
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
+    flushIupWriteBuffer();
+    iupFlashSync();
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
     if (VerifyImage() != 0) {
         iupImageValidated = TRUE;
         digestmatch = FALSE;
     }
-    for (salt_index = 0; salt_index < 16; ++salt_index) {
-        MD5Update(&md5c, &saltBytes[salt_index], 1);
-    }
+    MD5Update(&md5c, saltBytes, SALT_LENGTH);
 
     fileSizeTemp = 0;
     SetLonTimer(&iupMd5EventTimer, 2);
 }
 
 /*
- * Calculates MD5 for every 128 bytes from image and starts the MD5 Event Timer again.
+ * Adds the next IUP_MD5_CHUNK_SIZE bytes of the image to the MD5 digest and
+ * starts the MD5 Event Timer again, or checks the digest at the end.
  * Parameters:
  *   None
  * Returns:
@@ -543,27 +807,19 @@ void ComputeMD5Digest(void)
  */
 void CalculateMD5(void)
 {
-#if !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
     IzotByte digestResp[MD5_DIGEST_LENGTH];
-    IzotByte md5buffer[128];
-    IzotByte surPlus = iupPersistData.initData.IupImageLen % sizeof(md5buffer);
-    int i;
+    static IzotByte md5buffer[IUP_MD5_CHUNK_SIZE];
+    uint32_t len;
 
     if (fileSizeTemp < iupPersistData.initData.IupImageLen) {
-        if ((iupPersistData.initData.IupImageLen - fileSizeTemp) == surPlus) {
-            iflash_drv_read(NULL, &md5buffer[0], surPlus, fileSizeTemp + part->start);
-            for (i = 0; i < surPlus; i++) {
-                MD5Update(&md5c, &md5buffer[i], 1);
-            }
-            fileSizeTemp += surPlus;
-        } else {
-            iflash_drv_read(NULL, &md5buffer[0], sizeof(md5buffer),
-                    fileSizeTemp + part->start);
-            for (i = 0; i < sizeof(md5buffer); i++) {
-                MD5Update(&md5c, &md5buffer[i], 1);
-            }
-            fileSizeTemp += sizeof(md5buffer);
+        len = iupPersistData.initData.IupImageLen - fileSizeTemp;
+        if (len > sizeof(md5buffer)) {
+            len = sizeof(md5buffer);
         }
+        iupFlashRead(md5buffer, len, fileSizeTemp + part->start);
+        MD5Update(&md5c, md5buffer, len);
+        fileSizeTemp += len;
         SetLonTimer(&iupMd5EventTimer, 2);
     } else {
         MD5Final(digestResp, &md5c);
@@ -591,7 +847,7 @@ void CalculateMD5(void)
         iupImageValidated = TRUE;
         fileSizeTemp = 0;
     }
-#endif  // !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
 }
 
 /*
@@ -606,7 +862,8 @@ void CalculateMD5(void)
  */
 void SwitchOverImage(void)
 {
-#if !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
+#if PLATFORM_IS(FRTOS_ARM_EABI)
     int error;
 
     iflash_drv_close(device);
@@ -617,7 +874,16 @@ void SwitchOverImage(void)
     if (!iupPersistData.SecondaryFlag) {
         arch_reboot();
     }
-#endif  // !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#else
+    // The host installs the image from the IUP image file
+    iupFlashSync();
+    if (!iupPersistData.SecondaryFlag) {
+        OsalPrintLog(INFO_LOG, LonStatusNoError,
+                "SwitchOverImage: %d byte image ready at offset %X of the IUP image file",
+                iupPersistData.initData.IupImageLen, part->start);
+    }
+#endif  // PLATFORM_IS(FRTOS_ARM_EABI)
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
 }
 
 /*
@@ -631,18 +897,24 @@ void SwitchOverImage(void)
  */
 void CommitImage(void)
 {
-#if !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
     if (!iupPersistData.iupCommitDone) {
+#if PLATFORM_IS(FRTOS_ARM_EABI)
         part_set_active_partition(part);
         iflash_drv_close(device);
+#endif  // PLATFORM_IS(FRTOS_ARM_EABI)
         iupPersistData.iupCommitDone = TRUE;
         writeIupPersistData(&iupPersistData.iupCommitDone, 1,
                 IUP_FLASH_OFFSET + sizeof(iupPersistData.iupMode) +
                         sizeof(iupPersistData.initData) +
                         sizeof(iupPersistData.iupConfirmResultSucceed));
+#if PLATFORM_IS(FRTOS_ARM_EABI)
         arch_reboot();
+#else
+        iupFlashSync();
+#endif  // PLATFORM_IS(FRTOS_ARM_EABI)
     }
-#endif  // !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
 }
 
 /*
@@ -674,7 +946,7 @@ IzotByte isEmpty(IzotByte *in, IzotUbits16 len)
  */
 void HandleNmeIupInit(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 {
-#if !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
     // Get the available partition size
     uint32_t sizeAvailable = part->size;
     struct __attribute__((packed)) {
@@ -750,7 +1022,7 @@ void HandleNmeIupInit(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
     memcpy(&iupPersistData.initData.IupImageIdentifier, &init_request->imgIdent,
             sizeof(iupPersistData.initData.IupImageIdentifier));
 
-    if (iupPersistData.initData.IupPacketCount > (4096 - iupPersistDataLen)) {
+    if (iupPersistData.initData.IupPacketCount > IUP_MAX_PACKET_COUNT) {
         init_response.resultCode = IUP_INIT_RESULT_PACKET_COUNT_TOO_HIGH;
         init_response.packetCount = swapword(1);
         SendResponse(appReceiveParamPtr->reqId, NM_resp_success | NM_EXPANDED,
@@ -799,7 +1071,7 @@ void HandleNmeIupInit(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
     SendResponse(appReceiveParamPtr->reqId, NM_resp_success | NM_EXPANDED,
             sizeof(init_response), (IzotByte *)&init_response);
     return;
-#endif  // !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
 }
 
 /*
@@ -812,8 +1084,9 @@ void HandleNmeIupInit(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
  */
 void HandleNmeIupTransfer(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 {
-#if !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
     IzotUbits16 newPckNum = 0;
+    IzotUbits16 packetLen = iupPersistData.initData.IupPacketLen;
 
     // Drop the packet with no data
     if (appReceiveParamPtr->pduSize <= 2) {
@@ -853,24 +1126,30 @@ void HandleNmeIupTransfer(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
             return;
         }
 
-        if (iflash_drv_write(device, &transfer_request->data[0],
-                    iupPersistData.initData.IupPacketLen,
-                    part->start + ((newPckNum - 1) *
-                                          iupPersistData.initData.IupPacketLen)) == 0) {
-            // Increment the received packet count
-            iupRcvdPckCount++;
-            // Store in flash that this packet number is received
-            IzotByte received = EEPROM_WRITTEN;
-            writeIupPersistData(&received, 1,
-                    IUP_FLASH_OFFSET + iupPersistDataLen + newPckNum - 1);
-
-            OsalPrintLog(INFO_LOG, LonStatusNoError,
-                    "HandleNmeIupTransfer: Packet number %d at address %X", newPckNum,
-                    part->start +
-                            ((newPckNum - 1) * iupPersistData.initData.IupPacketLen));
+        // Write the buffered run first unless this packet continues it
+        if (iupWritePacketCount != 0 &&
+                (newPckNum != iupWriteFirstPacket + iupWritePacketCount ||
+                        (uint32_t)(iupWritePacketCount + 1) * packetLen >
+                                sizeof(iupWriteBuffer))) {
+            flushIupWriteBuffer();
+        }
+        if (iupWritePacketCount == 0) {
+            iupWriteFirstPacket = newPckNum;
+        }
+        memcpy(&iupWriteBuffer[iupWritePacketCount * packetLen], &transfer_request->data[0],
+                packetLen);
+        iupWritePacketCount++;
+        setPacketReceived(newPckNum, TRUE);
+        // Increment the received packet count
+        iupRcvdPckCount++;
+
+        // Write a full buffer, and the last packet of the image, right away
+        if ((uint32_t)(iupWritePacketCount + 1) * packetLen > sizeof(iupWriteBuffer) ||
+                newPckNum == iupPersistData.initData.IupPacketCount) {
+            flushIupWriteBuffer();
         }
     }
-#endif  // !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
 }
 
 /*
@@ -883,9 +1162,8 @@ void HandleNmeIupTransfer(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
  */
 void HandleNmeIupConfirm(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 {
-#if !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
     IzotUbits16 pktNumber;
-    IzotByte isPktWritten;
     struct __attribute__((packed)) {
         IzotByte subCode;      // IUP_Confirm : 0x1E
         IzotByte resultCode;   // 8-bit result code
@@ -909,6 +1187,10 @@ void HandleNmeIupConfirm(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
         return;
     }
 
+    // Packets still in the write buffer only count once they are in flash
+    flushIupWriteBuffer();
+    iupFlashSync();
+
     if (iupRcvdPckCount < EIGHTY_PERCENT(iupPersistData.initData.IupPacketCount)) {
         OsalPrintLog(ERROR_LOG, LonStatusIupTransferFailure,
                 "HandleNmeIupConfirm: 20 percent or more packets are lost; ignoring this "
@@ -943,10 +1225,7 @@ void HandleNmeIupConfirm(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
     confirm_response.resultCode = IUP_CONFIRM_RESULT_PACKET_MISSED;
     confirm_response.packetCount = 0;
     for (pktNumber = 0; pktNumber < iupPersistData.initData.IupPacketCount; pktNumber++) {
-        iflash_drv_read(NULL, &isPktWritten, 1,
-                IUP_FLASH_OFFSET + iupPersistDataLen + pktNumber);
-
-        if (isPktWritten == EEPROM_NOT_WRITTEN) {
+        if (isPacketMissed(pktNumber + 1)) {
             OsalPrintLog(ERROR_LOG, LonStatusIupImageWriteFailure,
                     "HandleNmeIupConfirm: Packet number %d write failed", pktNumber + 1);
             confirm_response.pcktNumberColl[confirm_response.packetCount] =
@@ -970,7 +1249,7 @@ void HandleNmeIupConfirm(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
             sizeof(confirm_response) - sizeof(confirm_response.pcktNumberColl) +
                     (confirm_response.packetCount * 2),
             (IzotByte *)&confirm_response);
-#endif  // !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
 }
 
 /*
@@ -983,7 +1262,7 @@ void HandleNmeIupConfirm(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
  */
 void HandleNmeIupValidate(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 {
-#if !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
     struct __attribute__((packed)) {
         IzotByte subCode;        // IUP_Validate : 0x1F
         IzotByte resultCode;     // 8-bit result code
@@ -1040,7 +1319,7 @@ void HandleNmeIupValidate(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 
     SendResponse(appReceiveParamPtr->reqId, NM_resp_success | NM_EXPANDED,
             sizeof(validate_response), (IzotByte *)&validate_response);
-#endif  // !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
 }
 
 /*
@@ -1053,7 +1332,7 @@ void HandleNmeIupValidate(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
  */
 void HandleNmeIupSwitchOver(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 {
-#if !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
     uint32_t countDownTimer;
     struct __attribute__((packed)) {
         IzotByte subCode;  // IUP_SwitchOver : 0x20
@@ -1132,7 +1411,7 @@ void HandleNmeIupSwitchOver(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
     switchover_response.resultCode = IUP_SWITCHOVER_RESULT_SUCCESS;
     SendResponse(appReceiveParamPtr->reqId, NM_resp_success | NM_EXPANDED,
             sizeof(switchover_response), (IzotByte *)&switchover_response);
-#endif  // !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
 }
 
 /*
@@ -1145,7 +1424,7 @@ void HandleNmeIupSwitchOver(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
  */
 void HandleNmeIupStatus(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 {
-#if !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
     struct __attribute__((packed)) {
         IzotByte subCode;     // IUP_Status : 0x21
         IzotByte statusFlag;  // status flag : see above
@@ -1200,7 +1479,7 @@ void HandleNmeIupStatus(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 
     SendResponse(appReceiveParamPtr->reqId, NM_resp_success | NM_EXPANDED,
             sizeof(status_response), (IzotByte *)&status_response);
-#endif  // !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
 }
 
 /*
@@ -1213,7 +1492,7 @@ void HandleNmeIupStatus(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
  */
 void HandleNmeIupCommit(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 {
-#if !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
     struct __attribute__((packed)) {
         IzotByte subCode;  // IUP_Commit : 0x22
         IzotByte resultCode;
@@ -1269,7 +1548,7 @@ void HandleNmeIupCommit(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 
     SendResponse(appReceiveParamPtr->reqId, NM_resp_success | NM_EXPANDED,
             sizeof(commit_response), (IzotByte *)&commit_response);
-#endif  // !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
 }
 
 /*
@@ -1282,12 +1561,12 @@ void HandleNmeIupCommit(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
  */
 void HandleNmeIupTransferAck(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 {
-#if !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#if !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
     IupTransferAckResponse TransferAck_response;
     TransferAck_response.subCode = apduPtr->data[0];
     TransferAck_response.resultCode = TRANSFER_CONTINUE;
     TransferAck_response.actionTime = 0;
     SendResponse(appReceiveParamPtr->reqId, NM_resp_success | NM_EXPANDED,
             sizeof(TransferAck_response), (IzotByte *)&TransferAck_response);
-#endif  // !IUP_IS(NO_IUP) && PLATFORM_IS(FRTOS_ARM_EABI)
+#endif  // !IUP_IS(NO_IUP) && (PLATFORM_IS(FRTOS_ARM_EABI) || OS_IS(LINUX))
 }
@@ -0,0 +1,397 @@
+/*
+ * lcs_iup_benchmark.c
+ *
+ * Copyright (c) 2026 EnOcean
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ *
+ * Title:   LON Image Update Throughput Benchmark
+ * Purpose: Measures how fast lcs_iup.c stores an image in the Linux IUP
+ *          image file and checks its digest.
+ * Notes:   Each run sends an image of random bytes through
+ *          HandleNmeIupInit(), HandleNmeIupTransfer(), HandleNmeIupConfirm(),
+ *          and HandleNmeIupValidate() the way a network manager does.  The
+ *          program calls InitUpdateProcess(), ComputeMD5Digest(), and
+ *          CalculateMD5() where AppLayerReceive() calls them when their
+ *          timers expire, so the timer delays are not part of the times.
+ *          Packets can be held back from the first pass and resent when the
+ *          confirm request reports them missed.  The image in the file is
+ *          compared with the image sent; a mismatch or an unexpected
+ *          response makes the program exit with a non-zero status.
+ *
+ *          Build with -DIUP_ID=IUP_ID_V1 -DLON_STACK_BUILD_IUP_BENCHMARK=ON
+ *          and run with -h for the command line options.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "abstraction/IzotHal.h"
+#include "lcs/lcs_iup.h"
+#include "lcs/lcs_netmgmt.h"
+#include "lcs/lcs_node.h"
+
+// Default image size in bytes
+#ifndef IUP_BENCHMARK_DEFAULT_IMAGE_SIZE
+#define IUP_BENCHMARK_DEFAULT_IMAGE_SIZE (512 * 1024)
+#endif
+
+// Default number of images sent
+#ifndef IUP_BENCHMARK_DEFAULT_RUNS
+#define IUP_BENCHMARK_DEFAULT_RUNS 5
+#endif
+
+// Default directory of the IUP image file
+#define IUP_BENCHMARK_DEFAULT_DIRECTORY "/tmp/lcs_iup_benchmark"
+
+// Largest IUP request other than transfer, and largest IUP response
+#define IUP_BENCHMARK_REQUEST_SIZE 64
+#define IUP_BENCHMARK_RESPONSE_SIZE 64
+
+// Response queue entries; a queue holds one entry less than its capacity
+#define IUP_BENCHMARK_RESPONSE_COUNT 2
+
+// MD5 state as defined in lcs_iup.c
+typedef struct MD5Context {
+    uint32_t buf[4];
+    uint32_t bits[2];
+    unsigned char in[64];
+} MD5Context;
+
+extern uint16_t swapword(uint16_t int_16);
+extern uint32_t swaplong(uint32_t int_32);
+extern void MD5Init(MD5Context *ctx);
+extern void MD5Update(MD5Context *ctx, IzotByte *buf, uint32_t len);
+extern void MD5Final(uint8_t *digest, MD5Context *ctx);
+
+typedef void (*IupHandler)(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr);
+
+static IzotByte image[IUP_IMAGE_PARTITION_SIZE];
+static IzotByte responseData[IUP_BENCHMARK_RESPONSE_SIZE];
+static uint64_t responseStorage[IUP_BENCHMARK_RESPONSE_COUNT *
+        ((sizeof(TSASendParam) + IUP_BENCHMARK_RESPONSE_SIZE + 7) / 8)];
+
+/*****************************************************************
+ * Section: Function Definitions
+ *****************************************************************/
+
+/*
+ * Fills a buffer with pseudo-random bytes.
+ * Parameters:
+ *   data: buffer to fill
+ *   length: number of bytes
+ * Returns:
+ *   None
+ */
+static void RandomBytes(void *data, size_t length)
+{
+    IzotByte *bytes = data;
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        bytes[i] = (IzotByte)(rand() >> 7);
+    }
+}
+
+/*
+ * Returns a monotonic time stamp in nanoseconds.
+ */
+static double NowNanoseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1e9 + (double)now.tv_nsec;
+}
+
+/*
+ * Passes an IUP request to its handler and returns the response.
+ * Parameters:
+ *   handler: request handler in lcs_iup.c
+ *   request: APDU with the request, starting with the code
+ *   length: number of APDU bytes
+ * Returns:
+ *   Pointer to the response data after the code, starting with the
+ *   sub-command, or NULL if the handler did not respond
+ * Notes:
+ *   The response is taken from the transaction services response queue,
+ *   where SendResponse() puts it for the transport layer.
+ */
+static const IzotByte *Request(IupHandler handler, IzotByte *request, int length)
+{
+    APPReceiveParam param;
+    TSASendParam *response;
+
+    memset(&param, 0, sizeof(param));
+    param.service = IzotServiceRequest;
+    param.pduSize = (IzotUbits16)length;
+    handler(&param, (APDU *)request);
+
+    if (QueueEmpty(&gp->tsaRespQ)) {
+        return NULL;
+    }
+    response = QueuePeek(&gp->tsaRespQ);
+    memcpy(responseData, (IzotByte *)(response + 1) + 1, response->apduSize - 1);
+    QueueDropHead(&gp->tsaRespQ);
+    return responseData;
+}
+
+/*
+ * Sends one packet of the image.
+ * Parameters:
+ *   session: session number
+ *   packetNumber: packet number, from 1
+ *   packetSize: bytes per packet
+ * Returns:
+ *   None
+ */
+static void SendPacket(uint32_t session, IzotUbits16 packetNumber, int packetSize)
+{
+    IzotByte request[1 + offsetof(IUP_TransferRequest, data) + IUP_PACKET_SIZE_SUPPORTED];
+    IUP_TransferRequest *transfer = (IUP_TransferRequest *)&request[1];
+
+    request[0] = NM_opcode_base | NM_EXPANDED;
+    transfer->subCode = NME_IUP_TRANSFER;
+    transfer->sessionNumber = swaplong(session);
+    transfer->packetNumber = swapword(packetNumber);
+    memcpy(transfer->data, &image[(packetNumber - 1) * packetSize], packetSize);
+    Request(HandleNmeIupTransfer, request,
+            1 + offsetof(IUP_TransferRequest, data) + packetSize);
+}
+
+/*
+ * Sends the image once and reports the times.
+ * Parameters:
+ *   run: run number, from 1; also used as the session number
+ *   imageSize: bytes in the image
+ *   packetSize: bytes per packet
+ *   holdBack: every holdBack-th packet is left out of the first pass;
+ *     0 sends all packets
+ *   transferSeconds: pointer to the total transfer time, increased by
+ *     this run
+ * Returns:
+ *   0 if the image was stored and validated, otherwise 1
+ */
+static int SendImage(int run, uint32_t imageSize, int packetSize, int holdBack,
+        double *transferSeconds)
+{
+    IzotByte request[IUP_BENCHMARK_REQUEST_SIZE];
+    IUP_InitRequest *init = (IUP_InitRequest *)&request[1];
+    IUP_ConfirmRequest *confirm = (IUP_ConfirmRequest *)&request[1];
+    IUP_ValidateRequest *validate = (IUP_ValidateRequest *)&request[1];
+    IzotUbits16 packetCount = (IzotUbits16)((imageSize + packetSize - 1) / packetSize);
+    uint32_t session = (uint32_t)run;
+    const IzotByte *response;
+    IzotByte *file;
+    MD5Context md5;
+    double start, initTime, transferTime, validateTime;
+    int resent = 0;
+    int rounds = 0;
+    int i;
+
+    RandomBytes(image, imageSize);
+    request[0] = NM_opcode_base | NM_EXPANDED;
+
+    // Init
+    memset(init, 0, sizeof(*init));
+    init->subCode = NME_IUP_INIT;
+    init->sessionNumber = swaplong(session);
+    init->imgIdent.imgType = HOST_PROCESSOR_COMBINED_IMAGE;
+    init->imgIdent.imgSubType = HOST_PROCESSOR_COMBINED_IMAGE;
+    init->pcktSize = swapword((uint16_t)packetSize);
+    init->pcktCount = swapword(packetCount);
+    init->imageLen = swaplong(imageSize);
+    response = Request(HandleNmeIupInit, request, 1 + sizeof(*init));
+    if (response == NULL || response[1] != IUP_INIT_RESULT_SUCCESS) {
+        printf("Run %d: init request failed (result %d)\n", run,
+                response ? response[1] : -1);
+        return 1;
+    }
+    start = NowNanoseconds();
+    if (InitUpdateProcess() != IUP_ERROR_NONE) {
+        printf("Run %d: cannot erase the IUP image file\n", run);
+        return 1;
+    }
+    initTime = NowNanoseconds() - start;
+
+    // Transfer, then resend what the confirm requests report missed
+    start = NowNanoseconds();
+    for (i = 1; i <= packetCount; i++) {
+        if (holdBack == 0 || i % holdBack != 0) {
+            SendPacket(session, (IzotUbits16)i, packetSize);
+        }
+    }
+    for (;;) {
+        memset(confirm, 0, sizeof(*confirm));
+        confirm->subCode = NME_IUP_CONFIRM;
+        confirm->sessionNumber = swaplong(session);
+        response = Request(HandleNmeIupConfirm, request, 1 + sizeof(*confirm));
+        if (response != NULL && response[1] == IUP_CONFIRM_RESULT_SUCESS) {
+            break;
+        }
+        if (response == NULL || response[1] != IUP_CONFIRM_RESULT_PACKET_MISSED ||
+                ++rounds > packetCount) {
+            printf("Run %d: confirm request failed (result %d)\n", run,
+                    response ? response[1] : -1);
+            return 1;
+        }
+        for (i = 0; i < response[2]; i++) {
+            SendPacket(session, (IzotUbits16)((response[3 + 2 * i] << 8) | response[4 + 2 * i]),
+                    packetSize);
+            resent++;
+        }
+    }
+    transferTime = NowNanoseconds() - start;
+
+    // Validate with an MD5 digest of a random salt and the image
+    memset(validate, 0, sizeof(*validate));
+    validate->subCode = NME_IUP_VALIDATE;
+    validate->sessionNumber = swaplong(session);
+    validate->digestType = DIGEST_TYPE_MD5;
+    RandomBytes(validate->saltBytes, sizeof(validate->saltBytes));
+    MD5Init(&md5);
+    MD5Update(&md5, validate->saltBytes, sizeof(validate->saltBytes));
+    MD5Update(&md5, image, imageSize);
+    MD5Final(validate->digestBytes, &md5);
+    start = NowNanoseconds();
+    response = Request(HandleNmeIupValidate, request, 1 + sizeof(*validate));
+    if (response == NULL || response[1] != IUP_VALIDATE_RESULT_STILL_PENDING) {
+        printf("Run %d: validate request failed (result %d)\n", run,
+                response ? response[1] : -1);
+        return 1;
+    }
+    ComputeMD5Digest();
+    while (!iupImageValidated) {
+        CalculateMD5();
+    }
+    response = Request(HandleNmeIupValidate, request, 1 + sizeof(*validate));
+    validateTime = NowNanoseconds() - start;
+    if (response == NULL || response[1] != IUP_VALIDATE_RESULT_SUCCESS) {
+        printf("Run %d: image digest does not match (result %d)\n", run,
+                response ? response[1] : -1);
+        return 1;
+    }
+
+    // The partition follows the IUP persistent data block in the file
+    if (HalOpenIupImage(EEPROM_BLOCK_SIZE + IUP_IMAGE_PARTITION_SIZE, &file) !=
+                    LonStatusNoError ||
+            memcmp(&file[EEPROM_BLOCK_SIZE], image, imageSize) != 0) {
+        printf("Run %d: image in the IUP image file does not match\n", run);
+        return 1;
+    }
+
+    printf("Run %d: init %7.2f ms, transfer %8.2f ms (%7.0f KiB/s, %d resent), "
+           "validate %7.2f ms (%7.0f KiB/s)\n",
+            run, initTime / 1e6, transferTime / 1e6,
+            imageSize / 1024.0 / (transferTime / 1e9), resent, validateTime / 1e6,
+            imageSize / 1024.0 / (validateTime / 1e9));
+    *transferSeconds += transferTime / 1e9;
+    return 0;
+}
+
+static void Usage(const char *program)
+{
+    printf("Usage: %s [options]\n", program);
+    printf("  -s bytes    Image size (default %d, at most %d)\n",
+            IUP_BENCHMARK_DEFAULT_IMAGE_SIZE, IUP_IMAGE_PARTITION_SIZE);
+    printf("  -p bytes    Packet size (default and at most %d)\n",
+            IUP_PACKET_SIZE_SUPPORTED);
+    printf("  -n count    Images sent (default %d)\n", IUP_BENCHMARK_DEFAULT_RUNS);
+    printf("  -m n        Hold back every n-th packet until confirm (n > 5; default 0)\n");
+    printf("  -d dir      Directory of the IUP image file (default %s)\n",
+            IUP_BENCHMARK_DEFAULT_DIRECTORY);
+    printf("  -r seed     Random seed (default 1)\n");
+    printf("  -v          Show the stack log\n");
+}
+
+int main(int argc, char *argv[])
+{
+    static char configFile[512];
+    const char *directory = IUP_BENCHMARK_DEFAULT_DIRECTORY;
+    long imageSize = IUP_BENCHMARK_DEFAULT_IMAGE_SIZE;
+    int packetSize = IUP_PACKET_SIZE_SUPPORTED;
+    int runs = IUP_BENCHMARK_DEFAULT_RUNS;
+    int holdBack = 0;
+    int verbose = 0;
+    unsigned seed = 1;
+    double transferSeconds = 0;
+    long packetCount;
+    int option;
+    int run;
+
+    while ((option = getopt(argc, argv, "s:p:n:m:d:r:vh")) != -1) {
+        switch (option) {
+        case 's':
+            imageSize = strtol(optarg, NULL, 0);
+            break;
+        case 'p':
+            packetSize = (int)strtol(optarg, NULL, 0);
+            break;
+        case 'n':
+            runs = (int)strtol(optarg, NULL, 0);
+            break;
+        case 'm':
+            holdBack = (int)strtol(optarg, NULL, 0);
+            break;
+        case 'd':
+            directory = optarg;
+            break;
+        case 'r':
+            seed = (unsigned)strtoul(optarg, NULL, 0);
+            break;
+        case 'v':
+            verbose = 1;
+            break;
+        default:
+            Usage(argv[0]);
+            return option == 'h' ? 0 : 1;
+        }
+    }
+    packetCount = packetSize > 0 ? (imageSize + packetSize - 1) / packetSize : 0;
+    if (imageSize <= 0 || packetSize <= 0 || packetSize > IUP_PACKET_SIZE_SUPPORTED ||
+            runs <= 0 || (holdBack != 0 && holdBack <= 5) ||
+            packetCount * packetSize > IUP_IMAGE_PARTITION_SIZE) {
+        Usage(argv[0]);
+        return 1;
+    }
+    if (packetCount > (long)IUP_MAX_PACKET_COUNT) {
+        printf("%ld packets exceed the IUP limit of %d; use larger packets or a "
+               "smaller image\n",
+                packetCount, (int)IUP_MAX_PACKET_COUNT);
+        return 1;
+    }
+
+    // HalInitStorage() uses the directory of the configuration file
+    snprintf(configFile, sizeof(configFile), "%s/config", directory);
+    setenv("LON_STACK_DX_CONFIG_FILE", configFile, 1);
+    OsalSetLogCategories(verbose ? LOG_DEBUG : LOG_NONE);
+
+    // Responses go to the transaction services response queue of the stack,
+    // and error log entries to its network image
+    gp = &protocolStackDataGbl[0];
+    eep = &eeprom[0];
+    gp->tsaRespBufSize = IUP_BENCHMARK_RESPONSE_SIZE;
+    if (QueueInitStorage(&gp->tsaRespQ, "IUP benchmark responses",
+                sizeof(TSASendParam) + IUP_BENCHMARK_RESPONSE_SIZE,
+                IUP_BENCHMARK_RESPONSE_COUNT, responseStorage) != LonStatusNoError) {
+        printf("Cannot initialize the response queue\n");
+        return 1;
+    }
+
+    srand(seed);
+    printf("Sending %d image(s) of %ld bytes in %ld packets of %d bytes to %s/iup_image\n",
+            runs, imageSize, packetCount, packetSize, directory);
+    for (run = 1; run <= runs; run++) {
+        if (SendImage(run, (uint32_t)imageSize, packetSize, holdBack, &transferSeconds)) {
+            HalCloseIupImage();
+            return 1;
+        }
+    }
+    printf("Average transfer throughput: %.0f KiB/s\n",
+            runs * imageSize / 1024.0 / transferSeconds);
+    return HalCloseIupImage() == LonStatusNoError ? 0 : 1;
+}
@@ -21,6 +21,7 @@
 #include <string.h>
 
 #include "lcs/lcs_eia709_1.h"
+#include "lcs/lcs_network.h"
 #include "lcs/lcs_node.h"
 #include "lcs/lcs_queue.h"
 
@@ -50,23 +51,49 @@ typedef struct {
     bool fetchXcvrParams;
     XcvrParam xcvrParams;
     bool setPlPhase;
+    uint32_t framesSent;  // Downlink frames sent through this interface when bonded
+    uint32_t duplicates;  // Uplink frames dropped as already received when bonded
 } LonNiDef;
 
 // LON network interface definition array
-LonNiDef lonNi[NUM_LON_NI] = {{-1, false, false, false, {0}, false}
+LonNiDef lonNi[NUM_LON_NI] = {{-1, false, false, false, {0}, false, 0, 0}
 #if NUM_LON_NI > 1
         ,
-        {-1, false, false, false, {0}, false}
+        {-1, false, false, false, {0}, false, 0, 0}
 #elif NUM_LON_NI > 2
         ,
-        {-1, false, false, false, {0}, false}
+        {-1, false, false, false, {0}, false, 0, 0}
 #elif NUM_LON_NI > 3
         ,
-        {-1, false, false, false, {0}, false}
+        {-1, false, false, false, {0}, false, 0, 0}
 #endif
 };
 #endif  // LINK_IS(MULTIPLE_USB_MIPS) || PHYSICAL_IS(LON_PL_PROXY)
 
+#if LINK_IS(MULTIPLE_USB_MIPS) && LON_NI_BONDING
+// Uplink frames received by more than one bonded interface within this
+// many milliseconds of each other are passed to the network layer once
+#ifndef LON_NI_DUPLICATE_WINDOW
+#define LON_NI_DUPLICATE_WINDOW 50
+#endif
+// Number of recent uplink frames remembered for duplicate detection
+#ifndef LON_NI_DUPLICATE_HISTORY
+#define LON_NI_DUPLICATE_HISTORY 16
+#endif
+
+// Recently received uplink frame
+typedef struct {
+    uint32_t hash;       // FNV-1a hash of the NPDU
+    IzotUbits16 size;    // NPDU size
+    int niIndex;         // Interface that received the frame first
+    OsalTickCount time;  // Time of the last copy from that interface
+} LonNiRecentFrame;
+
+static LonNiRecentFrame lonNiRecent[LON_NI_DUPLICATE_HISTORY];
+static int lonNiRecentNext = 0;
+static int lonNiLastSent = 0;  // Interface used for the last downlink frame
+#endif  // LINK_IS(MULTIPLE_USB_MIPS) && LON_NI_BONDING
+
 #define LNM_TAG 0x0F  // Tag reserved for local network management
 
 /*****************************************************************
@@ -125,7 +152,7 @@ LonStatusCode LinkLayerReset(void)
         gp->resetOk = FALSE;
         return status;
     }
-    gp->lkInQ = OsalAllocateMemory((size_t)(gp->lkInBufSize * gp->lkInQCnt));
+    gp->lkInQ = StackArenaAllocate((size_t)(gp->lkInBufSize * gp->lkInQCnt));
     if (gp->lkInQ == NULL) {
         OsalPrintLog(ERROR_LOG, LonStatusNoMemoryAvailable,
                 "LinkLayerReset: Unable to initialize the input queue");
@@ -154,7 +181,7 @@ LonStatusCode LinkLayerReset(void)
         return status;
     }
     queueItemSize = gp->lkOutBufSize + sizeof(LKSendParam);
-    status = QueueInit(&gp->lkOutQ, "link layer output", queueItemSize, gp->lkOutQCnt);
+    status = StackQueueInit(&gp->lkOutQ, "link layer output", queueItemSize, gp->lkOutQCnt);
     if (status != LonStatusNoError) {
         OsalPrintLog(ERROR_LOG, status,
                 "LinkLayerReset: Unable to initialize the output queue");
@@ -171,7 +198,7 @@ LonStatusCode LinkLayerReset(void)
         return status;
     }
     queueItemSize = gp->lkOutPriBufSize + sizeof(LKSendParam);
-    if (!LON_SUCCESS(status = QueueInit(&gp->lkOutPriQ, "link layer priority output",
+    if (!LON_SUCCESS(status = StackQueueInit(&gp->lkOutPriQ, "link layer priority output",
                              queueItemSize, gp->lkOutPriQCnt))) {
         OsalPrintLog(ERROR_LOG, status,
                 "LinkLayerReset: Unable to initialize the priority output queue");
@@ -210,6 +237,90 @@ LonStatusCode LinkLayerReset(void)
     return status;
 }
 
+#if LINK_IS(MULTIPLE_USB_MIPS) && LON_NI_BONDING
+/*
+ * Chooses the bonded LON interface for the next downlink frame.
+ * Parameters:
+ *   excluded: bit mask of lonNi[] indices not to choose
+ * Returns:
+ *   Index into lonNi[] of the ready interface with the least expected wait,
+ *   or -1 if no interface is ready
+ * Notes:
+ *   The expected wait of an interface is its downlink queue depth plus one,
+ *   times its average ack latency plus one.  Interfaces are checked starting
+ *   after the one used last, so equally loaded interfaces take turns.  An
+ *   interface that is no longer ready is skipped from the next frame on.
+ */
+static int LKChooseBondedNi(unsigned excluded)
+{
+    int niIndex, i, best = -1;
+    uint32_t cost, bestCost = UINT32_MAX;
+    size_t queued;
+    OsalTickCount latency;
+
+    for (i = 1; i <= NUM_LON_NI; i++) {
+        niIndex = (lonNiLastSent + i) % NUM_LON_NI;
+        if ((excluded & (1u << niIndex)) || !lonNi[niIndex].linkOpened ||
+                !LonUsbLinkReady(lonNi[niIndex].iface_index) ||
+                GetLonUsbLinkLoad(lonNi[niIndex].iface_index, &queued, &latency) !=
+                        LonStatusNoError) {
+            continue;
+        }
+        cost = (uint32_t)(queued + 1) * (uint32_t)(latency + 1);
+        if (cost < bestCost) {
+            bestCost = cost;
+            best = niIndex;
+        }
+    }
+    return best;
+}
+
+/*
+ * Checks if an uplink frame is a copy of one received through another
+ * bonded LON interface.
+ * Parameters:
+ *   niIndex: index into lonNi[] of the interface that received the frame
+ *   npduPtr: the NPDU of the frame
+ *   npduSize: size of the NPDU
+ * Returns:
+ *   true if the same NPDU was received through another interface within
+ *   LON_NI_DUPLICATE_WINDOW milliseconds; false otherwise
+ * Notes:
+ *   A frame received again through the interface that received it first
+ *   is a repeat sent by its source, and is not a duplicate.
+ */
+static bool LKDuplicateFrame(int niIndex, const IzotByte *npduPtr, IzotUbits16 npduSize)
+{
+    OsalTickCount now = OsalGetTickCount();
+    uint32_t hash = 2166136261u;
+    LonNiRecentFrame *recent;
+    IzotUbits16 i;
+    int k;
+
+    for (i = 0; i < npduSize; i++) {
+        hash = (hash ^ npduPtr[i]) * 16777619u;
+    }
+    for (k = 0; k < LON_NI_DUPLICATE_HISTORY; k++) {
+        recent = &lonNiRecent[k];
+        if (recent->size == npduSize && recent->hash == hash &&
+                now - recent->time <= LON_NI_DUPLICATE_WINDOW) {
+            if (recent->niIndex != niIndex) {
+                return true;
+            }
+            recent->time = now;
+            return false;
+        }
+    }
+    recent = &lonNiRecent[lonNiRecentNext];
+    recent->hash = hash;
+    recent->size = npduSize;
+    recent->niIndex = niIndex;
+    recent->time = now;
+    lonNiRecentNext = (lonNiRecentNext + 1) % LON_NI_DUPLICATE_HISTORY;
+    return false;
+}
+#endif  // LINK_IS(MULTIPLE_USB_MIPS) && LON_NI_BONDING
+
 /*
  * Receives an NPDU from the network layer and sends it to all LON USB interfaces.
  * Parameters:
@@ -233,6 +344,9 @@ void LinkLayerUsbSend(void)
     bool priority;
     LonDataFrame sicb;
     int niIndex;
+#if LINK_IS(MULTIPLE_USB_MIPS) && LON_NI_BONDING
+    unsigned excluded = 0;  // Interfaces that refused the LPDU
+#endif  // LINK_IS(MULTIPLE_USB_MIPS) && LON_NI_BONDING
     static OsalTickCount last_report_time = 0;
     if (OsalGetTickCount() - last_report_time > 1000) {
         last_report_time = OsalGetTickCount();
@@ -293,6 +407,17 @@ void LinkLayerUsbSend(void)
     if (LonUsbLinkReady()) {
         WriteLonUsbMsg(&sicb);
     }
+#elif LINK_IS(MULTIPLE_USB_MIPS) && LON_NI_BONDING
+    // Send the LPDU through one bonded LON interface; fail over to the
+    // next best interface if it cannot take the LPDU
+    while ((niIndex = LKChooseBondedNi(excluded)) >= 0) {
+        if (WriteLonUsbMsg(lonNi[niIndex].iface_index, &sicb) == LonStatusNoError) {
+            lonNiLastSent = niIndex;
+            lonNi[niIndex].framesSent++;
+            break;
+        }
+        excluded |= 1u << niIndex;
+    }
 #elif LINK_IS(MULTIPLE_USB_MIPS)
     for (niIndex = 0; niIndex < NUM_LON_NI; niIndex++) {
         // Send pending downlink requests from the link layer output queue to NI downlink queue niIndex
@@ -342,6 +467,8 @@ void LinkLayerUsbReceive(void)
         }
         return;  // No message to process
     }
+    lpduSize = sicb.short_pdu_length;
+    lpduHeaderPtr = (LPDUHeader *)&sicb.pdu[0];
 #elif LINK_IS(MULTIPLE_USB_MIPS) || PHYSICAL_IS(LON_PL_PROXY)
     int niIndex;
 
@@ -403,10 +530,21 @@ void LinkLayerUsbReceive(void)
     }
 #endif  // LINK_IS(USB_MIP) or LINK_IS(MULTIPLE_USB_MIPS) or PHYSICAL_IS(LON_PL_PROXY)
 
+#if LINK_IS(MULTIPLE_USB_MIPS) && LON_NI_BONDING
+    // Drop a copy of a frame already received through another bonded interface
+    if (LKDuplicateFrame(niIndex, (IzotByte *)lpduHeaderPtr + 1, lpduSize - 3)) {
+        lonNi[niIndex].duplicates++;
+        return;
+    }
+#endif  // LINK_IS(MULTIPLE_USB_MIPS) && LON_NI_BONDING
+
     // CRC check was performed by the LON interface;
     // increment the valid packet received count
     INCR_STATS(LcsL2Rx);
-    if (QueueFull(&gp->nwInQ)) {
+    if (!NWAcceptFrame((IzotByte *)lpduHeaderPtr + 1, lpduSize - 3)) {
+        // Not addressed to this node--drop it without using a network
+        // layer input queue entry
+    } else if (QueueFull(&gp->nwInQ)) {
         // Network layer input queue is full--lose this packet
         INCR_STATS(LcsMissed);
     } else {
@@ -64,6 +64,7 @@
  */
 
 #include "lcs/lcs_netmgmt.h"
+#include "lcs/lcs_tsa.h"
 #include "izot/IzotApi.h"
 
 #if PROTOCOL_IS(LON_IPV4) || PROTOCOL_IS(LON_IPV6)
@@ -122,8 +123,24 @@ void ConfigureDmfWindow(const unsigned addr, const unsigned size)
  *   None
  * Returns: 
  *   None
+ * Notes:
+ *   Every configuration change ends with a call to this function, so it
+ *   also marks the bound output network variable list and the lookup
+ *   caches built from the configuration for rebuilding.  It also marks
+ *   the tables as changed, since HandleNM() and HandleND() only compare
+ *   the EEPROM data to decide whether to write the network image.
  */
-void RecomputeChecksum(void) { eep->configCheckSum = ComputeConfigCheckSum(); }
+void RecomputeChecksum(void)
+{
+    eep->configCheckSum = ComputeConfigCheckSum();
+    gp->tablesChanged = TRUE;
+    gp->nvOutBoundValid = FALSE;  // Bindings may have changed
+    gp->nvPollCacheValid = FALSE; // Selectors may have changed
+    gp->nwDomainMatchValid = FALSE; // Domains may have changed
+#if PHYSICAL_IS(LON_PL_PROXY)
+    gp->proxyForwardValid = FALSE;  // Subnets may have changed
+#endif
+}
 
 /*
  * Sends a manual Service request message.
@@ -138,7 +155,7 @@ LonStatusCode ManualServiceRequestMessage(void)
     NWSendParam *nwSendParamPtr;
     APDU *apduRespPtr;
 
-    if (QueueFull(&gp->nwOutQ)) {
+    if (!NWOutQAvailable(&gp->nwOutQ, NW_TX_NEW)) {
         status = LonStatusNoBufferAvailable;
         OsalPrintLog(ERROR_LOG, status,
                 "ManualServiceRequestMessage: No room for Service request message in "
@@ -172,7 +189,7 @@ LonStatusCode ManualServiceRequestMessage(void)
     memcpy(apduRespPtr->data, eep->readOnlyData.UniqueNodeId, IZOT_UNIQUE_ID_LENGTH);
     memcpy(&(apduRespPtr->data[IZOT_UNIQUE_ID_LENGTH]), eep->readOnlyData.ProgramId,
             IZOT_PROGRAM_ID_LENGTH);
-    QueueWrite(&gp->nwOutQ);
+    NWOutQWrite(&gp->nwOutQ, NW_TX_NEW);
     gp->manualServiceRequest = FALSE;
     return (LonStatusNoError);
 }
@@ -411,17 +428,53 @@ void HandleNMUpdateKey(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
         eep->domainTable[apduPtr->data[0]].Key[i] += apduPtr->data[i + 1];
     }
     RecomputeChecksum();
+    TSA_RefreshAuthKeySchedules();
     NMNDRespond(NM_MESSAGE, LonStatusNoError, appReceiveParamPtr, apduPtr);
 }
 
+/*******************************************************************************
+ Function:  NMUpdateAddressEntry
+ Purpose:   Update an address table entry for a network management message,
+            following the group membership of the entry on LON/IP.
+ *******************************************************************************/
+static LonStatusCode NMUpdateAddressEntry(const IzotAddress *addrEntryIn,
+        IzotUbits16 indexIn)
+{
+    LonStatusCode sts;
+    uint32_t oldaddr = 0, newaddr;
+    IzotByte removeFlag = 0;
+
+    //Backup old group id
+    if (IZOT_GET_ATTRIBUTE(gp->addrTable[indexIn].Group, IZOT_ADDRESS_GROUP_TYPE) ==
+            1) {
+        oldaddr = BROADCAST_PREFIX | 0x100 | gp->addrTable[indexIn].Group.Group;
+        removeFlag = 1;
+    }
+
+    sts = UpdateAddress(addrEntryIn, indexIn);
+
+#if LINK_IS(UDP)
+    // Get the new group id
+    newaddr = BROADCAST_PREFIX | 0x100 | gp->addrTable[indexIn].Group.Group;
+    if (IZOT_GET_ATTRIBUTE(gp->addrTable[indexIn].Group, IZOT_ADDRESS_GROUP_TYPE) ==
+                    1 &&
+            oldaddr != newaddr) {
+        if (removeFlag) {
+            RemoveIPMembership(oldaddr);
+        }
+        AddIpMembership(newaddr);
+    }
+#endif  // LINK_IS(UDP)
+
+    return sts;
+}
+
 /*******************************************************************************
  Purpose:   Handle incoming NM Update Address message.
  ******************************************************************************/
 void HandleNMUpdateAddr(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 {
     LonStatusCode sts = LonStatusInvalidOperation;
-    uint32_t oldaddr = 0, newaddr;
-    IzotByte removeFlag = 0;
     IzotUbits16 indexIn;
 
     /* Check for incorrect size. Not sure why IzotAddressUnassigned tolerates 
@@ -429,28 +482,13 @@ void HandleNMUpdateAddr(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
     if (appReceiveParamPtr->pduSize >=
             (apduPtr->data[1] == IzotAddressUnassigned ? 6 : 7)) {
         indexIn = apduPtr->data[0];
-
-        //Backup old group id
-        if (IZOT_GET_ATTRIBUTE(eep->addrTable[indexIn].Group, IZOT_ADDRESS_GROUP_TYPE) ==
-                1) {
-            oldaddr = BROADCAST_PREFIX | 0x100 | eep->addrTable[indexIn].Group.Group;
-            removeFlag = 1;
+        if (indexIn >= gp->addrTableSize) {
+            NMNDRespond(NM_MESSAGE, LonStatusInvalidAddrTableIndex, appReceiveParamPtr,
+                    apduPtr);
+            return;
         }
 
-        sts = UpdateAddress((const IzotAddress *)&apduPtr->data[1], apduPtr->data[0]);
-
-#if LINK_IS(UDP)
-        // Get the new group id
-        newaddr = BROADCAST_PREFIX | 0x100 | eep->addrTable[indexIn].Group.Group;
-        if (IZOT_GET_ATTRIBUTE(eep->addrTable[indexIn].Group, IZOT_ADDRESS_GROUP_TYPE) ==
-                        1 &&
-                oldaddr != newaddr) {
-            if (removeFlag) {
-                RemoveIPMembership(oldaddr);
-            }
-            AddIpMembership(newaddr);
-        }
-#endif  // LINK_IS(UDP)
+        sts = NMUpdateAddressEntry((const IzotAddress *)&apduPtr->data[1], indexIn);
 
         RecomputeChecksum();
     }
@@ -525,7 +563,7 @@ void HandleNMQueryNvCnfg(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 
     /* Fail if there is insufficient space to send the response */
     if ((n < nmp->nvTableSize && (1 + sizeof(NVStruct)) > gp->tsaRespBufSize) ||
-            (n >= nmp->nvTableSize && n < nmp->nvTableSize + NV_ALIAS_TABLE_SIZE &&
+            (n >= nmp->nvTableSize && n < nmp->nvTableSize + gp->nvAliasTableSize &&
                     (1 + sizeof(AliasStruct)) > gp->tsaRespBufSize)) {
         NMNDRespond(NM_MESSAGE, LonStatusBufferSizeTooSmall, appReceiveParamPtr, apduPtr);
         return;
@@ -544,14 +582,14 @@ void HandleNMQueryNvCnfg(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
     if (n < nmp->nvTableSize) {
         /* Copy the NVStruct entry */
         tsaSendParamPtr->apduSize = 1 + sizeof(NVStruct);
-        memcpy(apduRespPtr->data, &(eep->nvConfigTable[n]), sizeof(NVStruct));
+        memcpy(apduRespPtr->data, &(gp->nvConfigTable[n]), sizeof(NVStruct));
 
-    } else if (n < nmp->nvTableSize + NV_ALIAS_TABLE_SIZE) {
+    } else if (n < nmp->nvTableSize + gp->nvAliasTableSize) {
         /* Copy the alias table entry. */
         tsaSendParamPtr->apduSize = 1 + sizeof(AliasStruct);
         n = n - nmp->nvTableSize;
-        memcpy(&alias_config.nvConfig, &eep->nvAliasTable[n].Alias, sizeof(NVStruct));
-        alias_config.primary = eep->nvAliasTable[n].Primary;
+        memcpy(&alias_config.nvConfig, &gp->nvAliasTable[n].Alias, sizeof(NVStruct));
+        alias_config.primary = gp->nvAliasTable[n].Primary;
         alias_config.hostPrimary = 0xFFFF;
 
         memcpy(apduRespPtr->data, &alias_config, sizeof(AliasStruct));
@@ -613,17 +651,17 @@ void HandleNMNVFetch(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
     }
     if (n < nmp->nvTableSize) {
         /* Make sure there is sufficient space for the response. Else, fail. */
-        if (nmp->nvFixedTable[n].nvLength + i + 1 > gp->tsaRespBufSize) {
+        if (gp->nvFixedTable[n].nvLength + i + 1 > gp->tsaRespBufSize) {
             NMNDRespond(NM_MESSAGE, LonStatusBufferSizeTooSmall, appReceiveParamPtr,
                     apduPtr);
             return;
         }
 
-        IzotByte ndi[nmp->nvFixedTable[n].nvLength];
-        IzotPrepareNetworkData(ndi, n, nmp->nvFixedTable[n].nvLength,
-                (IzotByte *)nmp->nvFixedTable[n].nvAddress);
-        memcpy(&apduRespPtr->data[i], ndi, nmp->nvFixedTable[n].nvLength);
-        tsaSendParamPtr->apduSize = nmp->nvFixedTable[n].nvLength + i + 1;
+        IzotByte ndi[gp->nvFixedTable[n].nvLength];
+        IzotPrepareNetworkData(ndi, n, gp->nvFixedTable[n].nvLength,
+                (IzotByte *)gp->nvFixedTable[n].nvAddress);
+        memcpy(&apduRespPtr->data[i], ndi, gp->nvFixedTable[n].nvLength);
+        tsaSendParamPtr->apduSize = gp->nvFixedTable[n].nvLength + i + 1;
         apduRespPtr->code.allBits = NM_resp_success | NM_NV_FETCH;
         QueueWrite(tsaOutQPtr);
 
@@ -980,6 +1018,7 @@ void HandleNmeUpdateKey(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
             }
         }
         RecomputeChecksum();
+        TSA_RefreshAuthKeySchedules();
     }
     NMNDRespond(NM_MESSAGE, sts, appReceiveParamPtr, apduPtr);
 }
@@ -1012,7 +1051,7 @@ void HandleNmeInitConfig(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
         LCS_InitAlias();
 
         for (i = 0; i < nmp->nvTableSize; i++, selectorVal--) {
-            IzotDatapointConfig *p = &eep->nvConfigTable[i];
+            IzotDatapointConfig *p = &gp->nvConfigTable[i];
             IZOT_SET_ATTRIBUTE_P(p, IZOT_DATAPOINT_SELHIGH, (IzotByte)(selectorVal >> 8));
             p->SelectorLow = selectorVal & 0xFF;
             if (i / 8 < len) {
@@ -1050,7 +1089,7 @@ void HandleNmeUpdateNvCnfg(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
     /* Update nv config or alias table */
     if (n < nmp->nvTableSize) {
         if (appReceiveParamPtr->pduSize >= pduSize) {
-            memcpy(&eep->nvConfigTable[n], np, sizeof(IzotDatapointConfig));
+            memcpy(&gp->nvConfigTable[n], np, sizeof(IzotDatapointConfig));
         } else {
             /* Incorrect size */
             NMNDRespond(NM_MESSAGE, LonStatusInvalidMessageLength, appReceiveParamPtr,
@@ -1094,14 +1133,14 @@ void HandleNmeQueryNvCnfg(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
     n = (n << 8) | apduPtr->data[2];
 
     /* Fail if there is insufficient space to send the response */
-    if (n < nmp->nvTableSize && (1 + sizeof(IzotDatapointConfig)) > gp->tsaRespBufSize) {
+    if (n < nmp->nvTableSize && (1 + sizeof(query_nv_config)) > gp->tsaRespBufSize) {
         NMNDRespond(NM_MESSAGE, LonStatusBufferSizeTooSmall, appReceiveParamPtr, apduPtr);
         return;
     }
 
     if (n < nmp->nvTableSize) {
         query_nv_config.subcommand = apduPtr->data[0];
-        memcpy(&query_nv_config.nv_config, &eep->nvConfigTable[n],
+        memcpy(&query_nv_config.nv_config, &gp->nvConfigTable[n],
                 sizeof(IzotDatapointConfig));
 
         SendResponse(appReceiveParamPtr->reqId, NM_resp_success | NM_EXPANDED,
@@ -1133,10 +1172,12 @@ void HandleNmeUpdateNvAliasCnfg(APPReceiveParam *appReceiveParamPtr, APDU *apduP
 
     pduSize = sizeof(IzotAliasConfig) + 4;
 
-    if (n < nmp->nvTableSize + NV_ALIAS_TABLE_SIZE) {
+    /* The index is an alias table index, unlike the NM_UPDATE_NV_CNFG index
+        that follows the datapoint table */
+    if (n < gp->nvAliasTableSize) {
         /* Update the nv alias table */
         if (appReceiveParamPtr->pduSize >= pduSize) {
-            memcpy(&eep->nvAliasTable[n], (IzotAliasConfig *)(&apduPtr->data[3]),
+            memcpy(&gp->nvAliasTable[n], (IzotAliasConfig *)(&apduPtr->data[3]),
                     sizeof(IzotAliasConfig));
         } else {
             /* Incorrect size */
@@ -1147,7 +1188,7 @@ void HandleNmeUpdateNvAliasCnfg(APPReceiveParam *appReceiveParamPtr, APDU *apduP
     } else {
         /* Invalid nv table index */
         OsalPrintLog(ERROR_LOG, LonStatusInvalidDatapointIndex,
-                "HandleNmeUpdateNvAliasCnfg: Invalid NV index");
+                "HandleNmeUpdateNvAliasCnfg: Invalid alias index");
         NMNDRespond(NM_MESSAGE, LonStatusInvalidDatapointIndex, appReceiveParamPtr,
                 apduPtr);
         return;
@@ -1181,27 +1222,165 @@ void HandleNmeQueryNvAliasCnfg(APPReceiveParam *appReceiveParamPtr, APDU *apduPt
     n = (n << 8) | apduPtr->data[2];
 
     /* Fail if there is insufficient space to send the response */
-    if ((n >= nmp->nvTableSize && n < nmp->nvTableSize + NV_ALIAS_TABLE_SIZE &&
-                (1 + sizeof(IzotAliasConfig)) > gp->tsaRespBufSize)) {
+    if (n < gp->nvAliasTableSize &&
+            (1 + sizeof(query_alias_config)) > gp->tsaRespBufSize) {
         NMNDRespond(NM_MESSAGE, LonStatusBufferSizeTooSmall, appReceiveParamPtr, apduPtr);
         return;
     }
-    if (n < nmp->nvTableSize + NV_ALIAS_TABLE_SIZE) {
+    if (n < gp->nvAliasTableSize) {
         /* Copy the alias table entry. */
         query_alias_config.subcommand = apduPtr->data[0];
-        memcpy(&query_alias_config.alias_config, &eep->nvAliasTable[n],
+        memcpy(&query_alias_config.alias_config, &gp->nvAliasTable[n],
                 sizeof(IzotAliasConfig));
 
         SendResponse(appReceiveParamPtr->reqId, NM_resp_success | NM_EXPANDED,
                 sizeof(query_alias_config), (IzotByte *)&query_alias_config);
     } else {
         OsalPrintLog(ERROR_LOG, LonStatusInvalidDatapointIndex,
-                "HandleNmeQueryNvAliasCnfg: Invalid NV index");
+                "HandleNmeQueryNvAliasCnfg: Invalid alias index");
         NMNDRespond(NM_MESSAGE, LonStatusInvalidDatapointIndex, appReceiveParamPtr,
                 apduPtr);
     }
 }
 
+/*******************************************************************************
+ Function:  NmeConfigTable
+ Purpose:   Return the entries, entry count and entry size of the table
+            selected by an NME_QUERY_CONFIG_RANGE or NME_UPDATE_CONFIG_RANGE
+            message, or NULL for an unknown table.
+ *******************************************************************************/
+static IzotByte *NmeConfigTable(IzotByte tableIn, IzotUbits16 *countOut,
+        IzotUbits16 *entrySizeOut)
+{
+    switch (tableIn) {
+    case NME_CONFIG_TABLE_NV:
+        *countOut = nmp->nvTableSize;
+        *entrySizeOut = sizeof(IzotDatapointConfig);
+        return (IzotByte *)gp->nvConfigTable;
+    case NME_CONFIG_TABLE_ALIAS:
+        *countOut = gp->nvAliasTableSize;
+        *entrySizeOut = sizeof(IzotAliasConfig);
+        return (IzotByte *)gp->nvAliasTable;
+    case NME_CONFIG_TABLE_ADDRESS:
+        *countOut = gp->addrTableSize;
+        *entrySizeOut = sizeof(IzotAddress);
+        return (IzotByte *)gp->addrTable;
+    default:
+        return NULL;
+    }
+}
+
+/*******************************************************************************
+ Function:  HandleNmeQueryConfigRange
+ Purpose:   Handle incoming NM Expanded query of a range of datapoint, alias
+            or address table entries.
+ Comments:  The request is the subcommand, the table, the 16-bit index of
+            the first entry and the number of entries.  The response repeats
+            the subcommand, table and index, followed by the number of
+            entries returned and the entries.  Fewer entries than requested
+            are returned at the end of the table or when the response buffer
+            is full, so a tool reads a table by continuing after the last
+            entry returned.
+ *******************************************************************************/
+void HandleNmeQueryConfigRange(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
+{
+    IzotByte response[MAX_DATA_SIZE];
+    IzotByte *table;
+    IzotUbits16 start, count, tableCount, entrySize, fit;
+    int respSize;
+
+    /* Fail if the request does not have correct size */
+    if (appReceiveParamPtr->pduSize != 6) {
+        NMNDRespond(NM_MESSAGE, LonStatusInvalidMessageLength, appReceiveParamPtr,
+                apduPtr);
+        return;
+    }
+
+    start = (IzotUbits16)apduPtr->data[2];
+    start = (start << 8) | apduPtr->data[3];
+    count = apduPtr->data[4];
+    table = NmeConfigTable(apduPtr->data[1], &tableCount, &entrySize);
+    if (table == NULL || start >= tableCount) {
+        OsalPrintLog(ERROR_LOG, LonStatusInvalidParameter,
+                "HandleNmeQueryConfigRange: Invalid table or index");
+        NMNDRespond(NM_MESSAGE, LonStatusInvalidParameter, appReceiveParamPtr,
+                apduPtr);
+        return;
+    }
+
+    /* Return as many entries as fit in the response buffer, which also holds
+        the APDU code ahead of the 5 byte header */
+    respSize = gp->tsaRespBufSize < 1 + sizeof(response) ? gp->tsaRespBufSize
+                                                         : 1 + sizeof(response);
+    fit = (IzotUbits16)(respSize < 6 ? 0 : (respSize - 6) / entrySize);
+    if (fit == 0) {
+        NMNDRespond(NM_MESSAGE, LonStatusBufferSizeTooSmall, appReceiveParamPtr, apduPtr);
+        return;
+    }
+    count = count < fit ? count : fit;
+    count = count < tableCount - start ? count : tableCount - start;
+
+    memcpy(response, apduPtr->data, 4);
+    response[4] = (IzotByte)count;
+    memcpy(&response[5], &table[start * entrySize], count * entrySize);
+    SendResponse(appReceiveParamPtr->reqId, NM_resp_success | NM_EXPANDED,
+            5 + count * entrySize, response);
+}
+
+/*******************************************************************************
+ Function:  HandleNmeUpdateConfigRange
+ Purpose:   Handle incoming NM Expanded update of a range of datapoint, alias
+            or address table entries.
+ Comments:  The request is the subcommand, the table, the 16-bit index of
+            the first entry, the number of entries and the entries.  Either
+            all entries are written or none are.  The checksum is recomputed
+            once for the range, and HandleNM() persists the network image
+            once for the message.
+ *******************************************************************************/
+void HandleNmeUpdateConfigRange(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
+{
+    const IzotByte *entries = &apduPtr->data[5];
+    IzotByte *table;
+    IzotUbits16 start, count, tableCount, entrySize, i;
+    LonStatusCode sts = LonStatusNoError;
+
+    if (appReceiveParamPtr->pduSize < 6) {
+        NMNDRespond(NM_MESSAGE, LonStatusInvalidMessageLength, appReceiveParamPtr,
+                apduPtr);
+        return;
+    }
+
+    start = (IzotUbits16)apduPtr->data[2];
+    start = (start << 8) | apduPtr->data[3];
+    count = apduPtr->data[4];
+    table = NmeConfigTable(apduPtr->data[1], &tableCount, &entrySize);
+    if (table == NULL || start >= tableCount || count > tableCount - start) {
+        OsalPrintLog(ERROR_LOG, LonStatusInvalidParameter,
+                "HandleNmeUpdateConfigRange: Invalid table or index");
+        NMNDRespond(NM_MESSAGE, LonStatusInvalidParameter, appReceiveParamPtr,
+                apduPtr);
+        return;
+    }
+    if (appReceiveParamPtr->pduSize != 6 + count * entrySize) {
+        NMNDRespond(NM_MESSAGE, LonStatusInvalidMessageLength, appReceiveParamPtr,
+                apduPtr);
+        return;
+    }
+
+    if (apduPtr->data[1] == NME_CONFIG_TABLE_ADDRESS) {
+        for (i = 0; i < count && sts == LonStatusNoError; i++) {
+            sts = NMUpdateAddressEntry((const IzotAddress *)&entries[i * entrySize],
+                    start + i);
+        }
+    } else {
+        memcpy(&table[start * entrySize], entries, count * entrySize);
+    }
+
+    /* Recompute checksum and send response */
+    RecomputeChecksum();
+    NMNDRespond(NM_MESSAGE, sts, appReceiveParamPtr, apduPtr);
+}
+
 /*******************************************************************************
  Function:  HandleNmeQueryLonUdpAddrMapping
  Purpose:   Handle incoming query mapping table message
@@ -1342,9 +1521,9 @@ void HandleNmeUpdateNvByIndex(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr
         IzotByte arg1 = 0;
         IzotByte arg2 = 0;
 
-        if (izot_dp_prop[matchingPrimaryIndex].ibolSeq) {
+        if (gp->dpProp[matchingPrimaryIndex].ibolSeq) {
             int byte_index = 0;
-            const IzotByte *ibol_seq = izot_dp_prop[matchingPrimaryIndex].ibolSeq;
+            const IzotByte *ibol_seq = gp->dpProp[matchingPrimaryIndex].ibolSeq;
 
             IzotNdiToHdi(&apduPtr->data[3], hdi, ibol_seq);
             dplength = 0;  //Back to zero , updating as per original structured size
@@ -1396,7 +1575,7 @@ void HandleNmeUpdateNvByIndex(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr
             }
 
             IzotDatapointUpdateOccurred(matchingPrimaryIndex, &(gp->nvInAddr));
-            if (IZOT_GET_ATTRIBUTE(izot_dp_prop[matchingPrimaryIndex],
+            if (IZOT_GET_ATTRIBUTE(gp->dpProp[matchingPrimaryIndex],
                         IZOT_DATAPOINT_PERSIST)) {
                 LCS_WritePersistentAppData();
             }
@@ -1451,6 +1630,12 @@ void HandleNMExpanded(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
         case NME_QUERY_NV_ALIAS_CONFIG:
             HandleNmeQueryNvAliasCnfg(appReceiveParamPtr, apduPtr);
             break;
+        case NME_QUERY_CONFIG_RANGE:
+            HandleNmeQueryConfigRange(appReceiveParamPtr, apduPtr);
+            break;
+        case NME_UPDATE_CONFIG_RANGE:
+            HandleNmeUpdateConfigRange(appReceiveParamPtr, apduPtr);
+            break;
 #if LINK_IS(UDP)
         case NME_QUERY_LS_ADDR_MAPPING_ANNOUNCEMENT:
             HandleNmeQueryLonUdpAddrMapping(appReceiveParamPtr, apduPtr);
@@ -1682,7 +1867,7 @@ void HandleNMQueryId(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
  *******************************************************************************/
 void HandleNMUpdateGroupAddr(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 {
-    IzotByte addrIndex = 0;
+    IzotUbits16 addrIndex = ADDR_INDEX_NONE;
     IzotAddressTableGroup *groupStrPtr;
     IzotAddress *ap;
 
@@ -1716,7 +1901,7 @@ void HandleNMUpdateGroupAddr(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 
     /* Make sure we got a good index. */
     if (IZOT_GET_ATTRIBUTE_P(groupStrPtr, IZOT_ADDRESS_GROUP_TYPE) != 1 ||
-            addrIndex == 0xFF) {
+            addrIndex == ADDR_INDEX_NONE) {
         NMNDRespond(NM_MESSAGE, LonStatusInvalidMessageAddress, appReceiveParamPtr,
                 apduPtr);
         return;
@@ -1813,16 +1998,16 @@ void HandleNMUpdateNvConfig(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
     /* Update nv config or alias table */
     if (n < nmp->nvTableSize) {
         if (appReceiveParamPtr->pduSize >= pduSize) {
-            memcpy(&eep->nvConfigTable[n], np, sizeof(NVStruct));
-            IZOT_SET_ATTRIBUTE(eep->nvConfigTable[n], IZOT_DATAPOINT_ADDRESS_HIGH, 0x0);
-            IZOT_SET_ATTRIBUTE(eep->nvConfigTable[n], IZOT_DATAPOINT_AES, 0x0);
+            memcpy(&gp->nvConfigTable[n], np, sizeof(NVStruct));
+            IZOT_SET_ATTRIBUTE(gp->nvConfigTable[n], IZOT_DATAPOINT_ADDRESS_HIGH, 0x0);
+            IZOT_SET_ATTRIBUTE(gp->nvConfigTable[n], IZOT_DATAPOINT_AES, 0x0);
         } else {
             /* Incorrect size */
             NMNDRespond(NM_MESSAGE, LonStatusInvalidMessageLength, appReceiveParamPtr,
                     apduPtr);
             return;
         }
-    } else if (n < nmp->nvTableSize + NV_ALIAS_TABLE_SIZE) {
+    } else if (n < nmp->nvTableSize + gp->nvAliasTableSize) {
         n = n - nmp->nvTableSize; /* Alias table index */
         /* Check for various forms of alias update */
         if (((AliasStruct *)np)->primary == 0xFF &&
@@ -1835,12 +2020,12 @@ void HandleNMUpdateNvConfig(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
         }
         /* Update the nv alias table */
         if (appReceiveParamPtr->pduSize >= pduSize) {
-            memcpy(&eep->nvAliasTable[n].Alias, &((AliasStruct *)np)->nvConfig,
+            memcpy(&gp->nvAliasTable[n].Alias, &((AliasStruct *)np)->nvConfig,
                     sizeof(NVStruct));
-            IZOT_SET_ATTRIBUTE(eep->nvAliasTable[n].Alias, IZOT_DATAPOINT_ADDRESS_HIGH,
+            IZOT_SET_ATTRIBUTE(gp->nvAliasTable[n].Alias, IZOT_DATAPOINT_ADDRESS_HIGH,
                     0x00);
-            IZOT_SET_ATTRIBUTE(eep->nvAliasTable[n].Alias, IZOT_DATAPOINT_AES, 0x00);
-            eep->nvAliasTable[n].Primary = (IzotUbits16)(((AliasStruct *)np)->primary);
+            IZOT_SET_ATTRIBUTE(gp->nvAliasTable[n].Alias, IZOT_DATAPOINT_AES, 0x00);
+            gp->nvAliasTable[n].Primary = (IzotUbits16)(((AliasStruct *)np)->primary);
         } else {
             /* Incorrect size */
             NMNDRespond(NM_MESSAGE, LonStatusInvalidMessageLength, appReceiveParamPtr,
@@ -2441,6 +2626,8 @@ void HandleNDClearStatus(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 {
     /* Clear status */
     memset(&nmp->stats, 0, sizeof(nmp->stats));
+    memset(gp->nwTxStats, 0, sizeof(gp->nwTxStats));
+    gp->nwRxFiltered = 0;
     nmp->resetCause = IzotResetCleared;
     eep->errorLog = LonStatusNoError; /* Cleared */
 
@@ -2550,7 +2737,7 @@ void HandleND(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
     }
 
     // Persist any changes to NVM
-    if (memcmp(&save, eep, sizeof(save))) {
+    if (gp->tablesChanged || memcmp(&save, eep, sizeof(save))) {
         LCS_WritePersistentNetworkImage();
     }
 
@@ -2698,7 +2885,7 @@ void HandleNM(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
     }
 
     // Persist any changes to NVM
-    if (memcmp(&save, eep, sizeof(save))) {
+    if (gp->tablesChanged || memcmp(&save, eep, sizeof(save))) {
         LCS_WritePersistentNetworkImage();
     }
 
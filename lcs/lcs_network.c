@@ -43,6 +43,8 @@ extern IzotByte NmAuth;
  *****************************************************************/
 
 static IzotByte DecodeDomainLength(IzotByte lengthCode);
+static void NWTxRefillCredits(void);
+static void NWBuildDomainMatch(void);
 LonStatusCode EncodeDomainLength(IzotByte length, IzotByte *pValue);
 
 /*****************************************************************
@@ -79,7 +81,7 @@ LonStatusCode NetworkLayerReset(void)
     }
     queueItemSize = gp->nwInBufSize + sizeof(NWReceiveParam);
 
-    if (!LON_SUCCESS(status = QueueInit(&gp->nwInQ, "network layer input", queueItemSize,
+    if (!LON_SUCCESS(status = StackQueueInit(&gp->nwInQ, "network layer input", queueItemSize,
                              gp->nwInQCnt))) {
         gp->resetOk = FALSE;
         OsalPrintLog(ERROR_LOG, status,
@@ -106,7 +108,7 @@ LonStatusCode NetworkLayerReset(void)
         return status;
     }
 
-    if (!LON_SUCCESS(status = QueueInit(&gp->nwOutQ, "network layer output",
+    if (!LON_SUCCESS(status = StackQueueInit(&gp->nwOutQ, "network layer output",
                              queueItemSize, gp->nwOutQCnt))) {
         gp->resetOk = FALSE;
         OsalPrintLog(ERROR_LOG, status,
@@ -136,13 +138,17 @@ LonStatusCode NetworkLayerReset(void)
         return status;
     }
 
-    if (!LON_SUCCESS(status = QueueInit(&gp->nwOutPriQ, "network layer priority output",
+    if (!LON_SUCCESS(status = StackQueueInit(&gp->nwOutPriQ, "network layer priority output",
                              queueItemSize, gp->nwOutPriQCnt))) {
         gp->resetOk = FALSE;
         OsalPrintLog(ERROR_LOG, status,
                 "NetworkLayerReset: Unable to initialize the priority output queue");
         return status;
     }
+    gp->nwTxWaiting = 0;
+    gp->nwTxWaitingLast = 0;
+    NWTxRefillCredits();
+    gp->nwDomainMatchValid = FALSE;
     OsalPrintLog(INFO_LOG, status, "NetworkLayerReset: Network layer queues initialized");
     return status;
 }
@@ -173,6 +179,172 @@ void NWSendTerminate(void)
     QueueDropHead(gp->nwCurrent);
 }
 
+/*******************************************************************************
+Function:  NWTxRefillCredits
+Returns:   None
+Purpose:   To give each class of nwOutQ traffic its weight in credits.
+*******************************************************************************/
+static void NWTxRefillCredits(void)
+{
+    gp->nwTxCredit[NW_TX_RESPONSE] = NW_TX_WEIGHT_RESPONSE;
+    gp->nwTxCredit[NW_TX_RETRY] = NW_TX_WEIGHT_RETRY;
+    gp->nwTxCredit[NW_TX_NEW] = NW_TX_WEIGHT_NEW;
+}
+
+/*******************************************************************************
+Function:  NWDomainKey
+Returns:   The domain match key of a domain.
+Purpose:   To pack a domain length and ID for NWDomainMatch.
+Comments:  lengthIn must not exceed IZOT_DOMAIN_ID_MAX_LENGTH.
+*******************************************************************************/
+static inline uint64_t NWDomainKey(IzotByte lengthIn, const IzotByte *idIn)
+{
+    uint64_t key = 0;
+    IzotByte *keyBytes = (IzotByte *)&key;
+
+    keyBytes[0] = lengthIn;
+    memcpy(&keyBytes[1], idIn, lengthIn);
+    return key;
+}
+
+/*******************************************************************************
+Function:  NWBuildDomainMatch
+Returns:   None
+Purpose:   To rebuild gp->nwDomainMatch from the domain and address tables.
+Comments:  Invalid domains, and the second domain of a node with one
+           domain, never match.
+*******************************************************************************/
+static void NWBuildDomainMatch(void)
+{
+    IzotByte numDomains = IZOT_GET_ATTRIBUTE(eep->readOnlyData, IZOT_READONLY_TWO_DOMAINS)
+                                  ? 2
+                                  : 1;
+    IzotByte i, length, group;
+    IzotUbits16 k;
+
+    memset(gp->nwDomainMatch, 0, sizeof(gp->nwDomainMatch));
+    for (k = 0; k < gp->addrTableSize; k++) {
+        if (IZOT_GET_ATTRIBUTE(gp->addrTable[k].Group, IZOT_ADDRESS_GROUP_TYPE) == 1) {
+            i = IZOT_GET_ATTRIBUTE(gp->addrTable[k].Group, IZOT_ADDRESS_GROUP_DOMAIN);
+            group = gp->addrTable[k].Group.Group;
+            gp->nwDomainMatch[i].groups[group / 8] |= 1 << (group % 8);
+        }
+    }
+    for (i = 0; i < MAX_DOMAINS; i++) {
+        length = IZOT_GET_ATTRIBUTE(eep->domainTable[i], IZOT_DOMAIN_ID_LENGTH);
+        if (i < numDomains && !IZOT_GET_ATTRIBUTE(eep->domainTable[i], IZOT_DOMAIN_INVALID) &&
+                length <= IZOT_DOMAIN_ID_MAX_LENGTH) {
+            gp->nwDomainMatch[i].key = NWDomainKey(length, eep->domainTable[i].Id);
+        } else {
+            gp->nwDomainMatch[i].key = NW_DOMAIN_NO_MATCH;
+        }
+        memcpy(gp->nwDomainMatch[i].subnetNode, &eep->domainTable[i].Subnet, 2);
+    }
+    gp->nwDomainMatchValid = TRUE;
+}
+
+/*******************************************************************************
+Function:  NWOutQAvailable
+Returns:   TRUE if the caller may write a message of the given class to
+           the network output queue now
+Purpose:   To decide which layer gets the next entry in nwOutQ.
+Comments:  The caller writes its message with NWOutQWrite(). The priority
+           queue, and nwOutQ with NW_TX_SCHEDULER_FIFO, only need a free
+           entry. With NW_TX_SCHEDULER_WEIGHTED, a class that is the only
+           one waiting takes any free entry. Otherwise a class without
+           credits waits while another waiting class has some left; when
+           none has, all credits are refilled from the NW_TX_WEIGHT values.
+           A class refused here is marked waiting, so it gets its turn even
+           if the queue is filled again before it asks next. nwTxStats
+           counts the attempts refused per class.
+*******************************************************************************/
+IzotByte NWOutQAvailable(Queue *nwQueuePtr, NWTxClass txClass)
+{
+    IzotByte classBit = (IzotByte)(1 << txClass);
+#if NW_TX_SCHEDULER == NW_TX_SCHEDULER_WEIGHTED
+    IzotByte others;
+    int i;
+#endif  // NW_TX_SCHEDULER == NW_TX_SCHEDULER_WEIGHTED
+
+    if (nwQueuePtr != &gp->nwOutQ) {
+        return !QueueFull(nwQueuePtr);
+    }
+    if (QueueFull(nwQueuePtr)) {
+        gp->nwTxWaiting |= classBit;
+        gp->nwTxStats[txClass].deferred++;
+        return FALSE;
+    }
+#if NW_TX_SCHEDULER == NW_TX_SCHEDULER_WEIGHTED
+    others = (gp->nwTxWaiting | gp->nwTxWaitingLast) & ~classBit;
+    if (others != 0) {
+        if (gp->nwTxCredit[txClass] == 0) {
+            for (i = 0; i < NW_TX_CLASS_COUNT; i++) {
+                if ((others & (1 << i)) && gp->nwTxCredit[i] != 0) {
+                    // Another waiting class has its turn
+                    gp->nwTxWaiting |= classBit;
+                    gp->nwTxStats[txClass].deferred++;
+                    return FALSE;
+                }
+            }
+            NWTxRefillCredits();
+        }
+    }
+#endif  // NW_TX_SCHEDULER == NW_TX_SCHEDULER_WEIGHTED
+    return TRUE;
+}
+
+/*******************************************************************************
+Function:  NWOutQWrite
+Returns:   None
+Purpose:   To write a message to a network output queue after
+           NWOutQAvailable() returned TRUE for its class.
+Comments:  Each message written to nwOutQ uses one of the class's credits
+           while another class is waiting, so a caller that finds it cannot
+           send after all, or that writes two messages, is charged for what
+           it actually writes. nwTxStats counts the messages queued per class.
+*******************************************************************************/
+void NWOutQWrite(Queue *nwQueuePtr, NWTxClass txClass)
+{
+    IzotByte classBit = (IzotByte)(1 << txClass);
+
+    QueueWrite(nwQueuePtr);
+    if (nwQueuePtr != &gp->nwOutQ) {
+        return;
+    }
+#if NW_TX_SCHEDULER == NW_TX_SCHEDULER_WEIGHTED
+    if (((gp->nwTxWaiting | gp->nwTxWaitingLast) & ~classBit) != 0 &&
+            gp->nwTxCredit[txClass] != 0) {
+        gp->nwTxCredit[txClass]--;
+    }
+#endif  // NW_TX_SCHEDULER == NW_TX_SCHEDULER_WEIGHTED
+    gp->nwTxWaiting &= (IzotByte)~classBit;
+    gp->nwTxStats[txClass].queued++;
+}
+
+/*******************************************************************************
+Function:  NWGetTxStats
+Returns:   None
+Purpose:   To read the nwOutQ transmit scheduling statistics.
+Comments:  txStatsOut receives NW_TX_CLASS_COUNT entries, indexed by class.
+           The statistics are cleared with the network diagnostics
+           statistics.
+*******************************************************************************/
+void NWGetTxStats(NWTxStats *txStatsOut)
+{
+    memcpy(txStatsOut, gp->nwTxStats, sizeof(gp->nwTxStats));
+}
+
+/*******************************************************************************
+Function:  NWGetRxFiltered
+Returns:   The number of NPDUs dropped by NWAcceptFrame()
+Purpose:   To read the link layer receive filter statistic.
+Comments:  The statistic is cleared with the network diagnostics statistics.
+*******************************************************************************/
+uint32_t NWGetRxFiltered(void)
+{
+    return gp->nwRxFiltered;
+}
+
 /*******************************************************************************
 Function:  NetworkLayerSend
 Returns:   None
@@ -201,6 +373,10 @@ void NetworkLayerSend(void)
 #if SECURITY_IS(V2)
     IzotByte priority;
 #endif  // SECURITY_IS(V2)
+    // Classes refused since the last pass stay waiting for one more pass
+    gp->nwTxWaitingLast = gp->nwTxWaiting;
+    gp->nwTxWaiting = 0;
+
     // Check if there is work to do and set pointers
     if (!QueueEmpty(&gp->nwOutPriQ) && !QueueFull(&gp->lkOutPriQ)) {
         // Process priority message if there is one and it can be processed
@@ -504,9 +680,9 @@ void NetworkLayerReceive(void)
     IzotByte *pduPtr;                             /* ptr to item in target queue. */
     IzotUbits16 pduSize;                          /* Size of enclosed PDU.        */
     IzotByte flexDomain;                          /* TRUE => NPDU in flexdomain.  */
-    IzotByte numDomains;                          /* # of domains of this node.   */
+    IzotByte configured;                          /* TRUE => node is configured.  */
     IzotByte domainLength;                        /* Domain length             */
-    IzotByte domainId[IZOT_DOMAIN_ID_MAX_LENGTH]; /* Temp.  */
+    uint64_t domainKey;                           /* See NWDomainKey().        */
     IzotByte uniqueNodeId[IZOT_UNIQUE_ID_LENGTH]; /* Temp.  */
     IzotReceiveSubnetNode destAddr;               /* Temp.                        */
     IzotByte j;                                   /* Temp.                        */
@@ -585,39 +761,28 @@ void NetworkLayerReceive(void)
     }
 
     /* domainLength is good. Safe to use memcpy now. */
-    memcpy(domainId, &npduPtr->data[j], domainLength);
+    domainKey = NWDomainKey(domainLength, &npduPtr->data[j]);
 
-    j += domainLength; /* Now j points to enclosed PDU. */
+    // Save the domain away regardless (used to only save the flex domain but always saving it is more general).
+    srcAddr.dmn.domainLen = domainLength;
+    memcpy(srcAddr.dmn.domainId, &npduPtr->data[j], domainLength);
 
-    /* Determine the number of domains for this node. */
-    if (IZOT_GET_ATTRIBUTE(eep->readOnlyData, IZOT_READONLY_TWO_DOMAINS)) {
-        numDomains = 2;
-    } else {
-        numDomains = 1;
-    }
+    j += domainLength; /* Now j points to enclosed PDU. */
 
     /* Check if the NPDU is received in flexDomain.
        If domainId does not match any of this node's domains,
        then the msg is said to have been received in flex domain. */
 
+    if (!gp->nwDomainMatchValid) {
+        NWBuildDomainMatch();
+    }
+    configured = NodeConfigured();
     flexDomain = FALSE; /* Assume it is not flex domain. */
 
-    // Save the domain away regardless (used to only save the flex domain but always saving it is more general).
-    srcAddr.dmn.domainLen = domainLength;
-    memcpy(srcAddr.dmn.domainId, domainId, domainLength);
-
-    if (NodeConfigured() &&
-            !IZOT_GET_ATTRIBUTE(eep->domainTable[0], IZOT_DOMAIN_INVALID) &&
-            domainLength ==
-                    IZOT_GET_ATTRIBUTE(eep->domainTable[0], IZOT_DOMAIN_ID_LENGTH) &&
-            memcmp(domainId, eep->domainTable[0].Id, domainLength) == 0) {
+    if (configured && domainKey == gp->nwDomainMatch[0].key) {
         /* Matches domainId in index 0 */
         srcAddr.dmn.domainIndex = 0;
-    } else if (NodeConfigured() && numDomains == 2 &&
-               !IZOT_GET_ATTRIBUTE(eep->domainTable[1], IZOT_DOMAIN_INVALID) &&
-               domainLength ==
-                       IZOT_GET_ATTRIBUTE(eep->domainTable[1], IZOT_DOMAIN_ID_LENGTH) &&
-               memcmp(domainId, eep->domainTable[1].Id, domainLength) == 0) {
+    } else if (configured && domainKey == gp->nwDomainMatch[1].key) {
         /* Matches domainId in index 1 */
         srcAddr.dmn.domainIndex = 1;
     } else {
@@ -626,11 +791,26 @@ void NetworkLayerReceive(void)
         flexDomain = TRUE;
     }
 
+    /* Drop packets received on flexDomain if the state
+       is not unconfigured and it is not Unique Node ID addressed. */
+    /* Unique Node ID addressed packets are always received. */
+    /* i.e if node is configured, flexdomain is not possible
+       unless it is Unique Node ID addressed. */
+
+    if (flexDomain && configured && srcAddr.addressMode != AM_UNIQUE_NODE_ID) {
+        /* Drop the packet. */
+        QueueDropHead(&gp->nwInQ);
+        OsalPrintLog(INFO_LOG, LonStatusNoError,
+                "NetworkLayerReceive: Discard flex domain packet that is not UID "
+                "addressed");
+        return;
+    }
+
     /* Determine if the packet was sent by myself. If so, drop. */
     /* We can do this check only in non-flexdomain as
        src subnet and node are 0 in flex domain. */
     if (!flexDomain &&
-            memcmp(&srcAddr.subnetAddr, &eep->domainTable[srcAddr.dmn.domainIndex].Subnet,
+            memcmp(&srcAddr.subnetAddr, gp->nwDomainMatch[srcAddr.dmn.domainIndex].subnetNode,
                     2) == 0 &&
             srcAddr.dmn.domainIndex != 1) {
         /* Not flex domain and source address matches */
@@ -645,8 +825,7 @@ void NetworkLayerReceive(void)
     switch (srcAddr.addressMode) {
     case AM_BROADCAST:
         if (!flexDomain && destAddr.Subnet != 0 &&
-                memcmp(&destAddr.Subnet,
-                        &eep->domainTable[srcAddr.dmn.domainIndex].Subnet, 1) != 0) {
+                destAddr.Subnet != gp->nwDomainMatch[srcAddr.dmn.domainIndex].subnetNode[0]) {
             /* Subnet broadcast and domain matches but destAddr does not. Not for us. */
             QueueDropHead(&gp->nwInQ);
             OsalPrintLog(INFO_LOG, LonStatusNoError,
@@ -667,7 +846,7 @@ void NetworkLayerReceive(void)
         break;
     case AM_SUBNET_NODE:
         if (!flexDomain &&
-                memcmp(&destAddr, &eep->domainTable[srcAddr.dmn.domainIndex].Subnet, 2) !=
+                memcmp(&destAddr, gp->nwDomainMatch[srcAddr.dmn.domainIndex].subnetNode, 2) !=
                         0) {
             QueueDropHead(&gp->nwInQ);
             OsalPrintLog(INFO_LOG, LonStatusNoError,
@@ -678,7 +857,7 @@ void NetworkLayerReceive(void)
     case AM_MULTICAST_ACK:
         /* Make sure the destination subnet/node matches. */
         if (!flexDomain &&
-                memcmp(&destAddr, &eep->domainTable[srcAddr.dmn.domainIndex].Subnet, 2) !=
+                memcmp(&destAddr, gp->nwDomainMatch[srcAddr.dmn.domainIndex].subnetNode, 2) !=
                         0) {
             QueueDropHead(&gp->nwInQ);
             OsalPrintLog(INFO_LOG, LonStatusNoError,
@@ -715,7 +894,7 @@ void NetworkLayerReceive(void)
 
     /* If a node is in unconfigured state,
        only broadcast and Unique ID messages can be received. */
-    if (!NodeConfigured() && srcAddr.addressMode != AM_BROADCAST &&
+    if (!configured && srcAddr.addressMode != AM_BROADCAST &&
             srcAddr.addressMode != AM_UNIQUE_NODE_ID) {
         /* Drop the packet. */
         QueueDropHead(&gp->nwInQ);
@@ -723,20 +902,6 @@ void NetworkLayerReceive(void)
                 "NetworkLayerReceive: Discard packet received while not configured");
         return;
     }
-    /* Drop packets received on flexDomain if the state
-       is not unconfigured and it is not Unique Node ID addressed. */
-    /* Unique Node ID addressed packets are always received. */
-    /* i.e if node is configured, flexdomain is not possible
-       unless it is Unique Node ID addressed. */
-
-    if (flexDomain && NodeConfigured() && srcAddr.addressMode != AM_UNIQUE_NODE_ID) {
-        /* Drop the packet. */
-        QueueDropHead(&gp->nwInQ);
-        OsalPrintLog(INFO_LOG, LonStatusNoError,
-                "NetworkLayerReceive: Discard flex domain packet that is not UID "
-                "addressed");
-        return;
-    }
     /* We have a packet that must be received. */
     INCR_STATS(LcsL3Rx);
 
@@ -838,6 +1003,115 @@ void NetworkLayerReceive(void)
     /* Should not come here. */
 }
 
+/*******************************************************************************
+Function:  NWAcceptFrame
+Returns:   FALSE if NetworkLayerReceive() would discard the NPDU because
+           it is not addressed to this node. TRUE, else.
+Purpose:   To let the link layer drop foreign traffic before it takes an
+           entry in gp->nwInQ.
+Comments:  npduIn is the NPDU as received, starting with the NPDU header
+           byte. Only the destination address and the domain are checked,
+           with the same rules as NetworkLayerReceive(), using
+           gp->nwDomainMatch. NPDUs too short to hold their address and
+           domain are accepted and left to NetworkLayerReceive() to
+           report. Each rejected NPDU is counted in gp->nwRxFiltered.
+*******************************************************************************/
+IzotByte NWAcceptFrame(const IzotByte *npduIn, IzotUbits16 npduSizeIn)
+{
+    const NPDU *npduPtr = (const NPDU *)npduIn;
+    const NWDomainMatch *match;
+    IzotReceiveSubnetNode srcSubnetNode;
+    IzotByte domainLength;
+    IzotByte group;
+    IzotByte j;
+
+    if (npduSizeIn < 1 + 3) {
+        return TRUE;
+    }
+    memcpy(&srcSubnetNode, npduPtr->data, 2);
+
+    /* Set j to the domain field's index. */
+    switch (npduPtr->addrFmt) {
+    case 0: /* Fall through. */
+    case 1:
+        j = 3;
+        break;
+    case 2:
+        j = IZOT_GET_ATTRIBUTE(srcSubnetNode, IZOT_RECEIVESN_SELFIELD) == 1 ? 4 : 6;
+        break;
+    default:
+        j = 3 + IZOT_UNIQUE_ID_LENGTH;
+        break;
+    }
+    domainLength = DecodeDomainLength(npduPtr->domainLength);
+    if (npduSizeIn < 1 + j + domainLength) {
+        return TRUE;
+    }
+
+    /* Unique Node ID addressed packets are received in any domain. */
+    if (npduPtr->addrFmt == 3) {
+        if (memcmp(&npduPtr->data[3], eep->readOnlyData.UniqueNodeId,
+                    IZOT_UNIQUE_ID_LENGTH) == 0) {
+            return TRUE;
+        }
+        gp->nwRxFiltered++;
+        return FALSE;
+    }
+
+    if (!gp->nwDomainMatchValid) {
+        NWBuildDomainMatch();
+    }
+    if (!NodeConfigured()) {
+        /* Only broadcasts are received in flex domain. */
+        if (npduPtr->addrFmt == 0) {
+            return TRUE;
+        }
+        gp->nwRxFiltered++;
+        return FALSE;
+    }
+    match = &gp->nwDomainMatch[0];
+    if (NWDomainKey(domainLength, &npduPtr->data[j]) != match->key) {
+        match = &gp->nwDomainMatch[1];
+        if (NWDomainKey(domainLength, &npduPtr->data[j]) != match->key) {
+            /* Flex domain packet for a configured node */
+            gp->nwRxFiltered++;
+            return FALSE;
+        }
+    } else if (memcmp(&srcSubnetNode, match->subnetNode, 2) == 0) {
+        /* Sent by this node */
+        gp->nwRxFiltered++;
+        return FALSE;
+    }
+
+    switch (npduPtr->addrFmt) {
+    case 0:
+        if (npduPtr->data[2] == 0 || npduPtr->data[2] == match->subnetNode[0]) {
+            return TRUE;
+        }
+        break;
+    case 1:
+        group = npduPtr->data[2];
+        if (match->groups[group / 8] & (1 << (group % 8))) {
+            return TRUE;
+        }
+        break;
+    default:
+        if (memcmp(&npduPtr->data[2], match->subnetNode, 2) == 0) {
+            if (j == 4) {
+                return TRUE;
+            }
+            /* Multicast acknowledgement; the group must match too. */
+            group = npduPtr->data[4];
+            if (match->groups[group / 8] & (1 << (group % 8))) {
+                return TRUE;
+            }
+        }
+        break;
+    }
+    gp->nwRxFiltered++;
+    return FALSE;
+}
+
 /*******************************************************************************
 Function:  DecodeDomainLength
 Returns:   Decoded value of domain length code.
@@ -27,12 +27,11 @@
  *          programs. A true multi-stack system needs some extra coding.
  */
 
+#include <stdlib.h>
+
 #include "lcs/lcs_node.h"
 #include "izot/IzotApi.h"
 
-static const Dimensions dimensions = {MAX_DOMAINS, NUM_ADDR_TBL_ENTRIES, NV_TABLE_SIZE,
-        NV_ALIAS_TABLE_SIZE};
-
 /*****************************************************************
  * Section: Globals
  *****************************************************************/
@@ -47,7 +46,6 @@ SNVTCapabilityInfo *snvt_capability_info;
 SIHeaderExt *si_header_ext;
 SNVTCapabilityInfo capability_info;
 SIHeaderExt header_ext;
-IzotDpProperty izot_dp_prop[NV_TABLE_SIZE];
 
 extern IzotByte DataPointCount;
 extern IzotByte AliasTableCount;
@@ -113,6 +111,7 @@ LonStatusCode UpdateDomain(const IzotDomain *domainInp, IzotByte indexIn,
         memcpy(&eep->domainTable[indexIn], domainInp,
                 includeKey ? sizeof(IzotDomain)
                            : sizeof(IzotDomain) - IZOT_AUTHENTICATION_KEY_LENGTH);
+        gp->nwDomainMatchValid = FALSE;
     } else {
         sts = LonStatusInvalidDomain;
     }
@@ -128,8 +127,8 @@ Comments:  None
 ******************************************************************/
 IzotAddress *AccessAddress(IzotUbits16 indexIn)
 {
-    if (indexIn < eep->readOnlyData.Extended) {
-        return (&eep->addrTable[indexIn]);
+    if (indexIn < gp->addrTableSize) {
+        return (&gp->addrTable[indexIn]);
     }
     return (NULL);
 }
@@ -144,8 +143,10 @@ LonStatusCode UpdateAddress(const IzotAddress *addrEntryInp, IzotUbits16 indexIn
 {
     LonStatusCode sts = LonStatusNoError;
 
-    if (indexIn < eep->readOnlyData.Extended) {
-        eep->addrTable[indexIn] = *addrEntryInp;
+    if (indexIn < gp->addrTableSize) {
+        gp->addrTable[indexIn] = *addrEntryInp;
+        gp->addrGroupIndexValid = FALSE;
+        gp->nwDomainMatchValid = FALSE;
     } else {
         OsalPrintLog(ERROR_LOG, LonStatusInvalidAddrTableIndex,
                 "UpdateAddress: Invalid address table index");
@@ -155,6 +156,92 @@ LonStatusCode UpdateAddress(const IzotAddress *addrEntryInp, IzotUbits16 indexIn
     return sts;
 }
 
+/*
+ * Returns the group index key of a group entry of the address table.
+ */
+static IzotUbits16 GroupKey(IzotUbits16 index)
+{
+    return (IzotUbits16)(IZOT_GET_ATTRIBUTE(gp->addrTable[index].Group,
+                                 IZOT_ADDRESS_GROUP_DOMAIN) << 8 |
+                         gp->addrTable[index].Group.Group);
+}
+
+/*
+ * Orders group entries by domain, group and address table index.
+ */
+static int CompareGroupEntries(const void *a, const void *b)
+{
+    IzotUbits16 indexA = *(const IzotUbits16 *)a;
+    IzotUbits16 indexB = *(const IzotUbits16 *)b;
+    int diff = GroupKey(indexA) - GroupKey(indexB);
+
+    return diff ? diff : indexA - indexB;
+}
+
+/*
+ * Rebuilds the group index of the address table.
+ * Parameters:
+ *   None
+ * Returns:
+ *   None
+ * Notes:
+ *   addrGroupIndex lists the address table index of every group entry,
+ *   ordered by domain, group and address table index, so that the
+ *   entries of one group can be found by a binary search.
+ */
+static void IndexAddressTable(void)
+{
+    IzotUbits16 i;
+
+    gp->addrGroupCount = 0;
+    for (i = 0; i < gp->addrTableSize; i++) {
+        if (IZOT_GET_ATTRIBUTE(gp->addrTable[i].Group, IZOT_ADDRESS_GROUP_TYPE) == 1) {
+            gp->addrGroupIndex[gp->addrGroupCount++] = i;
+        }
+    }
+    qsort(gp->addrGroupIndex, gp->addrGroupCount, sizeof(gp->addrGroupIndex[0]),
+            CompareGroupEntries);
+    gp->addrGroupIndexValid = TRUE;
+}
+
+/*
+ * Finds the address table entries of a group.
+ * Parameters:
+ *   domainIndexIn: Domain index of the group
+ *   groupIn: Group number
+ *   entriesOut: Set to the address table indices of the group entries in
+ *               ascending order; may be NULL
+ * Returns:
+ *   Number of address table entries for the group in the domain
+ */
+IzotUbits16 GroupAddrEntries(IzotByte domainIndexIn, IzotByte groupIn,
+        const IzotUbits16 **entriesOut)
+{
+    IzotUbits16 key = (IzotUbits16)(domainIndexIn << 8 | groupIn);
+    IzotUbits16 low = 0, high, mid, first;
+
+    if (!gp->addrGroupIndexValid) {
+        IndexAddressTable();
+    }
+    high = gp->addrGroupCount;
+    while (low < high) {
+        mid = (low + high) / 2;
+        if (GroupKey(gp->addrGroupIndex[mid]) < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    first = low;
+    while (low < gp->addrGroupCount && GroupKey(gp->addrGroupIndex[low]) == key) {
+        low++;
+    }
+    if (entriesOut) {
+        *entriesOut = &gp->addrGroupIndex[first];
+    }
+    return low - first;
+}
+
 /*****************************************************************
 Function:  IsGroupMember
 Returns:   TRUE if this node belongs to given group. FALSE, else.
@@ -162,28 +249,21 @@ Reference: None
 Purpose:   Checks if a node belongs to a given group in the
            given domain. If it does, also get the member number.
 Comments:  If groupMemberOut is NULL, then it is not used.
+           The member number comes from the first entry of
+           the group in the address table.
 ******************************************************************/
 IzotByte IsGroupMember(IzotByte domainIndexIn, IzotByte groupIn, IzotByte *groupMemberOut)
 {
+    const IzotUbits16 *entries;
     IzotUbits16 i;
 
-    for (i = 0; i < NUM_ADDR_TBL_ENTRIES; i++) {
-        if (IZOT_GET_ATTRIBUTE(eep->addrTable[i].Group, IZOT_ADDRESS_GROUP_TYPE) == 1) {
-
-            /* Group Format */
-            if (eep->addrTable[i].Group.Group == groupIn &&
-                    IZOT_GET_ATTRIBUTE(eep->addrTable[i].Group,
-                            IZOT_ADDRESS_GROUP_DOMAIN) == domainIndexIn) {
-                break;
-            }
-        }
-    }
-    if (i == NUM_ADDR_TBL_ENTRIES) {
+    if (GroupAddrEntries(domainIndexIn, groupIn, &entries) == 0) {
         return (FALSE); /* Not Found */
     }
+    i = entries[0];
     if (groupMemberOut) {
         *groupMemberOut =
-                IZOT_GET_ATTRIBUTE(eep->addrTable[i].Group, IZOT_ADDRESS_GROUP_MEMBER);
+                IZOT_GET_ATTRIBUTE(gp->addrTable[i].Group, IZOT_ADDRESS_GROUP_MEMBER);
     }
     return (TRUE); /* Found */
 }
@@ -191,27 +271,20 @@ IzotByte IsGroupMember(IzotByte domainIndexIn, IzotByte groupIn, IzotByte *group
 /*****************************************************************
 Function:  AddrTableIndex
 Returns:   The index of the address table for the given domain
-           and group. 0xFF if not found.
+           and group. ADDR_INDEX_NONE if not found.
 Reference: None
 Purpose:   Gets the addr table index for a given group and domain.
-           If there is no such entry in the addr table, return 0xff.
+           If there is no such entry in the addr table, return
+           ADDR_INDEX_NONE.
 ******************************************************************/
 IzotUbits16 AddrTableIndex(IzotByte domainIndexIn, IzotByte groupIn)
 {
-    IzotUbits16 i;
+    const IzotUbits16 *entries;
 
-    for (i = 0; i < NUM_ADDR_TBL_ENTRIES; i++) {
-        if (IZOT_GET_ATTRIBUTE(eep->addrTable[i].Group, IZOT_ADDRESS_GROUP_TYPE) == 1) {
-            /* Group Format */
-            if (eep->addrTable[i].Group.Group == groupIn &&
-                    IZOT_GET_ATTRIBUTE(eep->addrTable[i].Group,
-                            IZOT_ADDRESS_GROUP_DOMAIN) == domainIndexIn) {
-                return (i);
-            }
-        }
+    if (GroupAddrEntries(domainIndexIn, groupIn, &entries) == 0) {
+        return (ADDR_INDEX_NONE); /* Not Found */
     }
-
-    return (0xFF); /* Not Found */
+    return (entries[0]);
 }
 
 /*
@@ -325,7 +398,7 @@ Purpose:   Accesses the NV Config Table Entry given the index
 IzotDatapointConfig *AccessNV(IzotUbits16 indexIn)
 {
     if (indexIn < nmp->nvTableSize) {
-        return (&eep->nvConfigTable[indexIn]);
+        return (&gp->nvConfigTable[indexIn]);
     }
     OsalPrintLog(ERROR_LOG, LonStatusDpIndexInvalid, "AccessNV: Invalid index");
     return (NULL);
@@ -338,8 +411,8 @@ Purpose:   Accesses the Alias Config Table Entry given the index
 ******************************************************************/
 IzotAliasConfig *AccessAlias(IzotUbits16 indexIn)
 {
-    if (indexIn < NV_ALIAS_TABLE_SIZE) {
-        return (&eep->nvAliasTable[indexIn]);
+    if (indexIn < gp->nvAliasTableSize) {
+        return (&gp->nvAliasTable[indexIn]);
     }
     OsalPrintLog(ERROR_LOG, LonStatusDpIndexInvalid, "AccessAlias: Invalid index");
     return (NULL);
@@ -354,7 +427,7 @@ Purpose:   Updates an entry in the NV Config Table
 void UpdateNV(IzotDatapointConfig *nvStructInp, IzotUbits16 indexIn)
 {
     if (nvStructInp && indexIn < nmp->nvTableSize) {
-        eep->nvConfigTable[indexIn] = *nvStructInp;
+        gp->nvConfigTable[indexIn] = *nvStructInp;
         return;
     }
     if (nvStructInp) {
@@ -374,8 +447,8 @@ Purpose:   Updates an entry in Alias Config Table
 ******************************************************************/
 void UpdateAlias(IzotAliasConfig *aliasStructInp, IzotUbits16 indexIn)
 {
-    if (aliasStructInp && indexIn < NV_ALIAS_TABLE_SIZE) {
-        eep->nvAliasTable[indexIn] = *aliasStructInp;
+    if (aliasStructInp && indexIn < gp->nvAliasTableSize) {
+        gp->nvAliasTable[indexIn] = *aliasStructInp;
         return;
     }
     if (aliasStructInp) {
@@ -387,6 +460,219 @@ void UpdateAlias(IzotAliasConfig *aliasStructInp, IzotUbits16 indexIn)
     }
 }
 
+#if STACK_STATIC_ALLOCATION
+// Stack arena of each stack in the static build, with room to align its start
+static IzotByte stackArena[NUM_STACKS][STACK_ARENA_SIZE + STACK_ARENA_ALIGNMENT - 1];
+#endif
+
+/*
+ * Returns a pointer rounded up to the next STACK_ARENA_ALIGNMENT boundary.
+ */
+static IzotByte *ArenaAlign(void *ptr)
+{
+    uintptr_t addr = (uintptr_t)ptr;
+
+    return (IzotByte *)((addr + STACK_ARENA_ALIGNMENT - 1) &
+            ~(uintptr_t)(STACK_ARENA_ALIGNMENT - 1));
+}
+
+/*
+ * Prepares the stack arena for the layer resets.
+ * Parameters:
+ *   None
+ * Returns:
+ *   None
+ * Notes:
+ *   Frees the heap blocks used by the last reset when the arena was too
+ *   small, and reallocates the arena at the size that reset needed so
+ *   that all queues and receive records are contiguous again.  All
+ *   storage handed out by StackArenaAllocate() since the last reset is
+ *   reused, so each layer must reinitialize its queues on reset.
+ *   The static build always uses the static arena of the current stack.
+ */
+static void StackArenaRewind(void)
+{
+#if STACK_STATIC_ALLOCATION
+    gp->arena = ArenaAlign(stackArena[gp - protocolStackDataGbl]);
+    gp->arenaSize = STACK_ARENA_SIZE;
+#else
+    size_t size;
+
+    while (gp->arenaOverflow != NULL) {
+        void *next = *(void **)gp->arenaOverflow;
+        OsalFreeMemory(gp->arenaOverflow);
+        gp->arenaOverflow = next;
+    }
+    if (gp->arenaBlock == NULL || gp->arenaUsed > gp->arenaSize) {
+        size = gp->arenaUsed > STACK_ARENA_SIZE ? gp->arenaUsed : STACK_ARENA_SIZE;
+        if (gp->arenaBlock != NULL) {
+            OsalFreeMemory(gp->arenaBlock);
+        }
+        gp->arenaBlock = OsalAllocateMemory(size + STACK_ARENA_ALIGNMENT - 1);
+        gp->arena = gp->arenaBlock ? ArenaAlign(gp->arenaBlock) : NULL;
+        gp->arenaSize = gp->arenaBlock ? size : 0;
+    }
+#endif  // STACK_STATIC_ALLOCATION
+    gp->arenaUsed = 0;
+}
+
+/*
+ * Allocates storage for the life of the current reset from the stack arena.
+ * Parameters:
+ *   size: Number of bytes to allocate
+ * Returns:
+ *   Pointer to the storage aligned to STACK_ARENA_ALIGNMENT, or NULL if
+ *   no memory is available
+ * Notes:
+ *   The storage is reused by the next NodeReset() and must not be freed.
+ *   If the arena is full, the storage comes from the heap until the next
+ *   reset, which then grows the arena to fit.  The static build cannot
+ *   grow the arena and returns NULL instead.
+ */
+void *StackArenaAllocate(size_t size)
+{
+    size_t offset = gp->arenaUsed;
+#if !STACK_STATIC_ALLOCATION
+    IzotByte *block;
+#endif
+
+    size = (size + STACK_ARENA_ALIGNMENT - 1) & ~(size_t)(STACK_ARENA_ALIGNMENT - 1);
+    gp->arenaUsed += size;
+    if (gp->arena != NULL && offset + size <= gp->arenaSize) {
+        return gp->arena + offset;
+    }
+#if STACK_STATIC_ALLOCATION
+    OsalPrintLog(ERROR_LOG, LonStatusNoMemoryAvailable,
+            "StackArenaAllocate: %u bytes needed in the %u byte arena; increase STACK_ARENA_SIZE",
+            (unsigned)gp->arenaUsed, (unsigned)gp->arenaSize);
+    return NULL;
+#else
+    // Chain the heap block to the overflow list in front of the aligned storage
+    block = OsalAllocateMemory(sizeof(void *) + STACK_ARENA_ALIGNMENT - 1 + size);
+    if (block == NULL) {
+        return NULL;
+    }
+    *(void **)block = gp->arenaOverflow;
+    gp->arenaOverflow = block;
+    return ArenaAlign(block + sizeof(void *));
+#endif  // STACK_STATIC_ALLOCATION
+}
+
+/*
+ * Initializes a protocol stack queue with storage from the stack arena.
+ * Parameters:
+ *   queue_out: Pointer to the queue to initialize
+ *   queue_name: Name of the queue (for debugging); must be a constant string
+ *   entry_size: Size of each entry in the queue in bytes
+ *   queue_capacity: Capacity of the queue in entries
+ * Returns:
+ *   LonStatusNoError if successful; LonStatusCode error code otherwise
+ */
+LonStatusCode StackQueueInit(Queue *queue_out, char *queue_name, size_t entry_size,
+        size_t queue_capacity)
+{
+    return QueueInitStorage(queue_out, queue_name, entry_size, queue_capacity,
+            StackArenaAllocate(entry_size * queue_capacity));
+}
+
+// Rounds a table size up so that the next table is pointer aligned
+#define TABLE_ALIGN(size) (((size) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+#if NV_OUT_COALESCING
+#define TABLE_PENDING_SIZE(nv) TABLE_ALIGN(((nv) + 7) / 8)
+#else
+#define TABLE_PENDING_SIZE(nv) 0
+#endif
+
+// Size of the table block of a stack with the given table sizes
+#define TABLE_BLOCK_SIZE(addr, nv, alias)                                                \
+    (TABLE_ALIGN((nv) * sizeof(NVFixedStruct)) +                                         \
+     TABLE_ALIGN((addr) * sizeof(IzotAddress)) +                                         \
+     TABLE_ALIGN((addr) * sizeof(IzotUbits16)) +                                         \
+     TABLE_ALIGN((nv) * sizeof(IzotDatapointConfig)) +                                   \
+     TABLE_ALIGN((alias) * sizeof(IzotAliasConfig)) +                                    \
+     TABLE_ALIGN((nv) * sizeof(IzotDpProperty)) +                                        \
+     TABLE_ALIGN((nv) * sizeof(IzotBits16)) +                                            \
+     TABLE_ALIGN(((nv) + 1) * sizeof(IzotUbits16)) +                                     \
+     TABLE_ALIGN((alias) * sizeof(IzotBits16)) + TABLE_PENDING_SIZE(nv) + TABLE_ALIGN(nv))
+
+#if STACK_STATIC_ALLOCATION
+// Table blocks of the static build, sized for the largest tables
+static void *tableStorage[NUM_STACKS][(TABLE_BLOCK_SIZE(NUM_ADDR_TBL_ENTRIES, NV_TABLE_SIZE,
+        NV_ALIAS_TABLE_SIZE) + sizeof(void *) - 1) / sizeof(void *)];
+#endif
+
+/*
+ * Returns the next table from a table block and advances past it.
+ */
+static void *TableCarve(IzotByte **next, size_t size)
+{
+    void *table = *next;
+
+    *next += TABLE_ALIGN(size);
+    return table;
+}
+
+/*
+ * Allocates the address, datapoint and alias tables of the current stack.
+ * Parameters:
+ *   None
+ * Returns:
+ *   LonStatusNoError if successful; LonStatusCode error code otherwise
+ * Notes:
+ *   The tables are sized from the counts given to IzotCreateStack(), up to
+ *   NUM_ADDR_TBL_ENTRIES, NV_TABLE_SIZE and NV_ALIAS_TABLE_SIZE entries.
+ *   They are allocated and cleared once and keep their storage across
+ *   resets.  The static build uses static storage for the largest tables.
+ */
+static LonStatusCode InitTables(void)
+{
+    IzotByte *next;
+    size_t size;
+
+    if (gp->tableBlock != NULL) {
+        return LonStatusNoError;
+    }
+    gp->addrTableSize = cp->addressCnt < NUM_ADDR_TBL_ENTRIES ? cp->addressCnt
+                                                             : NUM_ADDR_TBL_ENTRIES;
+    gp->nvTableCapacity = cp->nvCnt < NV_TABLE_SIZE ? cp->nvCnt : NV_TABLE_SIZE;
+    gp->nvAliasTableSize = cp->aliasCnt < NV_ALIAS_TABLE_SIZE ? cp->aliasCnt
+                                                             : NV_ALIAS_TABLE_SIZE;
+    size = TABLE_BLOCK_SIZE(gp->addrTableSize, gp->nvTableCapacity, gp->nvAliasTableSize);
+#if STACK_STATIC_ALLOCATION
+    gp->tableBlock = tableStorage[gp - protocolStackDataGbl];
+#else
+    gp->tableBlock = OsalAllocateMemory(size);
+    if (gp->tableBlock == NULL) {
+        OsalPrintLog(ERROR_LOG, LonStatusNoMemoryAvailable,
+                "InitTables: No memory for %u bytes of tables", (unsigned)size);
+        return LonStatusNoMemoryAvailable;
+    }
+#endif  // STACK_STATIC_ALLOCATION
+    memset(gp->tableBlock, 0, size);
+
+    next = gp->tableBlock;
+    gp->nvFixedTable = TableCarve(&next, gp->nvTableCapacity * sizeof(NVFixedStruct));
+    gp->addrTable = TableCarve(&next, gp->addrTableSize * sizeof(IzotAddress));
+    gp->addrGroupIndex = TableCarve(&next, gp->addrTableSize * sizeof(IzotUbits16));
+    gp->nvConfigTable = TableCarve(&next, gp->nvTableCapacity * sizeof(IzotDatapointConfig));
+    gp->nvAliasTable = TableCarve(&next, gp->nvAliasTableSize * sizeof(IzotAliasConfig));
+    gp->dpProp = TableCarve(&next, gp->nvTableCapacity * sizeof(IzotDpProperty));
+    gp->nvOutBound = TableCarve(&next, gp->nvTableCapacity * sizeof(IzotBits16));
+    gp->nvOutBoundAliasStart =
+            TableCarve(&next, (gp->nvTableCapacity + 1) * sizeof(IzotUbits16));
+    gp->nvOutBoundAlias = TableCarve(&next, gp->nvAliasTableSize * sizeof(IzotBits16));
+#if NV_OUT_COALESCING
+    gp->nvOutPending = TableCarve(&next, (gp->nvTableCapacity + 7) / 8);
+#endif
+    gp->nvSendTimeSlot = TableCarve(&next, gp->nvTableCapacity);
+
+    OsalPrintLog(INFO_LOG, LonStatusNoError,
+            "InitTables: %u address, %u datapoint, and %u alias entries use %u bytes",
+            gp->addrTableSize, gp->nvTableCapacity, gp->nvAliasTableSize, (unsigned)size);
+    return LonStatusNoError;
+}
+
 /*
  * Resets the LON Stack data structures for all layers.
  * Parameters:
@@ -448,11 +734,8 @@ LonStatusCode NodeReset(IzotByte firstReset)
         gp->appPgmMode = OFF_LINE;
     }
 
-#if 0
-// TODO: make this conditional based on malloc support in OSAL
     /* First, let each layer determine the address of all its data structures */
-    gp->mallocUsedSize = 0;
-#endif
+    StackArenaRewind();
 
     /* Call all the Reset functions */
     fnsCnt = sizeof(resetFns) / sizeof(FnType);
@@ -468,6 +751,10 @@ LonStatusCode NodeReset(IzotByte firstReset)
     PHYInitSPM(firstReset);
 #endif  // LINK_IS(SPI_MIP)
 
+    OsalPrintLog(INFO_LOG, status, "NodeReset: Stack arena uses %u of %u bytes%s",
+            (unsigned)gp->arenaUsed, (unsigned)gp->arenaSize,
+            gp->arenaOverflow ? "; the arena will grow on the next reset" : "");
+
     if (firstReset) {
         memset(gp->prevChallenge, 0, sizeof(gp->prevChallenge));
     }
@@ -495,9 +782,19 @@ Comments:  Incomplete Initialization. Make sure it has the var you
 LonStatusCode InitEEPROM(uint32_t app_signature)
 {
     LonStatusCode status = LonStatusNoError;
+    Dimensions dimensions;
     int i;
 
     if (!gp->initialized) {
+        status = InitTables();
+        if (status != LonStatusNoError) {
+            return status;
+        }
+        dimensions.domain = MAX_DOMAINS;
+        dimensions.address = gp->addrTableSize;
+        dimensions.nv = (IzotByte)gp->nvTableCapacity;
+        dimensions.alias = (IzotByte)gp->nvAliasTableSize;
+
         // Initialize all of non-volatile memory (NVM) to zero
         memset(eep, 0, sizeof(*eep));
 
@@ -563,6 +860,7 @@ LonStatusCode InitEEPROM(uint32_t app_signature)
                         IZOT_AUTHENTICATION_KEY_LENGTH);
             }
             LCS_InitAddress();
+            memset(gp->nvConfigTable, 0, gp->nvTableCapacity * sizeof(IzotDatapointConfig));
             nmp->nvTableSize = 0;
             LCS_InitAlias();
             LCS_WritePersistentNetworkImage();
@@ -635,7 +933,7 @@ LonStatusCode InitEEPROM(uint32_t app_signature)
                 0);                                     /* Host based node */
         eep->readOnlyData.AliasCount = AliasTableCount; /* Host based node */
         eep->readOnlyData.DatapointCount = DataPointCount;
-        eep->readOnlyData.Extended = cp->addressCnt;
+        eep->readOnlyData.Extended = gp->addrTableSize < 0xFF ? gp->addrTableSize : 0xFF;
 // Record the dimensions uses for NVM.  If these change, we'll reset all the NVM
 #if LON_DMF_ENABLED
         IZOT_SET_ATTRIBUTE(eep->readOnlyData, IZOT_READONLY_DMF, 1);
@@ -665,7 +963,7 @@ LonStatusCode InitEEPROM(uint32_t app_signature)
         snvt_capability_info->mcnv_current_count = 0;
         snvt_capability_info->mcnv_max_index = 0;
         snvt_capability_info->dyn_fb_capacity = 0;
-        snvt_capability_info->eat_address_capacity = cp->addressCnt;
+        snvt_capability_info->eat_address_capacity = eep->readOnlyData.Extended;
     }
     return status;
 }
@@ -681,7 +979,7 @@ IzotBits16 GetPrimaryIndex(IzotBits16 nvIndex)
 {
     IzotBits16 primaryIndex;
 
-    if (nvIndex < 0 || nvIndex >= nmp->nvTableSize + NV_ALIAS_TABLE_SIZE) {
+    if (nvIndex < 0 || nvIndex >= nmp->nvTableSize + gp->nvAliasTableSize) {
         return (-1); /* Bad index value. */
     }
 
@@ -690,7 +988,7 @@ IzotBits16 GetPrimaryIndex(IzotBits16 nvIndex)
     } else {
         nvIndex = nvIndex - nmp->nvTableSize; /* Get alias table index. */
         /* Compute the primary index. */
-        primaryIndex = eep->nvAliasTable[nvIndex].Primary;
+        primaryIndex = gp->nvAliasTable[nvIndex].Primary;
 
         if (primaryIndex >= nmp->nvTableSize) {
             return (-1); /* Bad index in alias structure. */
@@ -708,15 +1006,15 @@ Comments:  The given index can be either primary or alias.
 ******************************************************************/
 IzotDatapointConfig *GetNVStructPtr(IzotBits16 nvIndexIn)
 {
-    if (nvIndexIn < 0 || nvIndexIn >= nmp->nvTableSize + NV_ALIAS_TABLE_SIZE) {
+    if (nvIndexIn < 0 || nvIndexIn >= nmp->nvTableSize + gp->nvAliasTableSize) {
         return (NULL); /* Bad index value. */
     }
 
     if (nvIndexIn < nmp->nvTableSize) {
-        return (&eep->nvConfigTable[nvIndexIn]);
+        return (&gp->nvConfigTable[nvIndexIn]);
     }
 
-    return (&eep->nvAliasTable[nvIndexIn - nmp->nvTableSize].Alias);
+    return (&gp->nvAliasTable[nvIndexIn - nmp->nvTableSize].Alias);
 }
 
 /*****************************************************************
@@ -755,9 +1053,63 @@ IzotByte ComputeConfigCheckSum(void)
 
     size = (char *)&eep->configCheckSum - (char *)&eep->configData;
     checkSum = CheckSum8((char *)&eep->configData, size);
+    checkSum ^= CheckSum8(gp->addrTable, gp->addrTableSize * sizeof(IzotAddress));
+    checkSum ^= CheckSum8(gp->nvConfigTable,
+            gp->nvTableCapacity * sizeof(IzotDatapointConfig));
+    checkSum ^= CheckSum8(gp->nvAliasTable, gp->nvAliasTableSize * sizeof(IzotAliasConfig));
     return (checkSum);
 }
 
+/*
+ * Returns the size of the configuration tables in the network image.
+ * Parameters:
+ *   None
+ * Returns:
+ *   Bytes of the address, datapoint configuration and alias tables
+ *   of the current stack
+ */
+size_t LCS_ConfigTablesSize(void)
+{
+    return gp->addrTableSize * sizeof(IzotAddress) +
+           gp->nvTableCapacity * sizeof(IzotDatapointConfig) +
+           gp->nvAliasTableSize * sizeof(IzotAliasConfig);
+}
+
+/*
+ * Copies the configuration tables into a network image.
+ * Parameters:
+ *   image: LCS_ConfigTablesSize() bytes for the address, datapoint
+ *          configuration and alias tables, in that order
+ * Returns:
+ *   None
+ */
+void LCS_SaveConfigTables(IzotByte *image)
+{
+    memcpy(image, gp->addrTable, gp->addrTableSize * sizeof(IzotAddress));
+    image += gp->addrTableSize * sizeof(IzotAddress);
+    memcpy(image, gp->nvConfigTable, gp->nvTableCapacity * sizeof(IzotDatapointConfig));
+    image += gp->nvTableCapacity * sizeof(IzotDatapointConfig);
+    memcpy(image, gp->nvAliasTable, gp->nvAliasTableSize * sizeof(IzotAliasConfig));
+}
+
+/*
+ * Copies the configuration tables from a network image.
+ * Parameters:
+ *   image: Tables written by LCS_SaveConfigTables() for the same table sizes
+ * Returns:
+ *   None
+ */
+void LCS_LoadConfigTables(const IzotByte *image)
+{
+    memcpy(gp->addrTable, image, gp->addrTableSize * sizeof(IzotAddress));
+    gp->addrGroupIndexValid = FALSE;
+    gp->nwDomainMatchValid = FALSE;
+    image += gp->addrTableSize * sizeof(IzotAddress);
+    memcpy(gp->nvConfigTable, image, gp->nvTableCapacity * sizeof(IzotDatapointConfig));
+    image += gp->nvTableCapacity * sizeof(IzotDatapointConfig);
+    memcpy(gp->nvAliasTable, image, gp->nvAliasTableSize * sizeof(IzotAliasConfig));
+}
+
 /****************************************************************
 Function: IsTagBound
 Returns:  TRUE if the tag is bound. FALSE otherwise.
@@ -768,8 +1120,8 @@ Comment:  A tag is bound if its address index is not 0xF
 ****************************************************************/
 IzotByte IsTagBound(IzotByte tagIn)
 {
-    return (tagIn < nmp->snvt.mtagCount && tagIn < NUM_ADDR_TBL_ENTRIES &&
-            eep->addrTable[tagIn].SubnetNode.Type != IzotAddressUnassigned);
+    return (tagIn < nmp->snvt.mtagCount && tagIn < gp->addrTableSize &&
+            gp->addrTable[tagIn].SubnetNode.Type != IzotAddressUnassigned);
 }
 
 /****************************************************************
@@ -792,31 +1144,31 @@ IzotByte IsNVBound(IzotBits16 nvIndexIn)
 
     /* If the primary has a valid address table index and the address
        table entry is not unbound, then the variable is bound */
-    addrIndex = ADDR_INDEX(IZOT_GET_ATTRIBUTE(eep->nvConfigTable[nvIndexIn],
+    addrIndex = ADDR_INDEX(IZOT_GET_ATTRIBUTE(gp->nvConfigTable[nvIndexIn],
                                    IZOT_DATAPOINT_ADDRESS_HIGH),
-            IZOT_GET_ATTRIBUTE(eep->nvConfigTable[nvIndexIn],
+            IZOT_GET_ATTRIBUTE(gp->nvConfigTable[nvIndexIn],
                     IZOT_DATAPOINT_ADDRESS_LOW));
     //Changed as per Extended Address table doc requirement
-    if (addrIndex != 0xFF &&
-            (eep->addrTable[addrIndex].SubnetNode.Type != IzotAddressUnassigned ||
-                    eep->addrTable[addrIndex].Turnaround.Turnaround == 1)) {
+    if (addrIndex < gp->addrTableSize &&
+            (gp->addrTable[addrIndex].SubnetNode.Type != IzotAddressUnassigned ||
+                    gp->addrTable[addrIndex].Turnaround.Turnaround == 1)) {
         return (TRUE);
     }
 
     /* Primary is not bound. See if there is an alias for this variable
        that is bound. */
-    for (i = 0; i < NV_ALIAS_TABLE_SIZE; i++) {
+    for (i = 0; i < gp->nvAliasTableSize; i++) {
         primaryIndex = GetPrimaryIndex((IzotBits16)(i + nmp->nvTableSize));
-        addrIndex = ADDR_INDEX(IZOT_GET_ATTRIBUTE(eep->nvAliasTable[i].Alias,
+        addrIndex = ADDR_INDEX(IZOT_GET_ATTRIBUTE(gp->nvAliasTable[i].Alias,
                                        IZOT_DATAPOINT_ADDRESS_HIGH),
-                IZOT_GET_ATTRIBUTE(eep->nvAliasTable[i].Alias,
+                IZOT_GET_ATTRIBUTE(gp->nvAliasTable[i].Alias,
                         IZOT_DATAPOINT_ADDRESS_LOW));
         /* If the alias matches the primary, has a valid address table
            index and the address table entry is not IzotAddressUnassigned, then
            the primary variable is bound */
-        if (primaryIndex == nvIndexIn && addrIndex != 0xFF &&
-                (eep->addrTable[addrIndex].SubnetNode.Type != IzotAddressUnassigned ||
-                        eep->addrTable[addrIndex].Turnaround.Turnaround == 1)) {
+        if (primaryIndex == nvIndexIn && addrIndex < gp->addrTableSize &&
+                (gp->addrTable[addrIndex].SubnetNode.Type != IzotAddressUnassigned ||
+                        gp->addrTable[addrIndex].Turnaround.Turnaround == 1)) {
             return (TRUE);
         }
     }
@@ -902,9 +1254,11 @@ void LCS_InitAddress(void)
     int i;
 
     /* Init Address Table based on custom.c */
-    for (i = 0; i < NUM_ADDR_TBL_ENTRIES; i++) {
-        memset(&eep->addrTable[i], 0, 5);
+    for (i = 0; i < gp->addrTableSize; i++) {
+        memset(&gp->addrTable[i], 0, 5);
     }
+    gp->addrGroupIndexValid = FALSE;
+    gp->nwDomainMatchValid = FALSE;
 }
 
 /*******************************************************************************
@@ -921,17 +1275,17 @@ void LCS_InitAlias(void)
        we did initialize an entry. We don't need 0 anyway for
        hostPrimary as we can use primary for such entries. */
 
-    for (i = 0; i < NV_ALIAS_TABLE_SIZE; i++) {
-        memset(&eep->nvAliasTable[i], 0, 6);
+    for (i = 0; i < gp->nvAliasTableSize; i++) {
+        memset(&gp->nvAliasTable[i], 0, 6);
     }
 
     /* Initialize Alias Tables that are not initialized in custom.h */
-    for (i = 0; i < NV_ALIAS_TABLE_SIZE; i++) {
+    for (i = 0; i < gp->nvAliasTableSize; i++) {
         char *p;
         /* Init only those that are not given meaningful values
            in custom.h */
 
-        p = (char *)&eep->nvAliasTable[i];
+        p = (char *)&gp->nvAliasTable[i];
         *p = (char)0x7F;
         *(p + 1) = (char)0xFF;
         *(p + 2) = (char)0x0F;
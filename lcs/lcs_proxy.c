@@ -64,6 +64,105 @@ void processProxyRepeaterAsAgent(APPReceiveParam *appReceiveParamPtr, APDU *apdu
     }
 }
 
+// Builds the outgoing address and transmit control for a repeat chain hop
+// from the proxy header, the next hop address and txctrl.
+static void BuildProxyForward(ProxyForward *pf, const IzotByte *pData, int txcpos,
+        int domIdx)
+{
+    ProxyHeader ph = *(const ProxyHeader *)pData;
+    ProxyTxCtrl txc = *(const ProxyTxCtrl *)&pData[txcpos];
+    int uniform = ph.uniform_by_src || ph.uniform_by_dest;
+    const ProxySubnetNodeAddress *pa;
+    int count = ph.count - 1;
+    int offset;
+    int adjust;
+
+    pa = (const ProxySubnetNodeAddress *)(&pData[sizeof(ProxyHeader)] - uniform);
+    memset(&pf->addr, 0, sizeof(pf->addr));
+    pf->addr.snode.longTimer = ph.long_timer;
+    pf->addr.snode.addrMode = AM_SUBNET_NODE;
+    pf->addr.snode.txTimer = txc.timer;
+    pf->addr.snode.rptTimer = txc.timer;
+    pf->addr.snode.retryCount = txc.retry;
+    pf->addr.snode.node = pa->node;
+    if (!uniform) {
+        pf->addr.snode.subnetID = pa->subnet;
+    } else if (ph.uniform_by_src) {
+        pf->addr.snode.subnetID = pf->src.Subnet;
+    } else {
+        pf->addr.snode.subnetID = eep->domainTable[domIdx].Subnet;
+    }
+    // Set the domain index to be the one in which it was received.
+    pf->addr.snode.domainIndex = domIdx;
+    pf->alt = pa->path;
+
+    // Skip header and address
+    offset = (int)(sizeof(ProxyHeader) + sizeof(ProxySubnetNodeAddress) - uniform);
+
+    if (count == 0) {
+        // Last address.  Skip txctrl too.
+        offset += (int)sizeof(ProxyTxCtrl);
+    }
+
+    // To handle the case where repeated messages time out, allow for the fact that each
+    // repeater in the chain needs a little bit more time on the last timeout that the
+    // previous repeater.  So, we allow 512 msec for each round trip to propagate the failure
+    // message.  This means adding 512*count msec at each hop.
+    // This is timed for A-band power line.  This may not be necessary of higher-speed channels.
+    // The adjustment is deployed as a function of the tx_timer.
+    adjust = 256;  // Add constant 256 msec at every hop
+    if (ph.long_timer || txc.timer >= 10) {
+        adjust = 512 * count;  // Add 512 msec per hop
+    } else if (txc.timer >= 8) {
+        adjust = 256 * count;  // Add 256 msec per hop
+    }
+    pf->adjust = (IzotUbits16)adjust;
+
+    // The new header replaces the last byte of the address for the copy below.
+    ph.count--;
+    pf->nextHeader = *(unsigned char *)&ph;
+    pf->offset = (IzotByte)(offset - 1);
+}
+
+// Returns the forwarding state for a received repeat chain message,
+// building it if the chain is not among the recent ones.
+static const ProxyForward *GetProxyForward(APPReceiveParam *appReceiveParamPtr,
+        const IzotByte *pData, int txcpos, int domIdx)
+{
+    ProxyHeader ph = *(const ProxyHeader *)pData;
+    const IzotByte *hop = &pData[sizeof(ProxyHeader)] - (ph.uniform_by_src || ph.uniform_by_dest);
+    const IzotReceiveSubnetNode *src = &appReceiveParamPtr->srcAddr.subnetAddr;
+    ProxyForward *pf;
+    int i;
+
+    if (!gp->proxyForwardValid) {
+        memset(gp->proxyForward, 0, sizeof(gp->proxyForward));
+        gp->proxyForwardNext = 0;
+        gp->proxyForwardValid = TRUE;
+    }
+    for (i = 0; i < PROXY_FORWARD_CACHE_SIZE; i++) {
+        pf = &gp->proxyForward[i];
+        if (pf->inUse && pf->header == pData[0] && pf->txctrl == pData[txcpos]
+                && pf->hop[0] == hop[0] && pf->hop[1] == hop[1]
+                && pf->domainIndex == appReceiveParamPtr->srcAddr.dmn.domainIndex
+                && pf->src.Subnet == src->Subnet && pf->src.Node == src->Node) {
+            return pf;
+        }
+    }
+
+    pf = &gp->proxyForward[gp->proxyForwardNext];
+    gp->proxyForwardNext = (gp->proxyForwardNext + 1) % PROXY_FORWARD_CACHE_SIZE;
+    pf->inUse = TRUE;
+    pf->domainIndex = appReceiveParamPtr->srcAddr.dmn.domainIndex;
+    pf->src = *src;
+    pf->header = pData[0];
+    pf->hop[0] = hop[0];
+    pf->hop[1] = hop[1];
+    pf->txctrl = pData[txcpos];
+    BuildProxyForward(pf, pData, txcpos, domIdx);
+    return pf;
+}
+
 // Processes an LTEP completion event
 LonStatusCode ProcessLtepCompletion(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr,
         LonStatusCode status)
@@ -93,45 +192,26 @@ LonStatusCode ProcessLTEP(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
     int uniform;
     int alt;
     DestinType code;
-    int subnet;
-    int node = 0;
-    int src_subnet;
-    int dst_subnet;
     int txcpos;
-    int addressType = AM_SUBNET_NODE;
     ProxyHeader ph;
-    ProxyTxCtrl txc;
     int dataLen = appReceiveParamPtr->pduSize - 1;
     IzotByte *pData = apduPtr->data;
-    int txTimer = 0;
     int domIdx = appReceiveParamPtr->srcAddr.dmn.domainIndex;
     Queue *outQPtr;
     AltKey altKey;
-    IzotByte longTimer = FALSE;
     IzotServiceType service;
     int adjust = 0;
     IzotSendAddress addr;
 
-    memset(&addr, 0, sizeof(addr));
     altKey.altKey = false;
 
     ph = *(ProxyHeader *)pData;
     uniform = ph.uniform_by_src || ph.uniform_by_dest;
-    src_subnet = appReceiveParamPtr->srcAddr.subnetAddr.Subnet;
-    dst_subnet = eep->domainTable[domIdx].Subnet;
-    if (ph.uniform_by_src) {
-        subnet = src_subnet;
-    } else {
-        subnet = dst_subnet;
-    }
     proxyCount = count = ph.count;
     txcpos = (int)(sizeof(ProxyHeader) +
                    (uniform ? sizeof(ProxySubnetNodeAddressCompact) * count
                             : sizeof(ProxySubnetNodeAddress) * count));
 
-    // Get txctrl values
-    txc = *(ProxyTxCtrl *)(&pData[txcpos]);
-
     if (ph.all_agents && count) {
         processProxyRepeaterAsAgent(appReceiveParamPtr, apduPtr, txcpos);
     }
@@ -142,47 +222,30 @@ LonStatusCode ProcessLTEP(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
     }
 
     if (count != 0) {
-        ProxySubnetNodeAddress *pa;
-
-        pa = (ProxySubnetNodeAddress *)(&pData[sizeof(ProxyHeader)] - uniform);
-        alt = pa->path;
-        txTimer = txc.timer;
-        longTimer = ph.long_timer;
-        subnet = uniform ? subnet : pa->subnet;
-        node = pa->node;
+        // Repeat chain hop.  The outgoing address only depends on the source,
+        // the domain and the leading bytes of the message, so it is built once
+        // per chain.
+        const ProxyForward *pf = GetProxyForward(appReceiveParamPtr, pData, txcpos, domIdx);
+
+        addr = pf->addr;
+        alt = pf->alt;
+        adjust = pf->adjust;
+        offset = pf->offset;
         service = appReceiveParamPtr->service;
 
-        count--;
-
-        // Skip header and address
-        offset = (int)(sizeof(ProxyHeader) + sizeof(ProxySubnetNodeAddress) - uniform);
-
-        if (count == 0) {
-            // Last address.  Skip txctrl too.
-            offset += (int)sizeof(ProxyTxCtrl);
-        }
-
-        // To handle the case where repeated messages time out, allow for the fact that each
-        // repeater in the chain needs a little bit more time on the last timeout that the
-        // previous repeater.  So, we allow 512 msec for each round trip to propagate the failure
-        // message.  This means adding 512*count msec at each hop.
-        // This is timed for A-band power line.  This may not be necessary of higher-speed channels.
-        // The adjustment is deployed as a function of the tx_timer.
-        adjust = 256;  // Add constant 256 msec at every hop
-        if (ph.long_timer || txc.timer >= 10) {
-            adjust = 512 * count;  // Add 512 msec per hop
-        } else if (txc.timer >= 8) {
-            adjust = 256 * count;  // Add 256 msec per hop
-        }
-
         // Send message on to next PR or PA
         code.allBits = LT_APDU_ENHANCED_PROXY;
-        ph.count--;
         // Position new header into data space in preparation for copy below.
-        pData[--offset] = *(unsigned char *)&ph;
+        pData[offset] = pf->nextHeader;
     } else {
         // Proxy Agent mode - no more addresses.
         ProxySicb *pProxySicb;
+        ProxyTxCtrl txc;
+        int addressType;
+        int subnet;
+        int node = 0;
+
+        memset(&addr, 0, sizeof(addr));
 
         pProxySicb = (ProxySicb *)&pData[sizeof(ProxyHeader)];
         txc = pProxySicb->txctrl;
@@ -194,7 +257,6 @@ LonStatusCode ProcessLTEP(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 
         addressType = pProxySicb->type;
         offset = addrSizeTable[addressType];
-        txTimer = txc.timer;
 
         // Remove "compact" bit
         addressType &= 0x3;
@@ -249,11 +311,11 @@ LonStatusCode ProcessLTEP(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
                 subnet = 0;
                 break;
             case PX_SUBNET_NODE_COMPACT_SRC:
-                subnet = src_subnet;
+                subnet = appReceiveParamPtr->srcAddr.subnetAddr.Subnet;
                 node = pAddress->snc.node;
                 break;
             case PX_SUBNET_NODE_COMPACT_DEST:
-                subnet = dst_subnet;
+                subnet = eep->domainTable[domIdx].Subnet;
                 node = pAddress->snc.node;
                 addressType = AM_SUBNET_NODE;
                 break;
@@ -282,19 +344,19 @@ LonStatusCode ProcessLTEP(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
 
         code.allBits = pData[offset++];
         alt = pProxySicb->path;
-    }
 
-    addr.snode.longTimer = longTimer;
-    addr.snode.addrMode = addressType;
-    addr.snode.txTimer = txTimer;
-    addr.snode.rptTimer = txTimer;
-    addr.snode.retryCount = txc.retry;
-    addr.snode.node = node;
-    addr.snode.subnetID = subnet;
-    addr.snode.domainIndex =
-            domIdx;  // Set the domain index to be the one in which it was received.
-    if (addressType & 0x80) {
-        addr.noAddress = addressType;
+        addr.snode.longTimer = FALSE;
+        addr.snode.addrMode = addressType;
+        addr.snode.txTimer = txc.timer;
+        addr.snode.rptTimer = txc.timer;
+        addr.snode.retryCount = txc.retry;
+        addr.snode.node = node;
+        addr.snode.subnetID = subnet;
+        addr.snode.domainIndex =
+                domIdx;  // Set the domain index to be the one in which it was received.
+        if (addressType & 0x80) {
+            addr.noAddress = addressType;
+        }
     }
 
     // Get an output buffer for the proxy relay
@@ -306,7 +368,7 @@ LonStatusCode ProcessLTEP(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
     }
 
     /* Check if the target queue has space for forwarding this request. */
-    if (QueueFull(outQPtr)) {
+    if (!NWOutQAvailable(outQPtr, NW_TX_NEW)) {
         // Failure indicates we didn't process the message so don't free it!
         // Note that the following deadlock condition can occur:
         // App Input queue full but stymied by proxy relay
@@ -359,7 +421,7 @@ LonStatusCode ProcessLTEP(APPReceiveParam *appReceiveParamPtr, APDU *apduPtr)
             tsaSendParamPtr->apduSize = dataLen + 1;
             apduSendPtr->code = code;
             tsaSendParamPtr->destAddr = addr;
-            QueueWrite(outQPtr);
+            NWOutQWrite(outQPtr, NW_TX_NEW);
         }
         if (sts != LonStatusNoError) {
             SendResponse(appReceiveParamPtr->reqId, LT_ENHANCED_PROXY_FAILURE,
@@ -23,6 +23,7 @@
 /*****************************************************************
  * Section: Queue Function Definitions
  *****************************************************************/
+#if !STACK_STATIC_ALLOCATION
 /*
  * Initializes a queue with the specified capacity and entry size.
  * Parameters:
@@ -54,8 +55,33 @@ LonStatusCode QueueInit(Queue *queue_out, char *queue_name, size_t entry_size,
                 "QueueInit: Memory allocation failed");
         return (LonStatusNoMemoryAvailable);
     }
+    return QueueInitStorage(queue_out, queue_out->queueName, entry_size, queue_capacity,
+            queue_out->data);
+}
+
+#endif  // !STACK_STATIC_ALLOCATION
 
-    // Initialize other fields
+/*
+ * Initializes a queue in storage provided by the caller.
+ * Parameters:
+ *   queue_out: Pointer to the queue to initialize.
+ *   queue_name: Optional name of the queue (for debugging); not copied
+ *   entry_size: Size of each entry in the queue in bytes.
+ *   queue_capacity: Capacity of the queue in entries.
+ *   storage: At least entry_size * queue_capacity bytes for the entries.
+ * Returns:
+ *   LonStatusNoError if successful; LonStatusCode error code if unsuccessful.
+ */
+LonStatusCode QueueInitStorage(Queue *queue_out, char *queue_name, size_t entry_size,
+        size_t queue_capacity, void *storage)
+{
+    if (storage == NULL) {
+        OsalPrintLog(ERROR_LOG, LonStatusNoMemoryAvailable,
+                "QueueInitStorage: No storage for queue");
+        return (LonStatusNoMemoryAvailable);
+    }
+    queue_out->queueName = queue_name;
+    queue_out->data = storage;
     queue_out->entrySize = entry_size;
     queue_out->queueCapacity = queue_capacity;
     queue_out->queueEntries = 0;
@@ -350,23 +376,65 @@ void *QueueTail(Queue *queue_in)
 /*****************************************************************
  * Section: Ring Buffer Function Definitions
  *****************************************************************/
+#if !STACK_STATIC_ALLOCATION
 /*
  * Initializes a ring buffer with the specified capacity.
  * Parameters:
  *   rb: Pointer to the ring buffer to initialize.
- *   capacity: Capacity of the ring buffer in bytes.
+ *   capacity: Capacity of the ring buffer in bytes; rounded up to a power of two.
  * Returns:
  *   LonStatusNoError if successful; LonStatusCode error code if unsuccessful.
+ * Notes:
+ *   The data storage for the ring buffer is allocated within this function
+ *   and is reused if the ring buffer is initialized again with the same
+ *   capacity.  A power of two capacity lets head and tail wrap with a mask.
  */
 LonStatusCode RingBufferInit(RingBuffer *rb, size_t capacity)
 {
-    if (!rb || capacity == 0) {
+    if (!rb || capacity == 0 || capacity > (SIZE_MAX / 2 + 1)) {
         return LonStatusInvalidParameter;
     }
-    if (capacity > RING_BUFFER_MAX_CAPACITY) {
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    if (rb->data == NULL || rb->size != size) {
+        if (rb->data != NULL) {
+            OsalFreeMemory(rb->data);
+        }
+        rb->data = OsalAllocateMemory(size);
+        if (rb->data == NULL) {
+            rb->size = rb->mask = 0;
+            OsalPrintLog(ERROR_LOG, LonStatusNoMemoryAvailable,
+                    "RingBufferInit: Memory allocation failed");
+            return LonStatusNoMemoryAvailable;
+        }
+    }
+    rb->size = size;
+    rb->mask = size - 1;
+    rb->head = rb->tail = rb->count = 0;
+    return LonStatusNoError;
+}
+
+#endif  // !STACK_STATIC_ALLOCATION
+
+/*
+ * Initializes a ring buffer in storage provided by the caller.
+ * Parameters:
+ *   rb: Pointer to the ring buffer to initialize.
+ *   storage: Storage for the ring buffer data.
+ *   size: Size of the storage in bytes; must be a power of two.
+ * Returns:
+ *   LonStatusNoError if successful; LonStatusCode error code if unsuccessful.
+ */
+LonStatusCode RingBufferInitStorage(RingBuffer *rb, uint8_t *storage, size_t size)
+{
+    if (!rb || !storage || size == 0 || (size & (size - 1)) != 0) {
         return LonStatusInvalidParameter;
     }
-    rb->size = capacity;
+    rb->data = storage;
+    rb->size = size;
+    rb->mask = size - 1;
     rb->head = rb->tail = rb->count = 0;
     return LonStatusNoError;
 }
@@ -417,19 +485,15 @@ size_t RingBufferWrite(RingBuffer *rb, const uint8_t *src, size_t len)
     if (!rb || !src || len == 0) {
         return 0;
     }
-    size_t space = RingBufferAvail(rb);
-    size_t to_write = (len > space) ? space : len;
     size_t written = 0;
-    while (written < to_write) {
-        size_t space_end = rb->size - rb->head;
-        size_t chunk = to_write - written;
-        if (chunk > space_end) {
-            chunk = space_end;
+    uint8_t *span;
+    size_t span_len;
+    while (written < len && (span_len = RingBufferWriteReserve(rb, &span)) != 0) {
+        if (span_len > len - written) {
+            span_len = len - written;
         }
-        memcpy(&rb->data[rb->head], src + written, chunk);
-        rb->head = (rb->head + chunk) % rb->size;
-        rb->count += chunk;
-        written += chunk;
+        memcpy(span, src + written, span_len);
+        written += RingBufferWriteCommit(rb, span_len);
     }
     return written;
 }
@@ -458,7 +522,7 @@ size_t RingBufferPeek(const RingBuffer *rb, uint8_t *dst, size_t len)
             chunk = avail_end;
         }
         memcpy(dst + read, &rb->data[tail], chunk);
-        tail = (tail + chunk) % rb->size;
+        tail = (tail + chunk) & rb->mask;
         read += chunk;
     }
     return read;
@@ -479,7 +543,89 @@ size_t RingBufferRead(RingBuffer *rb, uint8_t *dst, size_t len)
         return 0;
     }
     size_t got = RingBufferPeek(rb, dst, len);
-    rb->tail = (rb->tail + got) % rb->size;
-    rb->count -= got;
-    return got;
+    return RingBufferReadConsume(rb, got);
+}
+
+/*
+ * Reserves the contiguous free space at the write position of a ring buffer.
+ * Parameters:
+ *   rb: Pointer to the ring buffer.
+ *   span: Pointer to receive the start of the free span.
+ * Returns:
+ *   Number of contiguous bytes available at *span; 0 if the ring is full.
+ */
+size_t RingBufferWriteReserve(RingBuffer *rb, uint8_t **span)
+{
+    if (!rb || !span || !rb->data) {
+        return 0;
+    }
+    size_t space = rb->size - rb->count;
+    size_t space_end = rb->size - rb->head;
+    *span = &rb->data[rb->head];
+    return (space > space_end) ? space_end : space;
+}
+
+/*
+ * Commits bytes written to a span returned by RingBufferWriteReserve().
+ * Parameters:
+ *   rb: Pointer to the ring buffer.
+ *   len: Number of bytes written to the reserved span.
+ * Returns:
+ *   Number of bytes actually committed.
+ */
+size_t RingBufferWriteCommit(RingBuffer *rb, size_t len)
+{
+    if (!rb || len == 0) {
+        return 0;
+    }
+    size_t space = rb->size - rb->count;
+    size_t space_end = rb->size - rb->head;
+    if (len > space) {
+        len = space;
+    }
+    if (len > space_end) {
+        len = space_end;
+    }
+    rb->head = (rb->head + len) & rb->mask;
+    rb->count += len;
+    return len;
+}
+
+/*
+ * Returns the contiguous stored data at the read position of a ring buffer.
+ * Parameters:
+ *   rb: Pointer to the ring buffer.
+ *   span: Pointer to receive the start of the stored data.
+ * Returns:
+ *   Number of contiguous bytes available at *span; 0 if the ring is empty.
+ */
+size_t RingBufferReadPeekContiguous(const RingBuffer *rb, const uint8_t **span)
+{
+    if (!rb || !span || !rb->data) {
+        return 0;
+    }
+    size_t avail_end = rb->size - rb->tail;
+    *span = &rb->data[rb->tail];
+    return (rb->count > avail_end) ? avail_end : rb->count;
+}
+
+/*
+ * Removes bytes from the read position of a ring buffer.
+ * Parameters:
+ *   rb: Pointer to the ring buffer.
+ *   len: Number of bytes to remove.
+ * Returns:
+ *   Number of bytes actually removed.
+ */
+size_t RingBufferReadConsume(RingBuffer *rb, size_t len)
+{
+    if (!rb || len == 0) {
+        return 0;
+    }
+    if (len > rb->count) {
+        len = rb->count;
+    }
+    rb->tail = (rb->tail + len) & rb->mask;
+    rb->count -= len;
+    return len;
 }
@@ -94,6 +94,31 @@ typedef struct __attribute__((packed)) {
 
 typedef AuthPDU *AuthPDUPtr;
 
+// Number of passes over the key bytes for each 8-byte block of an
+// authenticated message.  Classic keys use bytes 0-5; OMA keys use
+// bytes 0-11 followed by bytes 0-5.
+#define AUTH_KEY_ITERATIONS IZOT_AUTHENTICATION_KEY_LENGTH
+#define AUTH_OMA_KEY_ITERATIONS (IZOT_OMA_AUTHENTICATION_KEY_LENGTH + \
+        IZOT_OMA_AUTHENTICATION_KEY_LENGTH / 2)
+
+// Number of expanded authentication keys kept by Encrypt().  Two domain
+// keys and the OMA key formed from both need three; the rest is for
+// alternate keys supplied by the application.
+#ifndef AUTH_KEY_SCHEDULE_COUNT
+#define AUTH_KEY_SCHEDULE_COUNT 4
+#endif
+
+/* Authentication key expanded for Encrypt().  Each key bit selects one
+ of two byte operations; the bit is stored as a 0x00/0xFF mask so that
+ the inner loop of the cipher has no key-dependent branches. */
+typedef struct {
+    IzotByte valid;
+    IzotByte isOma;
+    IzotByte keyIterations;
+    IzotByte key[IZOT_OMA_AUTHENTICATION_KEY_LENGTH];
+    IzotByte rotateLeft[AUTH_OMA_KEY_ITERATIONS][8];  // Indexed by key byte pass and bit 7-j
+} AuthKeySchedule;
+
 /*****************************************************************
  * Section: Globals
  *****************************************************************/
@@ -117,6 +142,10 @@ static const IzotByte addrModeToFmt[6] = {
         2     /* AM_MULTICAST_ACK  */
 };
 
+/* Expanded authentication keys, replaced round robin */
+static AuthKeySchedule authKeySchedules[AUTH_KEY_SCHEDULE_COUNT];
+static IzotByte authKeyScheduleNext;
+
 /*****************************************************************
  * Section: Function Declarations
  *****************************************************************/
@@ -125,6 +154,10 @@ static const IzotByte addrModeToFmt[6] = {
 static void InitiateChallenge(IzotUbits16 rrIndexIn);
 static void SendReplyToChallenge(IzotByte useOma);
 static void ProcessReply(IzotByte useOma);
+static const AuthKeySchedule *GetAuthKeySchedule(const IzotByte *pKey, IzotByte isOma);
+static void EncryptWithSchedule(const AuthKeySchedule *schedule, const IzotByte randIn[],
+        const IzotByte *prefix, IzotUbits16 prefixSize, const IzotByte *data,
+        IzotUbits16 dataSize, IzotByte encryptValueOut[]);
 
 /* Transport layer related functions. */
 static void TPSendAck(IzotUbits16 rrIndexIn);
@@ -285,7 +318,7 @@ LonStatusCode TransactionServicesSublayerReset(void)
     }
     queueItemSize = gp->tsaInBufSize + sizeof(TSAReceiveParam);
 
-    if (!LON_SUCCESS(status = QueueInit(&gp->tsaInQ, "transaction services input",
+    if (!LON_SUCCESS(status = StackQueueInit(&gp->tsaInQ, "transaction services input",
                              queueItemSize, gp->tsaInQCnt))) {
         gp->resetOk = FALSE;
         OsalPrintLog(ERROR_LOG, status,
@@ -314,7 +347,7 @@ LonStatusCode TransactionServicesSublayerReset(void)
         return status;
     }
     queueItemSize = gp->tsaOutBufSize + sizeof(TSASendParam);
-    if (!LON_SUCCESS(status = QueueInit(&gp->tsaOutQ, "transaction services output",
+    if (!LON_SUCCESS(status = StackQueueInit(&gp->tsaOutQ, "transaction services output",
                              queueItemSize, gp->tsaOutQCnt))) {
         gp->resetOk = FALSE;
         OsalPrintLog(ERROR_LOG, status,
@@ -336,7 +369,7 @@ LonStatusCode TransactionServicesSublayerReset(void)
         return status;
     }
     queueItemSize = gp->tsaOutPriBufSize + sizeof(TSASendParam);
-    if (!LON_SUCCESS(status = QueueInit(&gp->tsaOutPriQ,
+    if (!LON_SUCCESS(status = StackQueueInit(&gp->tsaOutPriQ,
                              "transaction services priority output", queueItemSize,
                              gp->tsaOutPriQCnt))) {
         gp->resetOk = FALSE;
@@ -356,7 +389,7 @@ LonStatusCode TransactionServicesSublayerReset(void)
     }
     gp->tsaRespQCnt = gp->tsaOutQCnt;
     queueItemSize = gp->tsaRespBufSize + sizeof(TSASendParam);
-    if (!LON_SUCCESS(status = QueueInit(&gp->tsaRespQ, "transaction services response",
+    if (!LON_SUCCESS(status = StackQueueInit(&gp->tsaRespQ, "transaction services response",
                              queueItemSize, gp->tsaRespQCnt))) {
         gp->resetOk = FALSE;
         OsalPrintLog(ERROR_LOG, status,
@@ -371,7 +404,7 @@ LonStatusCode TransactionServicesSublayerReset(void)
 
     /* Initialize the receive records */
     gp->recvRecCnt = RECEIVE_TRANS_COUNT;
-    gp->recvRec = OsalAllocateMemory((size_t)(gp->recvRecCnt * sizeof(ReceiveRecord)));
+    gp->recvRec = StackArenaAllocate((size_t)(gp->recvRecCnt * sizeof(ReceiveRecord)));
     if (gp->recvRec == NULL) {
         gp->resetOk = FALSE;
         OsalPrintLog(ERROR_LOG, LonStatusNoMemoryAvailable,
@@ -397,8 +430,8 @@ LonStatusCode TransactionServicesSublayerReset(void)
                     "size");
             return status;
         }
-        gp->recvRec[i].response = OsalAllocateMemory((size_t)decodedResponseBufSize);
-        gp->recvRec[i].apdu = OsalAllocateMemory((size_t)decodedReceiveBufSize);
+        gp->recvRec[i].response = StackArenaAllocate((size_t)decodedResponseBufSize);
+        gp->recvRec[i].apdu = StackArenaAllocate((size_t)decodedReceiveBufSize);
         if (gp->recvRec[i].response == NULL || gp->recvRec[i].apdu == NULL) {
             gp->resetOk = FALSE;
             OsalPrintLog(ERROR_LOG, LonStatusNoMemoryAvailable,
@@ -480,7 +513,7 @@ void TransportLayerSend(void)
     Send a new non-priority message.
     **************************************************/
     else if (gp->xmitRec.status == UNUSED_TX && !QueueEmpty(&gp->tsaOutQ) &&
-             !QueueFull(&gp->nwOutQ)) {
+             NWOutQAvailable(&gp->nwOutQ, NW_TX_NEW)) {
         OsalPrintLog(INFO_LOG, LonStatusNoError,
                 "TransportLayerSend: Send a new non-priority message");
         SendNewMsg(TRANSPORT, FALSE);
@@ -601,7 +634,10 @@ static void XmitTimerExpiration(Layer layerIn, IzotByte priorityIn)
     }
 
     /* Check if there is space in the network buffer for retransmission */
-    if (QueueFull(nwQPtr)) {
+    if (!NWOutQAvailable(nwQPtr, NW_TX_RETRY)) {
+        if (!QueueFull(nwQPtr)) {
+            return; /* Another class has its turn. Retry on the next pass. */
+        }
         /* We are losing a retry chance locally due to lack of space
         in network queue */
         xmitRecPtr->retriesLeft--;
@@ -783,7 +819,7 @@ static void XmitTimerExpiration(Layer layerIn, IzotByte priorityIn)
                 nwSendParamPtr->altPath |= ALT_RETRY;
 
                 /* Add TSPDU into the queue. */
-                QueueWrite(nwQPtr);
+                NWOutQWrite(nwQPtr, NW_TX_RETRY);
             }
 
             /* Send the IzotServiceAcknowledged or IzotServiceRequest. */
@@ -865,7 +901,7 @@ static void XmitTimerExpiration(Layer layerIn, IzotByte priorityIn)
     OsalPrintLog(INFO_LOG, LonStatusNoError, "XmitTimerExpiration: %d retries left",
             xmitRecPtr->retriesLeft);
     // Add TSPDU into the queue
-    QueueWrite(nwQPtr);
+    NWOutQWrite(nwQPtr, NW_TX_RETRY);
 
     // Start the transmit timer
     if (xmitRecPtr->retriesLeft == 0) {
@@ -1181,7 +1217,7 @@ static void SendNewMsg(Layer layerIn, IzotByte priorityIn)
     nwSendParamPtr->pduSize = xmitRecPtr->apduSize + dataIndex + 1;
 
     /* Add the TSPDU into the queue. */
-    QueueWrite(nwQPtr);
+    NWOutQWrite(nwQPtr, NW_TX_NEW);
 
     /* Start the transmit timer. */
     SetLonTimer(&xmitRecPtr->xmitTimer, xmitRecPtr->xmitTimerValue);
@@ -2222,7 +2258,7 @@ static void TPSendAck(IzotUbits16 rrIndexIn)
         nwQueuePtr = &gp->nwOutQ;
     }
 
-    if (QueueFull(nwQueuePtr)) {
+    if (!NWOutQAvailable(nwQueuePtr, NW_TX_RESPONSE)) {
         return; /* Can't send the acknowledgement now. */
     }
 
@@ -2275,7 +2311,7 @@ static void TPSendAck(IzotUbits16 rrIndexIn)
     nwSendParamPtr->altPath = gp->recvRec[rrIndexIn].altPath | ALT_CHANNEL_LOCK;
     nwSendParamPtr->pduSize = 1 + dataIndex;
     OsalPrintLog(INFO_LOG, LonStatusNoError, "TPSendAck: Sending an acknowledgment");
-    QueueWrite(nwQueuePtr);
+    NWOutQWrite(nwQueuePtr, NW_TX_RESPONSE);
 }
 
 /*****************************************************************
@@ -2413,7 +2449,7 @@ static void SNSendResponse(IzotUbits16 rrIndexIn, IzotByte nullResponse,
     nwSendParamPtr->pduSize = gp->recvRec[rrIndexIn].rspSize + dataIndex + 1;
 
     OsalPrintLog(INFO_LOG, LonStatusNoError, "SNSendResponse: Sending a response");
-    QueueWrite(nwQueuePtr);
+    NWOutQWrite(nwQueuePtr, NW_TX_RESPONSE);
 }
 
 /*****************************************************************
@@ -2576,7 +2612,8 @@ static bool FindRR(RequestId id, IzotUbits16 *pIndex)
  ******************************************************************/
 static IzotUbits16 ComputeRecvTimerValue(AddrMode addrModeIn, IzotByte groupIdIn)
 {
-    IzotUbits16 i, max = 0, temp;
+    IzotUbits16 i, j, count, max = 0, temp;
+    const IzotUbits16 *entries;
     LonStatusCode status = LonStatusNoError;
 
     if (addrModeIn == AM_UNIQUE_NODE_ID) {
@@ -2584,17 +2621,18 @@ static IzotUbits16 ComputeRecvTimerValue(AddrMode addrModeIn, IzotByte groupIdIn
     }
 
     if (addrModeIn == AM_MULTICAST) {
-        /* Search through the address table to find the receiver timer val. */
+        /* Search the group entries of the address table in each domain to
+        find the receiver timer val. */
         /* If there is more than one entry with the same group,
         use the one with the max rcv timer value */
-        for (i = 0; i < NUM_ADDR_TBL_ENTRIES; i++) {
-            if (IZOT_GET_ATTRIBUTE(eep->addrTable[i].Group, IZOT_ADDRESS_GROUP_TYPE) ==
-                            1 &&
-                    eep->addrTable[i].Group.Group == groupIdIn) {
+        for (j = 0; j < MAX_DOMAINS; j++) {
+            count = GroupAddrEntries((IzotByte)j, groupIdIn, &entries);
+            while (count--) {
+                i = *entries++;
                 /* Group format match */
                 if (!LON_SUCCESS(
                             status = DecodeRcvTimer(
-                                    (IzotByte)IZOT_GET_ATTRIBUTE(eep->addrTable[i].Group,
+                                    (IzotByte)IZOT_GET_ATTRIBUTE(gp->addrTable[i].Group,
                                             IZOT_ADDRESS_GROUP_RECEIVE_TIMER),
                                     &temp))) {
                     OsalPrintLog(ERROR_LOG, status,
@@ -2663,7 +2701,7 @@ void SessionLayerSend(void)
      Send response, if any, first. Responses are not like transactions
     and hence it is better to send it first.
     **************************************************/
-    if (!QueueEmpty(&gp->tsaRespQ) && !QueueFull(&gp->nwOutQ)) {
+    if (!QueueEmpty(&gp->tsaRespQ) && NWOutQAvailable(&gp->nwOutQ, NW_TX_RESPONSE)) {
         /* We have a response to be sent out.
         Make sure the response is not stale.
         Response should have a reqId.
@@ -2736,7 +2774,7 @@ void SessionLayerSend(void)
      Send a new non-priority message.
     **************************************************/
     else if (gp->xmitRec.status == UNUSED_TX && !QueueEmpty(&gp->tsaOutQ) &&
-             !QueueFull(&gp->nwOutQ)) {
+             NWOutQAvailable(&gp->nwOutQ, NW_TX_NEW)) {
         OsalPrintLog(INFO_LOG, LonStatusNoError,
                 "SessionLayerSend: Send a new non-priority message");
         SendNewMsg(SESSION, FALSE);
@@ -2922,7 +2960,7 @@ static void InitiateChallenge(IzotUbits16 rrIndexIn)
         nwQueuePtr = &gp->nwOutQ;
     }
 
-    if (QueueFull(nwQueuePtr)) {
+    if (!NWOutQAvailable(nwQueuePtr, NW_TX_RESPONSE)) {
         /* No space to send challenge anyway. Come back later. */
         return;
     }
@@ -2993,7 +3031,7 @@ static void InitiateChallenge(IzotUbits16 rrIndexIn)
     nwSendParamPtr->deltaBL = 0;
     nwSendParamPtr->altPath = gp->recvRec[rrIndexIn].altPath | ALT_CHANNEL_LOCK;
     gp->recvRec[rrIndexIn].transState = AUTHENTICATING;
-    QueueWrite(nwQueuePtr);
+    NWOutQWrite(nwQueuePtr, NW_TX_RESPONSE);
     OsalPrintLog(INFO_LOG, LonStatusNoError,
             "InitiateChallenge: Sending an authentication challenge");
     return;
@@ -3140,7 +3178,7 @@ static void SendReplyToChallenge(IzotByte useOma)
         return;
     }
 
-    if (QueueFull(nwQueuePtr)) {
+    if (!NWOutQAvailable(nwQueuePtr, NW_TX_RESPONSE)) {
         /* No Space to send reply anyway. Come back later. */
         return;
     }
@@ -3207,7 +3245,7 @@ static void SendReplyToChallenge(IzotByte useOma)
     nwSendParamPtr->pduType = AUTHPDU_TYPE;
     nwSendParamPtr->deltaBL = 0;
     nwSendParamPtr->altPath = tsaReceiveParamPtr->altPath | ALT_CHANNEL_LOCK;
-    QueueWrite(nwQueuePtr);
+    NWOutQWrite(nwQueuePtr, NW_TX_RESPONSE);
     QueueDropHead(&gp->tsaInQ);
     OsalPrintLog(INFO_LOG, LonStatusNoError,
             "SendReply: Sending an authentication challenge reply message");
@@ -3366,57 +3404,146 @@ static void ProcessReply(IzotByte useOma)
  Purpose:   To compute the encryption key based on authentication
  key in the domain table, the APDU, and the random
  number given.
- Comments:  None
+ Comments:  The key is expanded once and kept in authKeySchedules
+ until it changes; see GetAuthKeySchedule().  For OMA,
+ the destination address is processed as a prefix of the
+ APDU rather than copied in front of it.
  ******************************************************************/
 void Encrypt(IzotByte randIn[], APDU *apduIn, IzotUbits16 apduSizeIn, IzotByte *pKey,
         IzotByte encryptValueOut[], IzotByte isOma, OmaAddress *pOmaDest)
 {
-    int16_t i, j, k;
-    IzotByte m, n;
-    IzotByte *apduBytes = (IzotByte *)&apduIn->code;
-    IzotUbits16 apduSize = apduSizeIn;
-
-    IzotByte omaBuffer[MAX_DATA_SIZE + sizeof(OmaAddress)];
-    int keyLength;
-    int keyIterations;  // Number of iterations over the key bytes.
-    // For classic keys, this is the same as
-    // the key length, but for OMA, its 1 1/2 times
-    // the key length - byte 0-11 followed by 0-5.
-
-    if (isOma) {
-        // Include OMA destination data with the message data.
-        memcpy(omaBuffer, pOmaDest, sizeof(OmaAddress));
-        memcpy(&omaBuffer[sizeof(OmaAddress)], apduBytes, apduSize);
-        apduBytes = omaBuffer;
-        apduSize += sizeof(OmaAddress);
-        keyLength = IZOT_OMA_AUTHENTICATION_KEY_LENGTH;
-        keyIterations = IZOT_OMA_AUTHENTICATION_KEY_LENGTH +
-                        IZOT_OMA_AUTHENTICATION_KEY_LENGTH / 2;
-    } else {
-        keyLength = IZOT_AUTHENTICATION_KEY_LENGTH;
-        keyIterations = keyLength;  // Once over the entire key.
-    }
+    const AuthKeySchedule *schedule = GetAuthKeySchedule(pKey, isOma);
 
-    for (i = 0; i < 8; i++) {
-        encryptValueOut[i] = randIn[i];
-    }
+    EncryptWithSchedule(schedule, randIn, isOma ? (const IzotByte *)pOmaDest : NULL,
+            isOma ? sizeof(OmaAddress) : 0, (const IzotByte *)&apduIn->code,
+            apduSizeIn, encryptValueOut);
+}
 
-    while (apduSize > 0) {
-        for (i = 0; i < keyIterations; i++) {
-            for (j = 7; j >= 0; j--) {
-                k = (j + 1) % 8;
-                if (apduSize > 0) {
-                    m = apduBytes[--apduSize];
-                } else {
-                    m = 0;
-                }
-                n = ~(encryptValueOut[j] + j);
-                if (pKey[i % keyLength] & (1 << (7 - j))) {
-                    encryptValueOut[j] = encryptValueOut[k] + m + ((n << 1) + (n >> 7));
-                } else {
-                    encryptValueOut[j] = encryptValueOut[k] + m - ((n >> 1) + (n << 7));
+/*****************************************************************
+ Function:  EncryptWithSchedule
+ Returns:   None
+ Reference: Protocol Spec (Online version)
+ Purpose:   To compute the encryption value of the message formed
+ by prefix followed by data, using an expanded key.
+ Comments:  Message bytes are consumed from the end, as in the
+ original byte-at-a-time definition, eight per key byte
+ pass.  The key bit for each step is applied as a mask
+ rather than tested, and the eight steps of a pass are
+ unrolled so that the value stays in registers.
+ ******************************************************************/
+#define ENCRYPT_STEP(j)                                                                  \
+    do {                                                                                 \
+        IzotByte n = ~(value[j] + j);                                                    \
+        IzotByte left = (IzotByte)((n << 1) | (n >> 7));                                 \
+        IzotByte right = (IzotByte)((n >> 1) | (n << 7));                                \
+        value[j] = value[((j) + 1) & 7] + block[j] +                                     \
+                ((left & rotateLeft[j]) | ((IzotByte)-right & (IzotByte)~rotateLeft[j])); \
+    } while (0)
+
+static void EncryptWithSchedule(const AuthKeySchedule *schedule, const IzotByte randIn[],
+        const IzotByte *prefix, IzotUbits16 prefixSize, const IzotByte *data,
+        IzotUbits16 dataSize, IzotByte encryptValueOut[])
+{
+    int remaining = prefixSize + dataSize;
+    int i, j;
+    IzotByte value[8];
+    IzotByte block[8];  // Message byte for each step; step j uses block[j]
+
+    memcpy(value, randIn, sizeof(value));
+
+    while (remaining > 0) {
+        for (i = 0; i < schedule->keyIterations; i++) {
+            const IzotByte *rotateLeft = schedule->rotateLeft[i];
+            if (remaining >= prefixSize + 8) {
+                // Whole block within the APDU; steps 7..0 take bytes from the end
+                remaining -= 8;
+                memcpy(block, &data[remaining - prefixSize], sizeof(block));
+            } else {
+                for (j = 7; j >= 0; j--) {
+                    if (remaining > 0) {
+                        remaining--;
+                        block[j] = remaining >= prefixSize ? data[remaining - prefixSize]
+                                                           : prefix[remaining];
+                    } else {
+                        block[j] = 0;
+                    }
                 }
             }
+            ENCRYPT_STEP(7);
+            ENCRYPT_STEP(6);
+            ENCRYPT_STEP(5);
+            ENCRYPT_STEP(4);
+            ENCRYPT_STEP(3);
+            ENCRYPT_STEP(2);
+            ENCRYPT_STEP(1);
+            ENCRYPT_STEP(0);
         }
     }
+    memcpy(encryptValueOut, value, sizeof(value));
+}
+
+/*****************************************************************
+ Function:  GetAuthKeySchedule
+ Returns:   Expanded key for the given key bytes
+ Reference: None
+ Purpose:   To find the expanded form of an authentication key,
+ expanding it into the least recently built slot if it
+ is not already present.
+ Comments:  Matching on the key bytes keeps the cache correct no
+ matter which path updated the domain table.
+ ******************************************************************/
+static const AuthKeySchedule *GetAuthKeySchedule(const IzotByte *pKey, IzotByte isOma)
+{
+    int keyLength = isOma ? IZOT_OMA_AUTHENTICATION_KEY_LENGTH
+                          : IZOT_AUTHENTICATION_KEY_LENGTH;
+    AuthKeySchedule *schedule;
+    int i, j;
+
+    for (i = 0; i < AUTH_KEY_SCHEDULE_COUNT; i++) {
+        schedule = &authKeySchedules[i];
+        if (schedule->valid && schedule->isOma == isOma &&
+                memcmp(schedule->key, pKey, keyLength) == 0) {
+            return schedule;
+        }
+    }
+
+    schedule = &authKeySchedules[authKeyScheduleNext];
+    authKeyScheduleNext = (authKeyScheduleNext + 1) % AUTH_KEY_SCHEDULE_COUNT;
+
+    memset(schedule, 0, sizeof(*schedule));
+    memcpy(schedule->key, pKey, keyLength);
+    schedule->isOma = isOma ? TRUE : FALSE;
+    schedule->keyIterations = isOma ? AUTH_OMA_KEY_ITERATIONS : AUTH_KEY_ITERATIONS;
+    for (i = 0; i < schedule->keyIterations; i++) {
+        for (j = 0; j < 8; j++) {
+            schedule->rotateLeft[i][j] =
+                    (pKey[i % keyLength] & (1 << (7 - j))) ? 0xFF : 0x00;
+        }
+    }
+    schedule->valid = TRUE;
+    return schedule;
+}
+
+/*****************************************************************
+ Function:  TSA_RefreshAuthKeySchedules
+ Returns:   None
+ Reference: None
+ Purpose:   To discard expanded authentication keys and expand the
+ current domain keys.
+ Comments:  Called after a domain key update so that the next
+ authenticated message does not pay for the expansion
+ and old key material is not kept.
+ ******************************************************************/
+void TSA_RefreshAuthKeySchedules(void)
+{
+    IzotByte omaKey[MAX_DOMAINS][IZOT_AUTHENTICATION_KEY_LENGTH];
+    int i;
+
+    memset(authKeySchedules, 0, sizeof(authKeySchedules));
+    authKeyScheduleNext = 0;
+    for (i = 0; i < MAX_DOMAINS; i++) {
+        memcpy(omaKey[i], eep->domainTable[i].Key, sizeof(omaKey[i]));
+        (void)GetAuthKeySchedule(omaKey[i], FALSE);
+    }
+    (void)GetAuthKeySchedule((const IzotByte *)omaKey, TRUE);
 }
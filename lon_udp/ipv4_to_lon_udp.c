@@ -14,6 +14,7 @@
 
 #if PROTOCOL_IS(LON_IPV4) || PROTOCOL_IS(LON_IPV6)
 #include "lon_udp/ipv4_to_lon_udp.h"
+#include "lcs/lcs_network.h"
 
 // Access to Contiki global buffer
 #define UIP_IP_BUF ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
@@ -146,16 +147,16 @@ static IzotByte GetDomainLenEncoding(int domainLen)
  */
 static void RestoreIpMembership(void)
 {
-    IzotByte i;
-    uint32_t mc_addr = BROADCAST_PREFIX | 0x100;
+    IzotUbits16 group, domain;
     uint32_t bc_addr = BROADCAST_PREFIX;
 
-    // Group multicast membership
-    for (i = 0; i < eep->readOnlyData.Extended; i++) {
-        //Indicates the group entry in Address table
-        if (IZOT_GET_ATTRIBUTE(eep->addrTable[i].Group, IZOT_ADDRESS_GROUP_TYPE) == 1) {
-            mc_addr |= eep->addrTable[i].Group.Group;
-            AddIpMembership(mc_addr);
+    // Group multicast membership, once for each group in the Address table
+    for (group = 0; group <= 0xFF; group++) {
+        for (domain = 0; domain < MAX_DOMAINS; domain++) {
+            if (GroupAddrEntries((IzotByte)domain, (IzotByte)group, NULL)) {
+                AddIpMembership(BROADCAST_PREFIX | 0x100 | group);
+                break;
+            }
         }
     }
 
@@ -942,7 +943,7 @@ LonStatusCode LinkLayerUdpReset(void)
     }
     queueItemSize = gp->lkOutBufSize + sizeof(LKSendParam) + 21;
 
-    if (!LON_SUCCESS(status = QueueInit(&gp->lkOutQ, "link layer output", queueItemSize,
+    if (!LON_SUCCESS(status = StackQueueInit(&gp->lkOutQ, "link layer output", queueItemSize,
                              gp->lkOutQCnt))) {
         gp->resetOk = FALSE;
         OsalPrintLog(ERROR_LOG, status,
@@ -963,7 +964,7 @@ LonStatusCode LinkLayerUdpReset(void)
     }
     queueItemSize = gp->lkOutPriBufSize + sizeof(LKSendParam);
 
-    if (!LON_SUCCESS(status = QueueInit(&gp->lkOutPriQ, "link layer priority output",
+    if (!LON_SUCCESS(status = StackQueueInit(&gp->lkOutPriQ, "link layer priority output",
                              queueItemSize, gp->lkOutPriQCnt))) {
         gp->resetOk = FALSE;
         OsalPrintLog(ERROR_LOG, status,
@@ -1137,6 +1138,10 @@ void LinkLayerUdpReceive(void)
         if (LtVxLen == 0) {
             return;
         }
+        // Drop the packet if it is not addressed to this node
+        if (!NWAcceptFrame(&LtVxPayload[1], LtVxLen - 1)) {
+            return;
+        }
         int k;
         OsalPrintLog(PACKET_TRACE_LOG, LonStatusNoError,
                 "LON V0 or V2: %d byte recv: ", LtVxLen);
@@ -18,10 +18,20 @@
  * 			- Consumers:
  * 			  • ReadLonUsbMsg() drains lon_usb_uplink_ring_buffer and pops from
  *              uplink_queue to return a message to the caller
+ * 			- With USB_UPLINK_IS(EPOLL), UsbReaderThread() is the only producer
+ *              into lon_usb_uplink_ring_buffer for every interface; it waits
+ *              on all open interfaces with one HalWaitUsb() call, reads only
+ *              from interfaces with receive data, and signals
+ *              WaitLonUsbUplink(); ReadLonUsbMsg() then only parses
+ * 			- USB reads are made directly into a span reserved in
+ *              lon_usb_uplink_ring_buffer, and ProcessUplinkBytes() parses
+ *              contiguous spans in place; spans are reserved, committed,
+ *              peeked, and consumed under the lock, and filled or parsed
+ *              outside of it (single producer and single consumer)
  * 			- Locking rules:
  * 			  • Always OsalLockQueue(&state->queue_lock) before reading/writing
  *              lon_usb_uplink_ring_buffer or uplink_queue, including related
- *              stats updates
+ *              stats updates, and before reading/writing rx_paused
  *            • Keep the critical section minimal; perform parsing and other
  *              CPU work outside the lock • For uplink_queue pop, copy the node’s
  *              payload inside the lock, then free the node after unlocking to
@@ -58,6 +68,10 @@
 // Sequence number mask
 #define SEQ_NUM_MASK 0x07  // Sequence number mask (bits 0-2)
 
+// Uplink message bytes parsed one at a time before the message length is
+// known: length, command, and the two extended length bytes
+#define UPLINK_MSG_HEADER_BYTES 4
+
 // USB driver parameters and defaults
 #define DEFAULT_IN_TRANSFER_SIZE 4096
 #define DEFAULT_READ_TIMEOUT 500
@@ -156,6 +170,28 @@ LonUsbLinkState iface_state;  // Single interface state
 static LonUsbLinkState iface_state[MAX_IFACE_STATES];
 // Interface state array
 #endif                        // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
+#if STACK_STATIC_ALLOCATION
+// Queue and uplink ring buffer storage of each interface state
+typedef struct {
+    LonUsbQueueBuffer downlink_normal[MAX_LON_DOWNLINK_BUFFERS];
+    LonUsbQueueBuffer downlink_priority[MAX_LON_DOWNLINK_BUFFERS];
+    LonUsbQueueBuffer uplink_normal[MAX_LON_UPLINK_BUFFERS];
+    LonUsbQueueBuffer uplink_priority[MAX_LON_UPLINK_BUFFERS];
+    uint8_t uplink_ring[LON_USB_UPLINK_RING_CAPACITY];
+} LonUsbLinkStorage;
+#if (LON_USB_UPLINK_RING_CAPACITY & (LON_USB_UPLINK_RING_CAPACITY - 1)) != 0
+#error "LON_USB_UPLINK_RING_CAPACITY must be a power of two in the static build"
+#endif
+static LonUsbLinkStorage iface_storage[MAX_IFACE_STATES];
+#endif  // STACK_STATIC_ALLOCATION
+#if USB_UPLINK_IS(EPOLL)
+static int usb_wait_fd = -1;  // Wait set for all open LON USB interfaces
+static bool usb_reader_started = false;  // True once UsbReaderThread() runs
+static OsalHandle uplink_event = NULL;   // Set by UsbReaderThread() when
+                                         // uplink bytes are staged
+static int usb_wake_fd = -1;  // Signaled by ReadLonUsbMsg() to resume a
+                              // paused interface
+#endif  // USB_UPLINK_IS(EPOLL)
 
 /*****************************************************************
  * Section: Function Declarations
@@ -185,6 +221,9 @@ static LonStatusCode WriteDownlinkMessage(void);
 static LonStatusCode WriteDownlinkLocalNiCmd(void);
 static LonStatusCode WriteDownlinkCodePacket(LonUsbFrameCommand frame_cmd,
         uint8_t parameter);
+static LonStatusCode AddDownlinkBytes(const void *buf, size_t len);
+static LonStatusCode WriteDownlinkBatch(void);
+static LonStatusCode SetDownlinkBatching(bool batching);
 static LonStatusCode IncrementDownlinkSequence(void);
 static LonStatusCode StartAckTimer(DownlinkState next_state);
 static LonStatusCode ResetDownlinkState(void);
@@ -196,6 +235,9 @@ static LonStatusCode WriteDownlinkMessage(int iface_index);
 static LonStatusCode WriteDownlinkLocalNiCmd(int iface_index);
 static LonStatusCode WriteDownlinkCodePacket(int iface_index,
         LonUsbFrameCommand frame_cmd, uint8_t parameter);
+static LonStatusCode AddDownlinkBytes(int iface_index, const void *buf, size_t len);
+static LonStatusCode WriteDownlinkBatch(int iface_index);
+static LonStatusCode SetDownlinkBatching(int iface_index, bool batching);
 static LonStatusCode IncrementDownlinkSequence(int iface_index);
 static LonStatusCode StartAckTimer(int iface_index, DownlinkState next_state);
 static LonStatusCode ResetDownlinkState(int iface_index);
@@ -224,8 +266,25 @@ static LonStatusCode CheckUplinkCompleted(int iface_index, bool *completed);
 static LonStatusCode ProcessUplinkMessage(int iface_index);
 #endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
 static size_t TotalMessageLength(const LonNiFrame *msg);
+#if USB_UPLINK_IS(POLLING) || USB_UPLINK_IS(EPOLL)
+#if LINK_IS(USB_MIP)
+static LonStatusCode ReadUplinkBytes(size_t *bytes_read);
+#else   // LINK_IS(MULTIPLE_USB_MIPS)
+static LonStatusCode ReadUplinkBytes(int iface_index, size_t *bytes_read);
+#endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
+#endif  // USB_UPLINK_IS(POLLING) || USB_UPLINK_IS(EPOLL)
+
+// USB reader thread (multiple USB MIPS only)
+#if USB_UPLINK_IS(EPOLL)
+static LonStatusCode StartUsbReader(int iface_index);
+static void StopUsbReader(int iface_index);
+static bool ServiceUsbReader(int iface_index, bool hangup);
+static bool ResumeUsbReader(int iface_index);
+static void *UsbReaderThread(void *arg);
+#endif  // USB_UPLINK_IS(EPOLL)
 
 // Interface state array management
+static LonStatusCode InitIfaceBuffers(LonUsbLinkState *state);
 static LonStatusCode InitIfaceStates(void);
 #if LINK_IS(MULTIPLE_USB_MIPS)  // Multiple interface states only needed for
                                 // multiple USB MIP configuration
@@ -397,6 +456,16 @@ LonStatusCode OpenLonUsbLink(
 #endif  // OS_IS(LINUX)
 
     state->shutdown = false; // State initialization complete, allow resets
+#if USB_UPLINK_IS(EPOLL)
+    // Add the interface to the USB reader thread wait set
+    if (!LON_SUCCESS(status = StartUsbReader(*iface_index))) {
+        HalCloseUsb(state->usb_fd);
+        ResetUplinkState(*iface_index);
+        *iface_index = -1;
+        OsalPrintLog(ERROR_LOG, status, "OpenLonUsbLink: Failed to start USB reader");
+        return status;
+    }
+#endif  // USB_UPLINK_IS(EPOLL)
 
     // Start LON USB link
 #if LINK_IS(USB_MIP)
@@ -404,7 +473,11 @@ LonStatusCode OpenLonUsbLink(
         ResetUplinkState();
 #else   // LINK_IS(MULTIPLE_USB_MIPS)
     if (!LON_SUCCESS(status = StartLonUsbLink(*iface_index, LON_IFACE_MODE_LAYER2))) {
+#if USB_UPLINK_IS(EPOLL)
+        StopUsbReader(*iface_index);
+#else   // !USB_UPLINK_IS(EPOLL)
         HalCloseUsb(state->usb_fd);
+#endif  // USB_UPLINK_IS(EPOLL)
         ResetUplinkState(*iface_index);
         *iface_index = -1;
 #endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
@@ -810,6 +883,35 @@ bool LonUsbLinkReady(int iface_index)
     return state->ready;
 }
 
+#if LINK_IS(MULTIPLE_USB_MIPS)
+/*
+ * Reads the downlink load of a LON USB network interface.
+ * Parameters:
+ *   iface_index: LON interface index returned by OpenLonUsbLink()
+ *   queued: receives the number of downlink messages waiting to be sent
+ *   ack_latency: receives the average time in ms ticks from sending a
+ *             downlink frame to its ack
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful
+ * Notes:
+ *   Used by the link layer to choose an interface when several interfaces
+ *   are bonded on one channel.
+ */
+LonStatusCode GetLonUsbLinkLoad(int iface_index, size_t *queued, OsalTickCount *ack_latency)
+{
+    LonUsbLinkState *state = GetIfaceState(iface_index);
+    if (state == NULL || state->shutdown) {
+        return LonStatusInvalidInterfaceId;
+    }
+    if (!queued || !ack_latency) {
+        return LonStatusInvalidParameter;
+    }
+    *queued = GetDownlinkBufferCount(iface_index);
+    *ack_latency = state->downlink_ack_latency;
+    return LonStatusNoError;
+}
+#endif  // LINK_IS(MULTIPLE_USB_MIPS)
+
 /*****************************************************************
  * Section: Downlink Function Definitions
  *****************************************************************/
@@ -823,12 +925,20 @@ bool LonUsbLinkReady(int iface_index)
  * Notes: 
  *   The LCS_Service() event loop functions call this function periodically to
  * process pending downlink messages and retry attempts for failed messages.
+ * Frames built during one pass for an interface are gathered and written to
+ * the interface with a single USB write at the end of the pass.
  */
 void LonUsbDownlinkSend(void)
 {
     LonStatusCode status = LonStatusNoError;
+    LonStatusCode batch_status;
 #if LINK_IS(USB_MIP)
+    SetDownlinkBatching(true);
     status = ProcessDownlinkRequests();
+    batch_status = SetDownlinkBatching(false);
+    if (LON_SUCCESS(status)) {
+        status = batch_status;
+    }
 #else   // LINK_IS(MULTIPLE_USB_MIPS)
     int ni_index;
     // Send the next LPDU from all downlink queues to the associated LON network
@@ -836,8 +946,12 @@ void LonUsbDownlinkSend(void)
     for (ni_index = 0; (LON_SUCCESS(status)) && (ni_index < MAX_IFACE_STATES);
             ni_index++) {
         // Process downlink requests from the downlink queue to the USB interface
-
+        SetDownlinkBatching(ni_index, true);
         status = ProcessDownlinkRequests(ni_index);
+        batch_status = SetDownlinkBatching(ni_index, false);
+        if (LON_SUCCESS(status)) {
+            status = batch_status;
+        }
     }
 #endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
     if (!LON_SUCCESS(status)) {
@@ -1418,6 +1532,17 @@ static LonStatusCode ProcessNextDownlinkMessage(int iface_index)
             return status;
         }
     }
+    // Write a batched message before its downlink buffer is overwritten
+    if (state->downlink_batch_msgs) {
+#if LINK_IS(USB_MIP)
+        status = WriteDownlinkBatch();
+#else   // !LINK_IS(USB_MIP)
+        status = WriteDownlinkBatch(iface_index);
+#endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
+        if (!LON_SUCCESS(status)) {
+            return status;
+        }
+    }
     // Look for a downlink buffer to process
 #if LINK_IS(USB_MIP)
     status = ReadDownlinkBuffer(&state->downlink_buffer);
@@ -1766,7 +1891,10 @@ static LonStatusCode IncrementDownlinkSequence(int iface_index)
  *   Sends a code packet, expands the message by stuffing a FRAME_SYNC byte
  *   after any embedded FRAME_SYNC bytes, computes and adds a checksum,
  *   and writes the expanded message to the USB interface.  Called by
- *   ProcessDownlinkRequests().
+ *   ProcessDownlinkRequests().  The message is not copied; runs of the
+ *   downlink buffer between FRAME_SYNC bytes are added to the downlink batch
+ *   with the code packet, and the batch is written with a single USB write
+ *   by LonUsbDownlinkSend().
  */
 #if LINK_IS(USB_MIP)
 static LonStatusCode WriteDownlinkMessage(void)
@@ -1783,12 +1911,42 @@ static LonStatusCode WriteDownlinkMessage(int iface_index)
         return LonStatusInvalidInterfaceId;
     }
 #endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
+    static const uint8_t frame_sync_byte = FRAME_SYNC;
     LonStatusCode status = LonStatusNoError;
-    uint8_t *dest_exp_ni_data_frame_ptr, *src_data_frame, *src_data_frame_ptr,
-            message_byte;
-    size_t unexpanded_length, remaining;
+    const uint8_t *src_data_frame, *src_run, *sync;
+    size_t unexpanded_length, remaining, run_length;
     size_t expanded_length;
     uint8_t checksum;
+    // Write a previously batched message; the batch holds one message trailer
+    if (state->downlink_batch_msgs) {
+#if LINK_IS(USB_MIP)
+        status = WriteDownlinkBatch();
+#else   // !LINK_IS(USB_MIP)
+        status = WriteDownlinkBatch(iface_index);
+#endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
+        if (!LON_SUCCESS(status)) {
+            return status;
+        }
+    }
+    // Compute the expanded length with a stuffed FRAME_SYNC byte after each
+    // embedded FRAME_SYNC byte
+    src_data_frame = (const uint8_t *)&state->downlink_buffer.usb_ni_data_frame;
+    unexpanded_length = expanded_length = remaining =
+            state->downlink_buffer.data_frame_size;
+    checksum = -ComputeChecksum((uint8_t *)src_data_frame, unexpanded_length);
+    src_run = src_data_frame;
+    while (remaining && (sync = memchr(src_run, FRAME_SYNC, remaining)) != NULL) {
+        expanded_length++;
+        remaining -= (size_t)(sync - src_run) + 1;
+        src_run = sync + 1;
+    }
+    if (unexpanded_length && expanded_length >= MAX_EXP_LON_MSG_EX_LEN - 2) {
+        status = LonStatusInvalidBufferLength;
+        OsalPrintLog(ERROR_LOG, status,
+                "WriteDownlinkMessage: Expanded downlink message exceeds "
+                "buffer size");
+        return status;
+    }
     // Send code packet with ACK prior to the message packet
     state->downlink_ack_seq_number = ACK_WITH_NEXT_SEQ_NUM;
 #if LINK_IS(USB_MIP)
@@ -1796,33 +1954,51 @@ static LonStatusCode WriteDownlinkMessage(int iface_index)
 #else   // !LINK_IS(USB_MIP)
     WriteDownlinkCodePacket(iface_index, MSG_FRAME_CMD, 1);
 #endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
-    // Build the downlink message packet with byte expansion for FRAME_SYNC
-    // bytes
-    src_data_frame = (uint8_t *)&state->downlink_buffer.usb_ni_data_frame;
-    src_data_frame_ptr = src_data_frame;
-    unexpanded_length = expanded_length = remaining =
-            state->downlink_buffer.data_frame_size;
-    dest_exp_ni_data_frame_ptr = state->exp_downlink_ni_data_frame;
-    checksum = -ComputeChecksum(src_data_frame_ptr, unexpanded_length);
-    while (remaining--) {
-        message_byte = *dest_exp_ni_data_frame_ptr++ = *src_data_frame_ptr++;
-        if (message_byte == FRAME_SYNC) {
-            *dest_exp_ni_data_frame_ptr++ = FRAME_SYNC;
-            expanded_length++;
-        }
-        if (expanded_length >= sizeof(state->exp_downlink_ni_data_frame) - 2) {
-            status = LonStatusInvalidBufferLength;
-            OsalPrintLog(ERROR_LOG, status,
-                    "WriteDownlinkMessage: Expanded downlink message exceeds "
-                    "buffer size");
-            return status;
+    // Add the downlink message packet to the batch; each run ends with an
+    // embedded FRAME_SYNC byte that is followed by a stuffed FRAME_SYNC byte
+    src_run = src_data_frame;
+    remaining = unexpanded_length;
+    while (remaining && LON_SUCCESS(status)) {
+        sync = memchr(src_run, FRAME_SYNC, remaining);
+        run_length = sync ? (size_t)(sync - src_run) + 1 : remaining;
+#if LINK_IS(USB_MIP)
+        status = AddDownlinkBytes(src_run, run_length);
+        if (sync && LON_SUCCESS(status)) {
+            status = AddDownlinkBytes(&frame_sync_byte, 1);
+        }
+#else   // !LINK_IS(USB_MIP)
+        status = AddDownlinkBytes(iface_index, src_run, run_length);
+        if (sync && LON_SUCCESS(status)) {
+            status = AddDownlinkBytes(iface_index, &frame_sync_byte, 1);
         }
+#endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
+        src_run += run_length;
+        remaining -= run_length;
     }
-    if ((*dest_exp_ni_data_frame_ptr++ = checksum) == FRAME_SYNC) {
-        *dest_exp_ni_data_frame_ptr++ = FRAME_SYNC;
+    state->downlink_batch_trailer[0] = checksum;
+    state->downlink_batch_trailer[1] = FRAME_SYNC;
+    expanded_length++;  // For checksum byte
+    if (checksum == FRAME_SYNC) {
         expanded_length++;  // For stuffed checksum FRAME_SYNC byte
     }
-    expanded_length++;  // For checksum byte
+    if (LON_SUCCESS(status)) {
+#if LINK_IS(USB_MIP)
+        status = AddDownlinkBytes(state->downlink_batch_trailer,
+                (checksum == FRAME_SYNC) ? 2 : 1);
+#else   // !LINK_IS(USB_MIP)
+        status = AddDownlinkBytes(iface_index, state->downlink_batch_trailer,
+                (checksum == FRAME_SYNC) ? 2 : 1);
+#endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
+    }
+    if (!LON_SUCCESS(status)) {
+        OsalPrintLog(INFO_LOG, status,
+                "WriteDownlinkMessage: Failed to write %zu byte message to LON "
+                "USB interface",
+                expanded_length);
+        return status;
+    }
+    state->downlink_batch_msgs++;
+    state->downlink_batch_msg_bytes += expanded_length;
     // Optionally log the message being sent
     OsalPrintLog(DETAIL_TRACE_LOG, status,
             "WriteDownlinkMessage: Send message to USB with code 0x%02X, "
@@ -1831,9 +2007,6 @@ static LonStatusCode WriteDownlinkMessage(int iface_index)
             expanded_length, state->downlink_seq_number);
     OsalPrintMessage(DETAIL_TRACE_LOG,
             "WriteDownlinkMessage (not expanded): ", src_data_frame, unexpanded_length);
-    OsalPrintMessage(DETAIL_TRACE_LOG,
-            "WriteDownlinkMessage (expanded):     ", state->exp_downlink_ni_data_frame,
-            expanded_length);
     if (state->downlink_state >= DOWNLINK_IDLE_START) {
         // Start the ACK timer for the downlink message
 #if LINK_IS(USB_MIP)
@@ -1847,21 +2020,14 @@ static LonStatusCode WriteDownlinkMessage(int iface_index)
             return status;
         }
     }
-    // Write the expanded message to the LON USB interface
-    size_t bytes_written = 0;
-    status = HalWriteUsb(state->usb_fd, state->exp_downlink_ni_data_frame,
-            expanded_length, &bytes_written);
-    if (!LON_SUCCESS(status) || bytes_written != expanded_length) {
-        OsalPrintLog(INFO_LOG, status,
-                "WriteDownlinkMessage: Wrote %zu of %d bytes to LON USB "
-                "interface",
-                bytes_written, expanded_length);
-        Increment32(state->lon_stats.downlink.tx_aborted_errors);
-        return (!LON_SUCCESS(status)) ? LonStatusWriteFailed : status;
+    // Write the batch now unless LonUsbDownlinkSend() is gathering frames
+    if (!state->downlink_batching) {
+#if LINK_IS(USB_MIP)
+        status = WriteDownlinkBatch();
+#else   // !LINK_IS(USB_MIP)
+        status = WriteDownlinkBatch(iface_index);
+#endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
     }
-    // Update statistics
-    Increment32(state->lon_stats.downlink.packets_sent);
-    Add32(state->lon_stats.downlink.bytes_sent, bytes_written);
     return status;
 }
 
@@ -1927,6 +2093,20 @@ static LonStatusCode WriteDownlinkCodePacket(
     LonStatusCode status = LonStatusNoError;
     LonFrameHeader frame_header;
     int sequence_num = 0;
+    // Make room for the code packet in the downlink batch.  Write the batch
+    // here rather than in AddDownlinkBytes() when the I/O vector is full, as
+    // that would empty the batch after the code packet slot is taken.
+    if (state->downlink_batch_cp_count >= MAX_DOWNLINK_BATCH_CODE_PACKETS ||
+            state->downlink_batch_iov_count >= HAL_USB_MAX_IOV) {
+#if LINK_IS(USB_MIP)
+        status = WriteDownlinkBatch();
+#else   // !LINK_IS(USB_MIP)
+        status = WriteDownlinkBatch(iface_index);
+#endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
+        if (!LON_SUCCESS(status)) {
+            return status;
+        }
+    }
     // Build the frame header
     memset(&frame_header, 0, sizeof(frame_header));
     frame_header.frame_sync = FRAME_SYNC;
@@ -1950,10 +2130,22 @@ static LonStatusCode WriteDownlinkCodePacket(
     // Compute the checksum and negate it; don't include the checksum byte itself
     frame_header.checksum =
             -ComputeChecksum((uint8_t *)&frame_header, sizeof(frame_header) - 1);
-    // Send the code packet
-    size_t bytes_written = 0;
-    status = HalWriteUsb(state->usb_fd, (uint8_t *)&frame_header, sizeof(frame_header),
-            &bytes_written);
+    // Add the code packet to the downlink batch, and send it now unless
+    // LonUsbDownlinkSend() is gathering frames
+    LonFrameHeader *batch_header =
+            &state->downlink_batch_cps[state->downlink_batch_cp_count++];
+    *batch_header = frame_header;
+#if LINK_IS(USB_MIP)
+    status = AddDownlinkBytes(batch_header, sizeof(*batch_header));
+    if (LON_SUCCESS(status) && !state->downlink_batching) {
+        status = WriteDownlinkBatch();
+    }
+#else   // !LINK_IS(USB_MIP)
+    status = AddDownlinkBytes(iface_index, batch_header, sizeof(*batch_header));
+    if (LON_SUCCESS(status) && !state->downlink_batching) {
+        status = WriteDownlinkBatch(iface_index);
+    }
+#endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
     if (!LON_SUCCESS(status)) {
         OsalPrintLog(ERROR_LOG, status,
                 "WriteDownlinkCodePacket: Failed to write downlink code "
@@ -1961,13 +2153,6 @@ static LonStatusCode WriteDownlinkCodePacket(
                 frame_cmd, parameter, sequence_num);
         return status;
     }
-    if (bytes_written != sizeof(frame_header)) {
-        OsalPrintLog(ERROR_LOG, LonStatusLniWriteFailure,
-                "WriteDownlinkCodePacket: Failed to write downlink code "
-                "packet with command 0x%02X, parameter 0x%02X, sequence %02X",
-                frame_cmd, parameter, sequence_num);
-        return LonStatusLniWriteFailure;
-    }
     // Reset sequence number to 0 for the next message if this is a sync frame
     // code
     if (frame_cmd == NI_RESYNC_FRAME_CMD) {
@@ -1981,6 +2166,153 @@ static LonStatusCode WriteDownlinkCodePacket(
     return status;
 }
 
+/*
+ * Adds a buffer to the downlink batch for the LON USB network interface.
+ * Parameters:
+ *   iface_index: interface index returned by OpenLonUsbLink()
+ *             (multiple USB MIPS only)
+ *   buf: pointer to the bytes to add; must remain unchanged until the batch
+ *        is written
+ *   len: number of bytes to add
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful
+ * Notes:
+ *   Writes the batch first if all batch entries are in use.
+ */
+#if LINK_IS(USB_MIP)
+static LonStatusCode AddDownlinkBytes(const void *buf, size_t len)
+{
+    LonUsbLinkState *state = &iface_state;
+    if (state->shutdown) {
+        return LonStatusInvalidInterfaceId;
+    }
+#else   // !LINK_IS(USB_MIP)
+static LonStatusCode AddDownlinkBytes(int iface_index, const void *buf, size_t len)
+{
+    LonUsbLinkState *state = GetIfaceState(iface_index);
+    if (state == NULL || state->shutdown) {
+        return LonStatusInvalidInterfaceId;
+    }
+#endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
+    LonStatusCode status = LonStatusNoError;
+    if (len == 0) {
+        return status;
+    }
+    if (state->downlink_batch_iov_count >= HAL_USB_MAX_IOV) {
+#if LINK_IS(USB_MIP)
+        status = WriteDownlinkBatch();
+#else   // !LINK_IS(USB_MIP)
+        status = WriteDownlinkBatch(iface_index);
+#endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
+        if (!LON_SUCCESS(status)) {
+            return status;
+        }
+    }
+    HalUsbIoVec *iov = &state->downlink_batch_iov[state->downlink_batch_iov_count++];
+    iov->base = buf;
+    iov->len = len;
+    return status;
+}
+
+/*
+ * Writes the downlink batch to the LON USB network interface.
+ * Parameters:
+ *   iface_index: interface index returned by OpenLonUsbLink()
+ *             (multiple USB MIPS only)
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful
+ * Notes:
+ *   Code packets and messages added since the last write are sent with one
+ *   HalWriteUsbV() call.  The batch is emptied whether or not the write
+ *   succeeds.
+ */
+#if LINK_IS(USB_MIP)
+static LonStatusCode WriteDownlinkBatch(void)
+{
+    LonUsbLinkState *state = &iface_state;
+    if (state->shutdown) {
+        return LonStatusInvalidInterfaceId;
+    }
+#else   // !LINK_IS(USB_MIP)
+static LonStatusCode WriteDownlinkBatch(int iface_index)
+{
+    LonUsbLinkState *state = GetIfaceState(iface_index);
+    if (state == NULL || state->shutdown) {
+        return LonStatusInvalidInterfaceId;
+    }
+#endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
+    LonStatusCode status = LonStatusNoError;
+    if (state->downlink_batch_iov_count == 0) {
+        return status;
+    }
+    size_t expected_length = 0;
+    for (int i = 0; i < state->downlink_batch_iov_count; i++) {
+        expected_length += state->downlink_batch_iov[i].len;
+    }
+    size_t bytes_written = 0;
+    status = HalWriteUsbV(state->usb_fd, state->downlink_batch_iov,
+            state->downlink_batch_iov_count, &bytes_written);
+    Increment32(state->lon_stats.downlink.tx_writes);
+    if (!LON_SUCCESS(status) || bytes_written != expected_length) {
+        OsalPrintLog(INFO_LOG, status,
+                "WriteDownlinkBatch: Wrote %zu of %zu bytes to LON USB "
+                "interface",
+                bytes_written, expected_length);
+        Increment32(state->lon_stats.downlink.tx_aborted_errors);
+        status = (!LON_SUCCESS(status)) ? LonStatusWriteFailed : LonStatusLniWriteFailure;
+    } else if (state->downlink_batch_msgs) {
+        // Update statistics
+        Add32(state->lon_stats.downlink.packets_sent, state->downlink_batch_msgs);
+        Add32(state->lon_stats.downlink.bytes_sent, state->downlink_batch_msg_bytes);
+    }
+    state->downlink_batch_iov_count = 0;
+    state->downlink_batch_cp_count = 0;
+    state->downlink_batch_msgs = 0;
+    state->downlink_batch_msg_bytes = 0;
+    return status;
+}
+
+/*
+ * Starts or ends gathering of downlink frames into the downlink batch.
+ * Parameters:
+ *   iface_index: interface index returned by OpenLonUsbLink()
+ *             (multiple USB MIPS only)
+ *   batching: true to gather frames; false to write the batch and write
+ *             each subsequent frame when it is built
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful
+ * Notes:
+ *   Called by LonUsbDownlinkSend() around each downlink pass so that the
+ *   code packets and message built in one pass share one USB write.  The
+ *   MIP flow control allows one unacknowledged message, so a batch holds at
+ *   most one message.
+ */
+#if LINK_IS(USB_MIP)
+static LonStatusCode SetDownlinkBatching(bool batching)
+{
+    LonUsbLinkState *state = &iface_state;
+    if (state->shutdown) {
+        return LonStatusInvalidInterfaceId;
+    }
+#else   // !LINK_IS(USB_MIP)
+static LonStatusCode SetDownlinkBatching(int iface_index, bool batching)
+{
+    LonUsbLinkState *state = GetIfaceState(iface_index);
+    if (state == NULL || state->shutdown) {
+        return LonStatusInvalidInterfaceId;
+    }
+#endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
+    state->downlink_batching = batching;
+    if (batching) {
+        return LonStatusNoError;
+    }
+#if LINK_IS(USB_MIP)
+    return WriteDownlinkBatch();
+#else   // !LINK_IS(USB_MIP)
+    return WriteDownlinkBatch(iface_index);
+#endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
+}
+
 /*
  * Writes a downlink local NI command to the LON USB network interface.
  * Parameters:
@@ -2103,6 +2435,14 @@ static LonStatusCode ResetDownlinkState(int iface_index)
     }
 #endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
     LonStatusCode status = LonStatusNoError;
+    // Write a batched message before its downlink buffer is cleared
+    if (state->downlink_batch_msgs && !state->shutdown) {
+#if LINK_IS(USB_MIP)
+        WriteDownlinkBatch();
+#else   // !LINK_IS(USB_MIP)
+        WriteDownlinkBatch(iface_index);
+#endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
+    }
     OsalLockMutex(&state->state_lock);
     if (state->downlink_buffer.buf_size > 0) {
         memset(&state->downlink_buffer, 0, sizeof(state->downlink_buffer));
@@ -2199,89 +2539,63 @@ LonStatusCode ReadLonUsbMsg(
     LonStatusCode status = LonStatusNoError;
 
 #if USB_UPLINK_IS(POLLING)
-    // Stage 1: attempt a non-blocking read into a temporary buffer
-    int fd = state->usb_fd;
-    // Check available ring capacity under queue_lock to avoid over-pulling from
-    // USB
-    size_t rb_avail = 0;
-    // Lock ring to safely check available capacity; another thread may feed
-    // concurrently Protect queue head access; other threads may enqueue/dequeue
-    // concurrently
-    OsalLockQueue(&state->queue_lock);
-    rb_avail = RingBufferAvail(&state->lon_usb_uplink_ring_buffer);
-    OsalUnlockQueue(&state->queue_lock);  // Keep critical section minimal
-    if (fd >= 0 && rb_avail > MAX_BYTES_PER_USB_READ) {
-        uint8_t temp_read_buf[MAX_BYTES_PER_USB_READ];
-        ssize_t bytes_read = 0;
-        status = HalReadUsb(fd, temp_read_buf, sizeof(temp_read_buf), &bytes_read);
-        if (LON_SUCCESS(status) && bytes_read > 0) {
-            // Lock ring while writing staged bytes and updating staging stats
-            OsalLockMutex(&state->queue_lock);
-            size_t written = RingBufferWrite(&state->lon_usb_uplink_ring_buffer,
-                    temp_read_buf, (size_t)bytes_read);
-            size_t occ = RingBufferSize(&state->lon_usb_uplink_ring_buffer);
-            state->lon_stats.usb_rx.bytes_fed += written;
-            if (occ > state->lon_stats.usb_rx.max_occupancy) {
-                state->lon_stats.usb_rx.max_occupancy = occ;
-            }
-            if (written < (size_t)bytes_read) {
-                size_t dropped = (size_t)bytes_read - written;
-                state->lon_stats.usb_rx.bytes_dropped += dropped;
-                OsalUnlockQueue(&state->queue_lock);  // Release before logging
-                OsalPrintLog(ERROR_LOG, LonStatusOverflow,
-                        "ReadLonUsbMsg: RX ring overflow, dropped %zu of "
-                        "%zd bytes",
-                        dropped, bytes_read);
-            } else {
-                OsalUnlockQueue(&state->queue_lock);  // Leave lock before returning
-            }
-        } else if (!LON_SUCCESS(status) && status != LonStatusNoMessageAvailable) {
-            // Propagate hard error (timeout/device/read failure)
-            return status;
-        }
+    // Stage 1: attempt a non-blocking read directly into the free space of the
+    // ring buffer
+    size_t bytes_read = 0;
+#if LINK_IS(USB_MIP)
+    status = ReadUplinkBytes(&bytes_read);
+#else   // LINK_IS(MULTIPLE_USB_MIPS)
+    status = ReadUplinkBytes(iface_index, &bytes_read);
+#endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
+    if (!LON_SUCCESS(status)) {
+        // Propagate hard error (timeout/device/read failure)
+        return status;
     }
 #endif  // USB_UPLINK_IS(POLLING)
 
-    // Stage 2: drain any accumulated bytes from the ring buffer in modest
-    // chunks and feed the parser--this allows smoothing of bursty UART/USB
-    // input and reduces immediate stack usage; skip if no space in uplink buffer;
-    // lock ring to snapshot count--parser will process outside of lock;
-    // protect pop of head node to avoid races with concurrent writers/readers
+    // Stage 2: parse accumulated bytes in place from the ring buffer in
+    // modest chunks--this allows smoothing of bursty UART/USB input without
+    // copying the bytes out of the ring; skip if no space in uplink buffer;
+    // lock ring to snapshot a contiguous span--parser processes it outside of
+    // the lock and the span is consumed afterward under the lock
+#if USB_UPLINK_IS(EPOLL)
+    bool resume_reader = false;  // True to resume a paused USB reader
+#endif  // USB_UPLINK_IS(EPOLL)
     OsalLockQueue(&state->queue_lock);
     size_t ring_count = RingBufferSize(&state->lon_usb_uplink_ring_buffer);
-    OsalUnlockQueue(
-            &state->queue_lock);  // Free outside of lock to keep critical section small
+    OsalUnlockQueue(&state->queue_lock);
 #if LINK_IS(USB_MIP)
     if (ring_count > 0 && GetUplinkBufferCount() < MAX_LON_UPLINK_BUFFERS) {
 #else   // LINK_IS(MULTIPLE_USB_MIPS)
     if (ring_count > 0 && GetUplinkBufferCount(iface_index) < MAX_LON_UPLINK_BUFFERS) {
 #endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
-        uint8_t parse_chunk[MAX_BYTES_PER_USB_PARSE_CHUNK];
         size_t processed_in_window = 0;
         for (;;) {
-            // Lock ring for atomic read of a chunk--keep scope tight;
-            // protect tail walk and append under lock--single-linked O(n) by design
+            // Lock ring only to locate the contiguous span at the read position
+            const uint8_t *parse_span = NULL;
             OsalLockQueue(&state->queue_lock);
-            size_t cur_count = RingBufferSize(&state->lon_usb_uplink_ring_buffer);
-            if (cur_count == 0) {
-                OsalUnlockQueue(&state->queue_lock);
-                break;
-            }
-            size_t chunk_size = RingBufferRead(&state->lon_usb_uplink_ring_buffer,
-                    parse_chunk, sizeof(parse_chunk));
+            size_t chunk_size = RingBufferReadPeekContiguous(
+                    &state->lon_usb_uplink_ring_buffer, &parse_span);
             OsalUnlockQueue(&state->queue_lock);
             if (chunk_size == 0) {
-                break;  // Should not happen
+                break;
+            }
+            if (chunk_size > MAX_BYTES_PER_USB_PARSE_CHUNK) {
+                chunk_size = MAX_BYTES_PER_USB_PARSE_CHUNK;
             }
 #if LINK_IS(USB_MIP)
-            ProcessUplinkBytes(parse_chunk, chunk_size);
+            ProcessUplinkBytes((uint8_t *)parse_span, chunk_size);
 #else   // LINK_IS(MULTIPLE_USB_MIPS)
-            ProcessUplinkBytes(iface_index, parse_chunk, chunk_size);
+            ProcessUplinkBytes(iface_index, (uint8_t *)parse_span, chunk_size);
 #endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
-            // Update staging stats under lock to avoid races with feeder
-            // Protect O(n) count traversal to avoid concurrent mutation
+            // Consume the parsed span and update staging stats under lock to
+            // avoid races with the feeder
             OsalLockQueue(&state->queue_lock);
+            RingBufferReadConsume(&state->lon_usb_uplink_ring_buffer, chunk_size);
             state->lon_stats.usb_rx.bytes_read += chunk_size;
+#if USB_UPLINK_IS(EPOLL)
+            resume_reader |= state->rx_paused;
+#endif  // USB_UPLINK_IS(EPOLL)
             OsalUnlockQueue(&state->queue_lock);
             processed_in_window += chunk_size;
             // Break early if a message has been queued to minimize per-call latency
@@ -2301,6 +2615,11 @@ LonStatusCode ReadLonUsbMsg(
             }
         }
     }
+#if USB_UPLINK_IS(EPOLL)
+    if (resume_reader) {
+        HalSignalUsbWakeup(usb_wake_fd);
+    }
+#endif  // USB_UPLINK_IS(EPOLL)
 
     // Stage 3: if a message is available, return it
     static LonUsbQueueBuffer buffer;
@@ -2335,6 +2654,287 @@ LonStatusCode ReadLonUsbMsg(
     return LonStatusNoBufferAvailable;
 }
 
+#if USB_UPLINK_IS(POLLING) || USB_UPLINK_IS(EPOLL)
+/*
+ * Reads available bytes from the LON USB interface into the uplink ring buffer.
+ * Parameters:
+ *   iface_index: interface index returned by OpenLonUsbLink()
+ *             (multiple USB MIPS only)
+ *   bytes_read: pointer to receive the number of bytes read; 0 if no data is
+ *             available or the ring buffer is full
+ * Returns:
+ *   LonStatusNoError on success, including when no data is available;
+ *   LonStatusCode error code if unsuccessful
+ * Notes:
+ *   Performs one non-blocking read of up to MAX_BYTES_PER_USB_READ bytes
+ *   directly into the free space of the ring buffer.  The span is reserved
+ *   under queue_lock and filled outside of the lock since the caller is the
+ *   only producer and the consumer never touches free space; the bytes read
+ *   are committed under the lock.
+ */
+#if LINK_IS(USB_MIP)
+static LonStatusCode ReadUplinkBytes(size_t *bytes_read)
+{
+    LonUsbLinkState *state = &iface_state;
+    if (state->shutdown) {
+        return LonStatusInvalidInterfaceId;
+    }
+#else   // LINK_IS(MULTIPLE_USB_MIPS)
+static LonStatusCode ReadUplinkBytes(int iface_index, size_t *bytes_read)
+{
+    LonUsbLinkState *state = GetIfaceState(iface_index);
+    if (state == NULL || state->shutdown) {
+        return LonStatusInvalidInterfaceId;
+    }
+#endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
+    LonStatusCode status = LonStatusNoError;
+    *bytes_read = 0;
+    int fd = state->usb_fd;
+    uint8_t *rb_span = NULL;
+    OsalLockQueue(&state->queue_lock);
+    size_t rb_span_len =
+            RingBufferWriteReserve(&state->lon_usb_uplink_ring_buffer, &rb_span);
+    OsalUnlockQueue(&state->queue_lock);  // Keep critical section minimal
+    if (fd < 0 || rb_span_len == 0) {
+        return status;
+    }
+    ssize_t usb_bytes_read = 0;
+    if (rb_span_len > MAX_BYTES_PER_USB_READ) {
+        rb_span_len = MAX_BYTES_PER_USB_READ;
+    }
+    status = HalReadUsb(fd, rb_span, rb_span_len, &usb_bytes_read);
+    if (LON_SUCCESS(status) && usb_bytes_read > 0) {
+        // Lock ring while committing read bytes and updating staging stats
+        OsalLockQueue(&state->queue_lock);
+        size_t written = RingBufferWriteCommit(&state->lon_usb_uplink_ring_buffer,
+                (size_t)usb_bytes_read);
+        size_t occ = RingBufferSize(&state->lon_usb_uplink_ring_buffer);
+        state->lon_stats.usb_rx.bytes_fed += written;
+        if (occ > state->lon_stats.usb_rx.max_occupancy) {
+            state->lon_stats.usb_rx.max_occupancy = occ;
+        }
+        OsalUnlockQueue(&state->queue_lock);
+        *bytes_read = written;
+    } else if (status == LonStatusNoMessageAvailable) {
+        status = LonStatusNoError;
+    }
+    return status;
+}
+#endif  // USB_UPLINK_IS(POLLING) || USB_UPLINK_IS(EPOLL)
+
+#if USB_UPLINK_IS(EPOLL)
+/*
+ * Adds a LON USB interface to the USB reader thread wait set.
+ * Parameters:
+ *   iface_index: interface index returned by OpenLonUsbLink()
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful
+ * Notes:
+ *   Creates the wait set, the uplink event, and the USB reader thread on the
+ *   first call.
+ */
+static LonStatusCode StartUsbReader(int iface_index)
+{
+    LonUsbLinkState *state = GetIfaceState(iface_index);
+    if (state == NULL || state->shutdown) {
+        return LonStatusInvalidInterfaceId;
+    }
+    LonStatusCode status = LonStatusNoError;
+    if (!usb_reader_started) {
+        if (!LON_SUCCESS(status = HalCreateUsbWaitSet(&usb_wait_fd))) {
+            return status;
+        }
+        if (!LON_SUCCESS(status = HalCreateUsbWakeup(usb_wait_fd, &usb_wake_fd))) {
+            return status;
+        }
+        if (!LON_SUCCESS(status = OsalCreateEvent(&uplink_event))) {
+            OsalPrintLog(ERROR_LOG, status,
+                    "StartUsbReader: Failed to create uplink event");
+            return status;
+        }
+        if (!OsalCreateThread(UsbReaderThread, NULL)) {
+            status = LonStatusCreateFailure;
+            OsalPrintLog(ERROR_LOG, status,
+                    "StartUsbReader: Failed to create USB reader thread");
+            return status;
+        }
+        usb_reader_started = true;
+    }
+    OsalLockQueue(&state->queue_lock);
+    state->rx_paused = false;
+    OsalUnlockQueue(&state->queue_lock);
+    return HalArmUsbWait(usb_wait_fd, state->usb_fd, iface_index);
+}
+
+/*
+ * Removes a LON USB interface from the USB reader thread wait set and closes
+ * the USB interface.
+ * Parameters:
+ *   iface_index: interface index returned by OpenLonUsbLink()
+ * Returns:
+ *   None
+ * Notes:
+ *   Called by CloseLonUsbLink().  The state lock is held while the interface
+ *   is removed and closed so that a read in progress by the USB reader thread
+ *   completes first, and a later read finds no file descriptor.
+ */
+static void StopUsbReader(int iface_index)
+{
+    LonUsbLinkState *state = GetIfaceState(iface_index);
+    if (state == NULL) {
+        return;
+    }
+    OsalLockMutex(&state->state_lock);
+    if (state->usb_fd >= 0) {
+        if (usb_reader_started) {
+            HalDisarmUsbWait(usb_wait_fd, state->usb_fd);
+        }
+        HalCloseUsb(state->usb_fd);
+        state->usb_fd = -1;
+    }
+    OsalLockQueue(&state->queue_lock);
+    state->rx_paused = false;
+    OsalUnlockQueue(&state->queue_lock);
+    OsalUnlockMutex(&state->state_lock);
+}
+
+/*
+ * Reads all available bytes from a LON USB interface for the USB reader
+ * thread.
+ * Parameters:
+ *   iface_index: interface index returned by OpenLonUsbLink()
+ *   hangup: true if HalWaitUsb() reported that the interface hung up or
+ *             failed
+ * Returns:
+ *   True if any bytes were staged in the uplink ring buffer
+ * Notes:
+ *   Reads until no more data is available, then re-arms the interface in
+ *   the wait set.  If the ring buffer fills, the interface is paused instead
+ *   and resumed by ResumeUsbReader() once ReadLonUsbMsg() makes room.  A
+ *   failed interface is removed from the wait set.
+ */
+static bool ServiceUsbReader(int iface_index, bool hangup)
+{
+    LonUsbLinkState *state = GetIfaceState(iface_index);
+    if (state == NULL) {
+        return false;
+    }
+    LonStatusCode status = LonStatusNoError;
+    size_t bytes_read = 0;
+    size_t total_read = 0;
+    OsalLockMutex(&state->state_lock);
+    if (state->shutdown || state->usb_fd < 0) {
+        OsalUnlockMutex(&state->state_lock);
+        return false;
+    }
+    do {
+        status = ReadUplinkBytes(iface_index, &bytes_read);
+        total_read += bytes_read;
+    } while (LON_SUCCESS(status) && bytes_read > 0);
+    // A hung up interface reads no data rather than failing, and would
+    // otherwise be reported again on every wait
+    if (LON_SUCCESS(status) && hangup) {
+        status = LonStatusInterfaceError;
+    }
+    // Set the paused state under the queue lock so that ReadLonUsbMsg()
+    // either sees it or has already made room
+    OsalLockQueue(&state->queue_lock);
+    state->rx_paused = LON_SUCCESS(status)
+            && RingBufferAvail(&state->lon_usb_uplink_ring_buffer) == 0;
+    bool paused = state->rx_paused;
+    OsalUnlockQueue(&state->queue_lock);
+    if (!LON_SUCCESS(status)) {
+        HalDisarmUsbWait(usb_wait_fd, state->usb_fd);
+        OsalPrintLog(ERROR_LOG, status,
+                "ServiceUsbReader: Stopped reading LON USB interface %d", iface_index);
+    } else if (!paused) {
+        HalArmUsbWait(usb_wait_fd, state->usb_fd, iface_index);
+    }
+    OsalUnlockMutex(&state->state_lock);
+    return total_read > 0;
+}
+
+/*
+ * Resumes reading a LON USB interface paused for a full ring buffer.
+ * Parameters:
+ *   iface_index: interface index returned by OpenLonUsbLink()
+ * Returns:
+ *   True if any bytes were staged in the uplink ring buffer
+ */
+static bool ResumeUsbReader(int iface_index)
+{
+    LonUsbLinkState *state = GetIfaceState(iface_index);
+    if (state == NULL) {
+        return false;
+    }
+    OsalLockQueue(&state->queue_lock);
+    bool paused = state->rx_paused;
+    OsalUnlockQueue(&state->queue_lock);
+    return paused && ServiceUsbReader(iface_index, false);
+}
+
+/*
+ * USB reader thread entry point.
+ * Parameters:
+ *   arg: not used
+ * Returns:
+ *   Does not return
+ * Notes:
+ *   Waits on all open LON USB interfaces with one HalWaitUsb() call and
+ *   reads only from interfaces with receive data, so an idle gateway makes
+ *   no read calls regardless of the number of interfaces.  Signals the
+ *   uplink event for WaitLonUsbUplink() when bytes are staged.  An
+ *   interface paused for a full ring buffer is resumed when ReadLonUsbMsg()
+ *   signals the wakeup event.
+ */
+static void *UsbReaderThread(void *arg)
+{
+    (void)arg;
+    int ready_ifaces[HAL_USB_MAX_WAIT_EVENTS];
+    bool hangup[HAL_USB_MAX_WAIT_EVENTS];
+    for (;;) {
+        int ready_count = 0;
+        if (!LON_SUCCESS(HalWaitUsb(usb_wait_fd, LON_USB_READER_WAIT_MS,
+                    ready_ifaces, hangup, HAL_USB_MAX_WAIT_EVENTS, &ready_count))) {
+            OsalSleep(LON_USB_READER_WAIT_MS);
+            continue;
+        }
+        bool staged = false;
+        for (int i = 0; i < ready_count; i++) {
+            if (ready_ifaces[i] != HAL_USB_WAKEUP_INDEX) {
+                staged |= ServiceUsbReader(ready_ifaces[i], hangup[i]);
+                continue;
+            }
+            HalClearUsbWakeup(usb_wake_fd);
+            for (int iface_index = 0; iface_index < MAX_IFACE_STATES; iface_index++) {
+                staged |= ResumeUsbReader(iface_index);
+            }
+        }
+        if (staged) {
+            OsalSetEvent(uplink_event);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Waits for uplink data from any LON USB network interface.
+ * Parameters:
+ *   wait_ms: maximum time to wait in milliseconds
+ * Returns:
+ *   LonStatusNoError if uplink data was received since the last call;
+ *   LonStatusTimeout if no uplink data was received within wait_ms;
+ *   LonStatusCode error code if unsuccessful
+ */
+LonStatusCode WaitLonUsbUplink(unsigned int wait_ms)
+{
+    if (!usb_reader_started) {
+        return LonStatusNotOpen;
+    }
+    return OsalWaitForEvent(uplink_event, wait_ms);
+}
+#endif  // USB_UPLINK_IS(EPOLL)
+
 /*
  * Interrupt Service Routine to handle an uplink message interrupt from the LON
  * USB interface. Parameters: iface_index: interface index returned by
@@ -2598,12 +3198,51 @@ static LonStatusCode ProcessUplinkBytes(
             break;
         case UPLINK_MESSAGE:
             while (chunk_size) {
-                uint8_t msg_byte = ((uint8_t *)&state->uplink_buffer
-                                .usb_ni_data_frame)[state->uplink_msg_index++] = *chunk++;
-                chunk_size--;
-                if (msg_byte == FRAME_SYNC) {
-                    state->uplink_state = UPLINK_ESCAPED_DATA;
-                    break;
+                uint8_t *msg_buf = (uint8_t *)&state->uplink_buffer.usb_ni_data_frame;
+                if (state->uplink_msg_index >= UPLINK_MSG_HEADER_BYTES) {
+                    // Fast path: the message length is known, so copy the
+                    // unescaped run up to the next frame sync byte or the end
+                    // of the message with one memchr() and one memcpy()
+                    int remaining = state->uplink_msg_length + 2 - state->uplink_msg_index;
+                    size_t run = remaining > 0 ? (size_t)remaining : 1;
+                    if (state->uplink_msg_index + run > sizeof(LonNiFrame)) {
+                        // Length field exceeds the uplink buffer; drop the frame
+                        Increment32(state->lon_stats.uplink.rx_frame_errors);
+                        OsalPrintLog(ERROR_LOG, LonStatusFrameError,
+                                "ProcessUplinkBytes: Uplink message length %d "
+                                "exceeds buffer",
+                                state->uplink_msg_length);
+#if LINK_IS(USB_MIP)
+                        ResetUplinkState();
+#else   // LINK_IS(MULTIPLE_USB_MIPS)
+                        ResetUplinkState(iface_index);
+#endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
+                        break;
+                    }
+                    if (run > chunk_size) {
+                        run = chunk_size;
+                    }
+                    const uint8_t *sync = memchr(chunk, FRAME_SYNC, run);
+                    if (sync) {
+                        run = (size_t)(sync - chunk) + 1;  // Include the sync byte
+                    }
+                    memcpy(&msg_buf[state->uplink_msg_index], chunk, run);
+                    state->uplink_msg_index += (int)run;
+                    chunk += run;
+                    chunk_size -= run;
+                    if (sync) {
+                        state->uplink_state = UPLINK_ESCAPED_DATA;
+                        break;
+                    }
+                } else {
+                    // Length and extended length bytes are handled one at a
+                    // time so CheckUplinkCompleted() can capture the length
+                    uint8_t msg_byte = msg_buf[state->uplink_msg_index++] = *chunk++;
+                    chunk_size--;
+                    if (msg_byte == FRAME_SYNC) {
+                        state->uplink_state = UPLINK_ESCAPED_DATA;
+                        break;
+                    }
                 }
 #if LINK_IS(USB_MIP)
                 status = CheckUplinkCompleted(&completed);
@@ -2909,6 +3548,11 @@ static LonStatusCode ClearUplinkTransaction(int iface_index)
     }
 #endif  // LINK_IS(USB_MIP) || LINK_IS(MULTIPLE_USB_MIPS)
     LonStatusCode status = LonStatusNoError;
+    if (state->uplink_ack_timer) {
+        // Average the ack latency over the last few downlink frames
+        OsalTickCount latency = OsalGetTickCount() - state->uplink_ack_timer;
+        state->downlink_ack_latency = (3 * state->downlink_ack_latency + latency) / 4;
+    }
     if (state->downlink_state == DOWNLINK_WAIT_CP_ACK ||
             state->downlink_state == DOWNLINK_WAIT_CP_RESPONSE) {
         state->downlink_buffer.usb_ni_data_frame.ni_command = 0;
@@ -3291,7 +3935,11 @@ LonStatusCode CloseLonUsbLink(int iface_index)
         status = LonStatusCloseFailed;
         OsalPrintLog(INFO_LOG, status, "Error closing interface %d", iface_index);
     } else {
+#if USB_UPLINK_IS(EPOLL)
+        StopUsbReader(iface_index);
+#else   // !USB_UPLINK_IS(EPOLL)
         HalCloseUsb(state->usb_fd);
+#endif  // USB_UPLINK_IS(EPOLL)
 #if LINK_IS(USB_MIP)
         ResetUplinkState();
 #else
@@ -3310,6 +3958,96 @@ LonStatusCode CloseLonUsbLink(int iface_index)
  * Section: State Array Management Function Definitions
  *****************************************************************/
 
+/*
+ * Allocates and initializes the queues and the uplink ring buffer of an
+ * interface state.
+ * Parameters:
+ *   state: Interface state to initialize
+ * Returns:
+ *   LonStatusNoError on success; LonStatusCode error code if unsuccessful
+ * Notes:
+ *   The static build uses iface_storage[state->iface_index] instead of
+ *   allocating.
+ */
+static LonStatusCode InitIfaceBuffers(LonUsbLinkState *state)
+{
+    LonStatusCode status;
+#if STACK_STATIC_ALLOCATION
+    LonUsbLinkStorage *storage = &iface_storage[state->iface_index];
+
+    // Initialize LON USB downlink queues
+    if (((status = QueueInitStorage(&state->lon_usb_downlink_normal_queue,
+                  "link layer downlink", sizeof(LonUsbQueueBuffer),
+                  MAX_LON_DOWNLINK_BUFFERS, storage->downlink_normal)) !=
+                LonStatusNoError) ||
+            ((status = QueueInitStorage(&state->lon_usb_downlink_priority_queue,
+                      "link layer priority downlink", sizeof(LonUsbQueueBuffer),
+                      MAX_LON_DOWNLINK_BUFFERS, storage->downlink_priority)) !=
+                    LonStatusNoError)) {
+        OsalPrintLog(ERROR_LOG, LonStatusStackInitializationFailure,
+                "InitIfaceBuffers: Failed to initialize link layer "
+                "downlink queue");
+        return status;
+    }
+    // Initialize LON USB uplink queues
+    if (((status = QueueInitStorage(&state->lon_usb_uplink_normal_queue,
+                  "link layer uplink", sizeof(LonUsbQueueBuffer),
+                  MAX_LON_UPLINK_BUFFERS, storage->uplink_normal)) !=
+                LonStatusNoError) ||
+            ((status = QueueInitStorage(&state->lon_usb_uplink_priority_queue,
+                      "link layer priority uplink", sizeof(LonUsbQueueBuffer),
+                      MAX_LON_UPLINK_BUFFERS, storage->uplink_priority)) !=
+                    LonStatusNoError)) {
+        OsalPrintLog(ERROR_LOG, LonStatusStackInitializationFailure,
+                "InitIfaceBuffers: Failed to initialize link layer uplink "
+                "queue");
+        return status;
+    }
+    // Initialize the LON USB uplink ring buffer
+    if (!LON_SUCCESS(status = RingBufferInitStorage(&state->lon_usb_uplink_ring_buffer,
+                             storage->uplink_ring, sizeof(storage->uplink_ring)))) {
+        OsalPrintLog(ERROR_LOG, status,
+                "InitIfaceBuffers: Failed to initialize LON USB uplink "
+                "ring buffer");
+        return status;
+    }
+#else
+    // Allocate and initialize LON USB downlink queues
+    if (((status = QueueInit(&state->lon_usb_downlink_normal_queue, "link layer downlink",
+                  sizeof(LonUsbQueueBuffer), MAX_LON_DOWNLINK_BUFFERS)) !=
+                LonStatusNoError) ||
+            ((status = QueueInit(&state->lon_usb_downlink_priority_queue,
+                      "link layer priority downlink", sizeof(LonUsbQueueBuffer),
+                      MAX_LON_DOWNLINK_BUFFERS)) != LonStatusNoError)) {
+        OsalPrintLog(ERROR_LOG, LonStatusStackInitializationFailure,
+                "InitIfaceBuffers: Failed to initialize link layer "
+                "downlink queue");
+        return status;
+    }
+    // Allocate and initialize LON USB uplink queues
+    if (((status = QueueInit(&state->lon_usb_uplink_normal_queue, "link layer uplink",
+                  sizeof(LonUsbQueueBuffer), MAX_LON_UPLINK_BUFFERS)) !=
+                LonStatusNoError) ||
+            ((status = QueueInit(&state->lon_usb_uplink_priority_queue,
+                      "link layer priority uplink", sizeof(LonUsbQueueBuffer),
+                      MAX_LON_UPLINK_BUFFERS)) != LonStatusNoError)) {
+        OsalPrintLog(ERROR_LOG, LonStatusStackInitializationFailure,
+                "InitIfaceBuffers: Failed to initialize link layer uplink "
+                "queue");
+        return status;
+    }
+    // Allocate and initialize the LON USB uplink ring buffer
+    if (!LON_SUCCESS(status = RingBufferInit(&state->lon_usb_uplink_ring_buffer,
+                             LON_USB_UPLINK_RING_CAPACITY))) {
+        OsalPrintLog(ERROR_LOG, status,
+                "InitIfaceBuffers: Failed to initialize LON USB uplink "
+                "ring buffer");
+        return status;
+    }
+#endif  // STACK_STATIC_ALLOCATION
+    return status;
+}
+
 /*
  * Initializes all iface_state entries to default values.
  * Parameters:
@@ -3362,11 +4100,17 @@ static LonStatusCode InitIfaceStates(void)
     state->start_time = state->last_timeout = 0;
     // Initialize downlink state
     state->downlink_state = DOWNLINK_INVALID;
+    state->downlink_ack_latency = 0;
     state->downlink_reject_timer = 0;
     state->downlink_ack_seq_number = NO_ACK_REQUIRED;
     state->downlink_seq_number = 0;
     memset(&state->downlink_buffer_staging, 0, sizeof(state->downlink_buffer_staging));
     memset(&state->downlink_buffer, 0, sizeof(state->downlink_buffer));
+    state->downlink_batch_iov_count = 0;
+    state->downlink_batch_cp_count = 0;
+    state->downlink_batch_msgs = 0;
+    state->downlink_batch_msg_bytes = 0;
+    state->downlink_batching = false;
     // Initialize uplink state
     state->uplink_state = UPLINK_IDLE;
     state->uplink_ack_timer = 0;
@@ -3384,55 +4128,22 @@ static LonStatusCode InitIfaceStates(void)
     state->uplink_seq_number = ~FRAME_CODE_SEQ_NUM_MASK;  // Force mismatch on first frame
     state->uplink_tail_escaped = false;
     // Allocate and initialize queues and buffers
-    // Allocate and initialize LON USB downlink queues
-    if (((status = QueueInit(&state->lon_usb_downlink_normal_queue, "link layer downlink",
-                  sizeof(LonUsbQueueBuffer), MAX_LON_DOWNLINK_BUFFERS)) !=
-                LonStatusNoError) ||
-            ((status = QueueInit(&state->lon_usb_downlink_priority_queue,
-                      "link layer priority downlink", sizeof(LonUsbQueueBuffer),
-                      MAX_LON_DOWNLINK_BUFFERS)) != LonStatusNoError)) {
-        OsalPrintLog(ERROR_LOG, LonStatusStackInitializationFailure,
-                "InitIfaceStates: Failed to initialize link layer "
-                "downlink queue");
-        return status;
-    }
-    // Allocate and initialize LON USB uplink queues
-    if (((status = QueueInit(&state->lon_usb_uplink_normal_queue, "link layer uplink",
-                  sizeof(LonUsbQueueBuffer), MAX_LON_UPLINK_BUFFERS)) !=
-                LonStatusNoError) ||
-            ((status = QueueInit(&state->lon_usb_uplink_priority_queue,
-                      "link layer priority uplink", sizeof(LonUsbQueueBuffer),
-                      MAX_LON_UPLINK_BUFFERS)) != LonStatusNoError)) {
-        OsalPrintLog(ERROR_LOG, LonStatusStackInitializationFailure,
-                "InitIfaceStates: Failed to initialize link layer uplink "
-                "queue");
-        return status;
-    }
-    // Initialize the LON USB uplink ring buffer (capacity set to full internal
-    // max)
-    if (!LON_SUCCESS(status = RingBufferInit(&state->lon_usb_uplink_ring_buffer,
-                             RING_BUFFER_MAX_CAPACITY))) {
-        OsalPrintLog(ERROR_LOG, status,
-                "InitIfaceStates: Failed to initialize LON USB uplink "
-                "ring buffer");
+    if (!LON_SUCCESS(status = InitIfaceBuffers(state))) {
         return status;
     }
-    RingBufferClear(&state->lon_usb_uplink_ring_buffer);
-    state->lon_stats.usb_rx.capacity = RING_BUFFER_MAX_CAPACITY;
-    state->lon_stats.usb_rx.max_occupancy =
-            RingBufferSize(&state->lon_usb_uplink_ring_buffer);
     // Initialize LON USB link statistics
     memset(&state->lon_stats, 0, sizeof(state->lon_stats));
     state->lon_stats.l2_l5_mode = LON_IFACE_MODE_UNKNOWN;
     state->lon_stats.ni_status = LON_NI_STATUS_UNKNOWN;
     state->lon_stats.size = sizeof(state->lon_stats);
+    state->lon_stats.usb_rx.capacity = state->lon_usb_uplink_ring_buffer.size;
 #if LINK_IS(MULTIPLE_USB_MIPS)
 }
 #endif
 OsalPrintLog(INFO_LOG, status,
         "Initialized %d LON interface states with %d byte uplink ring "
         "buffer and %d entry uplink and downlink queues",
-        MAX_IFACE_STATES, RING_BUFFER_MAX_CAPACITY, MAX_LON_UPLINK_BUFFERS);
+        MAX_IFACE_STATES, LON_USB_UPLINK_RING_CAPACITY, MAX_LON_UPLINK_BUFFERS);
 return status;
 }
 
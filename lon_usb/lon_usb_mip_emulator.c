@@ -0,0 +1,992 @@
+/*
+ * lon_usb_mip_emulator.c
+ *
+ * Copyright (c) 2026 EnOcean
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ *
+ * Title:   LON USB MIP Emulator
+ * Purpose: Emulates a MIP/U50 or MIP/U61 LON USB network interface on a
+ *          Linux pseudo-terminal so that the LON USB link layer in
+ *          lon_usb_link.c can be exercised and benchmarked without
+ *          U10/U60 hardware.
+ * Notes:   The emulator opens a pseudo-terminal master and prints the
+ *          slave device name (optionally publishing it as a symbolic
+ *          link with -p).  Build the LON Stack with USB_DEV_NAME set to
+ *          that name and USB_LINE_DISCIPLINE set to -1; a pseudo-terminal
+ *          does not support the MIP line discipline.
+ *
+ *          The emulator implements the framing used by lon_usb_link.c:
+ *          - MIP/U50: 4-byte code packets (sync, SSSA:CCCC frame code,
+ *            parameter, checksum) with sequence numbers and ACKs, and
+ *            message frames with 0x7E escaping and a trailing checksum.
+ *          - MIP/U61: sync followed by a 0 frame code and the message;
+ *            there are no sequence numbers or ACKs.  Downlink code
+ *            packets are still accepted in U61 mode because the link
+ *            layer sends them for both interface types.
+ *          The emulator answers the link layer startup sequence (resync,
+ *          reset, layer mode, unique ID read, and status requests), can
+ *          echo downlink layer 2 frames back uplink, and can generate
+ *          uplink layer 2 traffic at a fixed rate.  Response delays,
+ *          rejects, duplicate uplink frames, and corrupted uplink code
+ *          packets can be injected.  Statistics are reported periodically
+ *          and on exit, including uplink frames per second and the host
+ *          ACK turnaround time.
+ *
+ *          Build with -DLON_STACK_BUILD_MIP_EMULATOR=ON and run with -h
+ *          for the command line options.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "izot/IzotPlatform.h"
+#include "lon_usb/lon_usb_link.h"
+
+// LON frame sync byte value; must match lon_usb_link.c
+#define FRAME_SYNC 0x7E
+
+// Maximum number of uplink frames waiting to be sent
+#ifndef MIP_EMULATOR_UPLINK_QUEUE_LEN
+#define MIP_EMULATOR_UPLINK_QUEUE_LEN 64
+#endif
+
+// Maximum unescaped message frame size (length, command, PDU, checksum)
+#define MIP_EMULATOR_MAX_FRAME (MAX_LON_MSG_EX_LEN + 4)
+
+// Maximum NPDU size of a generated uplink frame; the short length byte
+// covers the NI command, LPDU header, NPDU, and 2-byte CRC
+#define MIP_EMULATOR_MAX_NPDU (EXT_LENGTH - 1 - 1 - 1 - 2)
+
+// Values reported in the reset and status messages
+#define MIP_EMULATOR_MODEL_ID 0x1E      // U10 Rev C (MIP/U50)
+#define MIP_EMULATOR_FW_VERSION 0xA0    // Version 16.0
+#define MIP_EMULATOR_CHANNEL_TYPE 4     // TP/FT-10
+
+/*****************************************************************
+ * Section: Types
+ *****************************************************************/
+
+// Downlink (host to MIP) parser states
+typedef enum {
+    EMU_DOWNLINK_IDLE = 0,    // Waiting for frame sync
+    EMU_DOWNLINK_FRAME_CODE,  // Waiting for frame code byte
+    EMU_DOWNLINK_PARAMETER,   // Waiting for code packet parameter byte
+    EMU_DOWNLINK_CHECKSUM,    // Waiting for code packet checksum byte
+    EMU_DOWNLINK_MESSAGE,     // Receiving message frame bytes
+    EMU_DOWNLINK_ESCAPED,     // Received 0x7E within a message frame
+} EmuDownlinkState;
+
+// An unescaped uplink message frame waiting to be sent
+typedef struct EmuUplinkFrame {
+    size_t length;  // Frame length in bytes, excluding the checksum
+    uint8_t data[MIP_EMULATOR_MAX_FRAME];
+} EmuUplinkFrame;
+
+// Emulator options set from the command line
+typedef struct EmuOptions {
+    LonUsbIfaceType iface_type;        // LON_USB_INTERFACE_U50 or _U61
+    const char *link_path;             // Optional symbolic link to the slave
+    uint8_t uid[IZOT_UNIQUE_ID_LENGTH];
+    LonUsbInterfaceMode initial_mode;  // Layer mode reported after reset
+    unsigned response_delay_ms;        // Delay before each downlink response
+    unsigned reject_percent;           // Downlink messages answered with a reject
+    unsigned duplicate_percent;        // Uplink messages sent twice
+    unsigned corrupt_percent;          // Uplink code packets with a bad checksum
+    unsigned uplink_rate;              // Generated uplink frames per second
+    unsigned uplink_npdu_size;         // NPDU bytes in each generated frame
+    unsigned ack_timeout_ms;           // Uplink retransmit timeout
+    unsigned report_interval;          // Seconds between statistics reports
+    bool echo;                         // Echo downlink layer 2 frames uplink
+    bool verbose;                      // Trace each frame
+} EmuOptions;
+
+// Emulator statistics
+typedef struct EmuStats {
+    uint64_t dl_code_packets;       // Downlink code packets received
+    uint64_t dl_messages;           // Downlink message frames received
+    uint64_t dl_bytes;              // Downlink bytes received
+    uint64_t dl_duplicates;         // Downlink messages with a repeated sequence
+    uint64_t dl_checksum_errors;    // Downlink frames with a bad checksum
+    uint64_t dl_frame_errors;       // Downlink framing errors
+    uint64_t ul_messages;           // Uplink messages sent (first transmission)
+    uint64_t ul_acked;              // Uplink messages acknowledged by the host
+    uint64_t ul_retransmits;        // Uplink messages resent after an ACK timeout
+    uint64_t ul_bytes;              // Uplink bytes written
+    uint64_t ul_overruns;           // Generated frames dropped; queue full
+    uint64_t injected_rejects;      // Rejects sent instead of ACKs
+    uint64_t injected_duplicates;   // Duplicate uplink frames sent
+    uint64_t injected_corruptions;  // Uplink code packets sent with a bad checksum
+    uint64_t ack_turnaround_total;  // Sum of uplink ACK turnaround times (us)
+    uint64_t ack_turnaround_min;    // Minimum uplink ACK turnaround time (us)
+    uint64_t ack_turnaround_max;    // Maximum uplink ACK turnaround time (us)
+} EmuStats;
+
+// Emulated MIP state
+typedef struct EmuState {
+    int master_fd;                 // Pseudo-terminal master
+    int slave_fd;                  // Slave held open so the master stays readable
+    char slave_name[128];
+    LonUsbInterfaceMode layer_mode;
+    // Downlink parser
+    EmuDownlinkState dl_state;
+    LonFrameHeader dl_header;      // Last downlink code packet
+    uint8_t dl_frame[MIP_EMULATOR_MAX_FRAME];
+    size_t dl_index;
+    int dl_last_seq;               // Last downlink message sequence; -1 if none
+    // Uplink sender
+    EmuUplinkFrame ul_queue[MIP_EMULATOR_UPLINK_QUEUE_LEN];
+    size_t ul_head;
+    size_t ul_count;
+    bool ul_waiting_ack;           // Queue head was sent and is waiting for an ACK
+    uint8_t ul_seq;                // Sequence number of the queue head
+    uint64_t ul_sent_us;           // Time the queue head was last sent
+    uint64_t ul_next_generate_us;  // Time for the next generated uplink frame
+    uint32_t ul_generated;         // Generated frame counter
+    // Statistics
+    EmuStats stats;
+    uint64_t start_us;
+    uint64_t last_report_us;
+} EmuState;
+
+/*****************************************************************
+ * Section: Globals
+ *****************************************************************/
+
+static EmuOptions options = {
+        .iface_type = LON_USB_INTERFACE_U50,
+        .uid = {0x00, 0x0E, 0x1E, 0x00, 0x00, 0x01},
+        .initial_mode = LON_IFACE_MODE_LAYER5,
+        .uplink_npdu_size = 16,
+        .ack_timeout_ms = 200,
+        .report_interval = 5,
+};
+
+static volatile sig_atomic_t emulator_stop = 0;
+
+/*****************************************************************
+ * Section: Function Declarations
+ *****************************************************************/
+
+static void ProcessDownlinkBytes(EmuState *emu, const uint8_t *data, size_t length);
+static void StoreDownlinkByte(EmuState *emu, uint8_t byte);
+static void ProcessDownlinkCodePacket(EmuState *emu);
+static void ProcessDownlinkMessage(EmuState *emu, size_t length);
+static bool QueueUplinkFrame(EmuState *emu, uint8_t ni_command, const uint8_t *pdu,
+        size_t pdu_length);
+static void QueueResetMessage(EmuState *emu);
+static void QueueStatusResponse(EmuState *emu);
+static bool SendUplinkHead(EmuState *emu, bool retransmit);
+static void ServiceUplink(EmuState *emu, uint64_t now);
+static void ReportStats(EmuState *emu, const char *title);
+
+/*****************************************************************
+ * Section: Utility Functions
+ *****************************************************************/
+
+/*
+ * Returns the monotonic time in microseconds.
+ */
+static uint64_t NowMicroseconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+/*
+ * Returns true with the specified percent probability.
+ */
+static bool Chance(unsigned percent)
+{
+    return percent && (unsigned)(rand() % 100) < percent;
+}
+
+/*
+ * Sleeps for the configured response delay, if any.
+ */
+static void ResponseDelay(void)
+{
+    if (options.response_delay_ms) {
+        usleep(options.response_delay_ms * 1000u);
+    }
+}
+
+/*
+ * Computes the negated modulo 256 sum of a byte sequence.  This is the
+ * checksum used for MIP code packets and message frames.
+ */
+static uint8_t FrameChecksum(const uint8_t *data, size_t length)
+{
+    uint8_t sum = 0;
+    while (length--) {
+        sum += *data++;
+    }
+    return (uint8_t)-sum;
+}
+
+/*
+ * Computes the CCITT CRC-16 appended to a LON layer 2 frame.
+ */
+static uint16_t LonFrameCrc(const uint8_t *data, size_t length)
+{
+    uint16_t crc = 0xFFFF;
+    while (length--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return (uint16_t)~crc;
+}
+
+/*
+ * Writes a byte sequence to the pseudo-terminal master, waiting for room
+ * as required.
+ * Returns:
+ *   true on success; false if the write failed
+ */
+static bool WriteAll(EmuState *emu, const uint8_t *data, size_t length)
+{
+    while (length) {
+        ssize_t written = write(emu->master_fd, data, length);
+        if (written > 0) {
+            data += written;
+            length -= (size_t)written;
+            emu->stats.ul_bytes += (uint64_t)written;
+        } else if (written < 0 && (errno == EAGAIN || errno == EINTR)) {
+            struct pollfd pfd = {emu->master_fd, POLLOUT, 0};
+            poll(&pfd, 1, 100);
+        } else {
+            fprintf(stderr, "WriteAll: Cannot write to %s, %s\n", emu->slave_name,
+                    strerror(errno));
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Prints a labeled hex dump of a frame when verbose tracing is enabled.
+ */
+static void TraceFrame(const char *label, const uint8_t *data, size_t length)
+{
+    if (!options.verbose) {
+        return;
+    }
+    printf("%s (%zu bytes):", label, length);
+    for (size_t i = 0; i < length; i++) {
+        printf(" %02X", data[i]);
+    }
+    printf("\n");
+}
+
+/*****************************************************************
+ * Section: Uplink Functions
+ *****************************************************************/
+
+/*
+ * Sends a MIP/U50 code packet uplink.
+ * Parameters:
+ *   emu: emulator state
+ *   seq: sequence number (0 - 7)
+ *   ack: true to set the ACK flag
+ *   cmd: frame command
+ *   parameter: frame parameter
+ * Returns:
+ *   true on success; false if the write failed
+ * Notes:
+ *   MIP/U61 has no code packets; nothing is sent in U61 mode.
+ */
+static bool SendCodePacket(EmuState *emu, uint8_t seq, bool ack, LonUsbFrameCommand cmd,
+        uint8_t parameter)
+{
+    if (options.iface_type != LON_USB_INTERFACE_U50) {
+        return true;
+    }
+    LonFrameHeader header = {FRAME_SYNC, 0, parameter, 0};
+    IZOT_SET_ATTRIBUTE(header, IZOT_U50_FRAME_CODE_SEQ, seq);
+    IZOT_SET_ATTRIBUTE(header, IZOT_U50_FRAME_CODE_ACK, ack ? 1 : 0);
+    IZOT_SET_ATTRIBUTE(header, IZOT_U50_FRAME_CODE_CMD, cmd);
+    header.checksum = FrameChecksum((const uint8_t *)&header, 3);
+    TraceFrame("Uplink code packet", (const uint8_t *)&header, sizeof(header));
+    return WriteAll(emu, (const uint8_t *)&header, sizeof(header));
+}
+
+/*
+ * Queues an uplink message frame.
+ * Parameters:
+ *   emu: emulator state
+ *   ni_command: network interface command (use LonNiCommand values)
+ *   pdu: PDU following the command; may be NULL if pdu_length is 0
+ *   pdu_length: PDU length in bytes
+ * Returns:
+ *   true if queued; false if the queue is full or the frame is too long
+ */
+static bool QueueUplinkFrame(EmuState *emu, uint8_t ni_command, const uint8_t *pdu,
+        size_t pdu_length)
+{
+    if (emu->ul_count >= MIP_EMULATOR_UPLINK_QUEUE_LEN || pdu_length + 1 >= EXT_LENGTH) {
+        return false;
+    }
+    EmuUplinkFrame *frame =
+            &emu->ul_queue[(emu->ul_head + emu->ul_count) % MIP_EMULATOR_UPLINK_QUEUE_LEN];
+    frame->data[0] = (uint8_t)(pdu_length + 1);
+    frame->data[1] = ni_command;
+    if (pdu_length) {
+        memcpy(&frame->data[2], pdu, pdu_length);
+    }
+    frame->length = pdu_length + 2;
+    emu->ul_count++;
+    return true;
+}
+
+/*
+ * Discards all queued uplink frames, including any frame waiting for an ACK.
+ */
+static void FlushUplinkQueue(EmuState *emu)
+{
+    emu->ul_head = 0;
+    emu->ul_count = 0;
+    emu->ul_waiting_ack = false;
+}
+
+/*
+ * Queues the reset message a MIP sends after a power-up, reset, or resync.
+ * The PDU contains the current layer mode and the channel type ID.
+ */
+static void QueueResetMessage(EmuState *emu)
+{
+    uint8_t pdu[2] = {(uint8_t)emu->layer_mode, MIP_EMULATOR_CHANNEL_TYPE};
+    QueueUplinkFrame(emu, LonNiResetDeviceCmd, pdu, sizeof(pdu));
+}
+
+/*
+ * Queues the response to a LonNiStatusCmd request.
+ */
+static void QueueStatusResponse(EmuState *emu)
+{
+    IzotLonInterfaceStatusResponse response = {
+            MIP_EMULATOR_MODEL_ID, MIP_EMULATOR_FW_VERSION, (IzotByte)emu->layer_mode, 0};
+    QueueUplinkFrame(emu, LonNiStatusCmd, (const uint8_t *)&response, sizeof(response));
+}
+
+/*
+ * Sends the frame at the head of the uplink queue.
+ * Parameters:
+ *   emu: emulator state
+ *   retransmit: true to resend the head with its current sequence number
+ * Returns:
+ *   true on success; false if the write failed
+ * Notes:
+ *   For MIP/U50 the message is preceded by a MSG_FRAME_CMD code packet and
+ *   the frame remains at the head of the queue until the host ACKs it.
+ *   For MIP/U61 the frame is preceded by a sync and 0 byte and is removed
+ *   from the queue once written.  The code packet and message are written
+ *   with a single write() to match the MIP USB transfer pattern.
+ */
+static bool SendUplinkHead(EmuState *emu, bool retransmit)
+{
+    EmuUplinkFrame *frame = &emu->ul_queue[emu->ul_head];
+    uint8_t out[sizeof(LonFrameHeader) + 2 * (MIP_EMULATOR_MAX_FRAME + 1)];
+    size_t out_len = 0;
+    bool u50 = options.iface_type == LON_USB_INTERFACE_U50;
+
+    if (u50) {
+        if (!retransmit) {
+            emu->ul_seq = (uint8_t)((emu->ul_seq + 1) & 0x07);
+        }
+        LonFrameHeader header = {FRAME_SYNC, 0, 0, 0};
+        IZOT_SET_ATTRIBUTE(header, IZOT_U50_FRAME_CODE_SEQ, emu->ul_seq);
+        IZOT_SET_ATTRIBUTE(header, IZOT_U50_FRAME_CODE_CMD, MSG_FRAME_CMD);
+        header.checksum = FrameChecksum((const uint8_t *)&header, 3);
+        if (Chance(options.corrupt_percent)) {
+            header.checksum ^= 0x5A;
+            emu->stats.injected_corruptions++;
+        }
+        memcpy(out, &header, sizeof(header));
+        out_len = sizeof(header);
+    } else {
+        out[out_len++] = FRAME_SYNC;
+        out[out_len++] = 0;
+    }
+    uint8_t checksum = FrameChecksum(frame->data, frame->length);
+    for (size_t i = 0; i <= frame->length; i++) {
+        uint8_t byte = (i < frame->length) ? frame->data[i] : checksum;
+        out[out_len++] = byte;
+        if (byte == FRAME_SYNC) {
+            out[out_len++] = FRAME_SYNC;
+        }
+    }
+    TraceFrame(retransmit ? "Uplink message (retransmit)" : "Uplink message", out, out_len);
+    if (!WriteAll(emu, out, out_len)) {
+        return false;
+    }
+    if (retransmit) {
+        emu->stats.ul_retransmits++;
+    } else {
+        emu->stats.ul_messages++;
+    }
+    if (Chance(options.duplicate_percent)) {
+        emu->stats.injected_duplicates++;
+        if (!WriteAll(emu, out, out_len)) {
+            return false;
+        }
+    }
+    if (u50) {
+        emu->ul_waiting_ack = true;
+        emu->ul_sent_us = NowMicroseconds();
+    } else {
+        emu->ul_head = (emu->ul_head + 1) % MIP_EMULATOR_UPLINK_QUEUE_LEN;
+        emu->ul_count--;
+    }
+    return true;
+}
+
+/*
+ * Completes the uplink transaction for the queue head after a host ACK and
+ * records the ACK turnaround time.
+ */
+static void CompleteUplinkAck(EmuState *emu, uint64_t now)
+{
+    uint64_t turnaround = now - emu->ul_sent_us;
+    emu->stats.ul_acked++;
+    emu->stats.ack_turnaround_total += turnaround;
+    if (!emu->stats.ack_turnaround_min || turnaround < emu->stats.ack_turnaround_min) {
+        emu->stats.ack_turnaround_min = turnaround;
+    }
+    if (turnaround > emu->stats.ack_turnaround_max) {
+        emu->stats.ack_turnaround_max = turnaround;
+    }
+    emu->ul_waiting_ack = false;
+    emu->ul_head = (emu->ul_head + 1) % MIP_EMULATOR_UPLINK_QUEUE_LEN;
+    emu->ul_count--;
+}
+
+/*
+ * Generates uplink traffic, sends the next uplink frame, and retransmits
+ * an unacknowledged frame after the ACK timeout.
+ */
+static void ServiceUplink(EmuState *emu, uint64_t now)
+{
+    if (options.uplink_rate) {
+        uint64_t period = 1000000u / options.uplink_rate;
+        while (emu->ul_next_generate_us <= now) {
+            // Incoming layer 2 frame: LPDU header, NPDU, and CRC
+            uint8_t lpdu[1 + MIP_EMULATOR_MAX_NPDU + 2];
+            size_t npdu_size = options.uplink_npdu_size;
+            lpdu[0] = 0;  // Priority 0, primary path, delta backlog 0
+            for (size_t i = 0; i < npdu_size; i++) {
+                lpdu[1 + i] = (uint8_t)(emu->ul_generated + i);
+            }
+            uint16_t crc = LonFrameCrc(lpdu, npdu_size + 1);
+            lpdu[npdu_size + 1] = (uint8_t)(crc >> 8);
+            lpdu[npdu_size + 2] = (uint8_t)crc;
+            if (!QueueUplinkFrame(emu, LonNiIncomingL2Cmd, lpdu, npdu_size + 3)) {
+                emu->stats.ul_overruns++;
+            }
+            emu->ul_generated++;
+            emu->ul_next_generate_us += period;
+        }
+    }
+    if (emu->ul_waiting_ack) {
+        if (now - emu->ul_sent_us > (uint64_t)options.ack_timeout_ms * 1000u) {
+            SendUplinkHead(emu, true);
+        }
+    } else if (emu->ul_count) {
+        SendUplinkHead(emu, false);
+    }
+}
+
+/*****************************************************************
+ * Section: Downlink Functions
+ *****************************************************************/
+
+/*
+ * Stores an unescaped downlink message byte and processes the message once
+ * the frame is complete.  The frame is complete when the length byte, the
+ * bytes it counts, and the checksum have been received.
+ */
+static void StoreDownlinkByte(EmuState *emu, uint8_t byte)
+{
+    if (emu->dl_index >= sizeof(emu->dl_frame)) {
+        emu->stats.dl_frame_errors++;
+        emu->dl_state = EMU_DOWNLINK_IDLE;
+        return;
+    }
+    emu->dl_frame[emu->dl_index++] = byte;
+    size_t frame_length;
+    if (emu->dl_index < 2) {
+        return;
+    } else if (emu->dl_frame[0] != EXT_LENGTH) {
+        frame_length = (size_t)emu->dl_frame[0] + 2;
+    } else if (emu->dl_index >= 4) {
+        // Extended frame: flag, command, 16-bit big-endian length, PDU, checksum
+        frame_length = ((size_t)emu->dl_frame[2] << 8 | emu->dl_frame[3]) + 5;
+    } else {
+        return;
+    }
+    if (frame_length > sizeof(emu->dl_frame)) {
+        emu->stats.dl_frame_errors++;
+        emu->dl_state = EMU_DOWNLINK_IDLE;
+    } else if (emu->dl_index == frame_length) {
+        emu->dl_state = EMU_DOWNLINK_IDLE;
+        ProcessDownlinkMessage(emu, frame_length);
+    }
+}
+
+/*
+ * Parses downlink bytes from the host.
+ * Parameters:
+ *   emu: emulator state
+ *   data: received bytes
+ *   length: number of received bytes
+ */
+static void ProcessDownlinkBytes(EmuState *emu, const uint8_t *data, size_t length)
+{
+    emu->stats.dl_bytes += length;
+    for (size_t i = 0; i < length; i++) {
+        uint8_t byte = data[i];
+        switch (emu->dl_state) {
+        case EMU_DOWNLINK_IDLE:
+            if (byte == FRAME_SYNC) {
+                emu->dl_header.frame_sync = byte;
+                emu->dl_state = EMU_DOWNLINK_FRAME_CODE;
+            }
+            break;
+        case EMU_DOWNLINK_FRAME_CODE:
+            if (byte == FRAME_SYNC) {
+                // Repeated sync; stay in this state
+                break;
+            }
+            emu->dl_header.frame_code = byte;
+            if (byte == 0) {
+                // MIP/U61 message frame
+                emu->dl_index = 0;
+                emu->dl_state = EMU_DOWNLINK_MESSAGE;
+            } else {
+                emu->dl_state = EMU_DOWNLINK_PARAMETER;
+            }
+            break;
+        case EMU_DOWNLINK_PARAMETER:
+            emu->dl_header.parameter = byte;
+            emu->dl_state = EMU_DOWNLINK_CHECKSUM;
+            break;
+        case EMU_DOWNLINK_CHECKSUM:
+            emu->dl_header.checksum = byte;
+            emu->dl_state = EMU_DOWNLINK_IDLE;
+            if (FrameChecksum((const uint8_t *)&emu->dl_header, 4) != 0) {
+                emu->stats.dl_checksum_errors++;
+                TraceFrame("Downlink code packet checksum error",
+                        (const uint8_t *)&emu->dl_header, sizeof(emu->dl_header));
+                break;
+            }
+            ProcessDownlinkCodePacket(emu);
+            break;
+        case EMU_DOWNLINK_MESSAGE:
+            if (byte == FRAME_SYNC) {
+                emu->dl_state = EMU_DOWNLINK_ESCAPED;
+            } else {
+                StoreDownlinkByte(emu, byte);
+            }
+            break;
+        case EMU_DOWNLINK_ESCAPED:
+            if (byte == FRAME_SYNC) {
+                emu->dl_state = EMU_DOWNLINK_MESSAGE;
+                StoreDownlinkByte(emu, byte);
+            } else {
+                // Unescaped sync within a message; abandon the message and
+                // parse this byte as the frame code of a new frame
+                emu->stats.dl_frame_errors++;
+                emu->dl_state = EMU_DOWNLINK_FRAME_CODE;
+                i--;
+            }
+            break;
+        }
+    }
+}
+
+/*
+ * Processes a validated downlink code packet.
+ */
+static void ProcessDownlinkCodePacket(EmuState *emu)
+{
+    LonUsbFrameCommand cmd = IZOT_GET_ATTRIBUTE(emu->dl_header, IZOT_U50_FRAME_CODE_CMD);
+    bool ack = IZOT_GET_ATTRIBUTE(emu->dl_header, IZOT_U50_FRAME_CODE_ACK) != 0;
+    uint8_t parameter = emu->dl_header.parameter;
+
+    emu->stats.dl_code_packets++;
+    TraceFrame("Downlink code packet", (const uint8_t *)&emu->dl_header,
+            sizeof(emu->dl_header));
+    if (ack && emu->ul_waiting_ack) {
+        CompleteUplinkAck(emu, NowMicroseconds());
+    }
+    switch (cmd) {
+    case NULL_FRAME_CMD:
+        break;
+    case MSG_FRAME_CMD:
+        emu->dl_index = 0;
+        emu->dl_state = EMU_DOWNLINK_MESSAGE;
+        break;
+    case NI_RESYNC_FRAME_CMD:
+        // Resynchronize: answer with a null code packet, then reset
+        ResponseDelay();
+        FlushUplinkQueue(emu);
+        emu->dl_last_seq = -1;
+        SendCodePacket(emu, emu->ul_seq, false, NULL_FRAME_CMD, 0);
+        QueueResetMessage(emu);
+        break;
+    case SHORT_NI_CMD_FRAME_CMD:
+        ResponseDelay();
+        SendCodePacket(emu, emu->ul_seq, true, NULL_FRAME_CMD, 0);
+        if (parameter == LonNiStatusCmd) {
+            QueueStatusResponse(emu);
+        } else if (parameter == LonNiResetDeviceCmd) {
+            FlushUplinkQueue(emu);
+            emu->dl_last_seq = -1;
+            QueueResetMessage(emu);
+        } else if (parameter == LonNiSetL5ModeCmd) {
+            emu->layer_mode = LON_IFACE_MODE_LAYER5;
+        } else if (parameter == LonNiSetL2ModeCmd) {
+            emu->layer_mode = LON_IFACE_MODE_LAYER2;
+        }
+        break;
+    default:
+        // Other commands need only an ACK
+        ResponseDelay();
+        SendCodePacket(emu, emu->ul_seq, true, NULL_FRAME_CMD, 0);
+        break;
+    }
+}
+
+/*
+ * Processes a complete downlink message frame.
+ * Parameters:
+ *   emu: emulator state
+ *   length: unescaped frame length including the checksum
+ */
+static void ProcessDownlinkMessage(EmuState *emu, size_t length)
+{
+    const uint8_t *frame = emu->dl_frame;
+    int seq = IZOT_GET_ATTRIBUTE(emu->dl_header, IZOT_U50_FRAME_CODE_SEQ);
+    bool u50 = options.iface_type == LON_USB_INTERFACE_U50;
+
+    TraceFrame("Downlink message", frame, length);
+    if (FrameChecksum(frame, length - 1) != frame[length - 1]) {
+        // No ACK; the host retries after its ACK timeout
+        emu->stats.dl_checksum_errors++;
+        return;
+    }
+    emu->stats.dl_messages++;
+    if (u50 && Chance(options.reject_percent)) {
+        emu->stats.injected_rejects++;
+        SendCodePacket(emu, emu->ul_seq, false, MSG_REJECT_FRAME_CMD, 0);
+        return;
+    }
+    ResponseDelay();
+    SendCodePacket(emu, emu->ul_seq, true, NULL_FRAME_CMD, 0);
+    if (u50 && emu->dl_header.frame_code && seq == emu->dl_last_seq) {
+        emu->stats.dl_duplicates++;
+        return;
+    }
+    emu->dl_last_seq = seq;
+    if (frame[0] == EXT_LENGTH) {
+        // Extended frames are acknowledged but not interpreted
+        return;
+    }
+    uint8_t ni_command = frame[1];
+    const uint8_t *pdu = &frame[2];
+    size_t pdu_length = (size_t)frame[0] - 1;
+    switch (ni_command) {
+    case LonNiSetL5ModeCmd:
+        emu->layer_mode = LON_IFACE_MODE_LAYER5;
+        break;
+    case LonNiSetL2ModeCmd:
+        emu->layer_mode = LON_IFACE_MODE_LAYER2;
+        break;
+    case LonNiLayerModeCmd:
+        if (pdu_length) {
+            emu->layer_mode = pdu[0] ? LON_IFACE_MODE_LAYER2 : LON_IFACE_MODE_LAYER5;
+        }
+        if (!u50) {
+            uint8_t mode = (uint8_t)emu->layer_mode;
+            QueueUplinkFrame(emu, LonNiLayerModeCmd, &mode, 1);
+        }
+        break;
+    case LonNiStatusCmd:
+        QueueStatusResponse(emu);
+        break;
+    case LonNiResetDeviceCmd:
+        FlushUplinkQueue(emu);
+        emu->dl_last_seq = -1;
+        QueueResetMessage(emu);
+        break;
+    case LonNiLocalNetMgmtCmd:
+        // Answer a read memory request for the unique ID; the message code
+        // follows the 14-byte message header and address
+        if (pdu_length > 14 && pdu[14] == IzotNmReadMemory) {
+            uint8_t response[15 + IZOT_UNIQUE_ID_LENGTH];
+            memcpy(response, pdu, 14);
+            response[14] = IzotNmReadMemory & (IZOT_NM_OPCODE_MASK | IZOT_NM_RESPONSE_SUCCESS);
+            memcpy(&response[15], options.uid, IZOT_UNIQUE_ID_LENGTH);
+            QueueUplinkFrame(emu, LonNiResponseCmd, response, sizeof(response));
+        }
+        break;
+    case LonNiNetworkMgmtCmd:
+        // Layer 2 frame: LPDU header and NPDU; echo it with a CRC if enabled
+        if (options.echo && pdu_length && pdu_length + 2 <= MIP_EMULATOR_MAX_NPDU + 1) {
+            uint8_t lpdu[MIP_EMULATOR_MAX_NPDU + 3];
+            memcpy(lpdu, pdu, pdu_length);
+            uint16_t crc = LonFrameCrc(lpdu, pdu_length);
+            lpdu[pdu_length] = (uint8_t)(crc >> 8);
+            lpdu[pdu_length + 1] = (uint8_t)crc;
+            if (!QueueUplinkFrame(emu, LonNiIncomingL2Cmd, lpdu, pdu_length + 2)) {
+                emu->stats.ul_overruns++;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/*****************************************************************
+ * Section: Statistics Functions
+ *****************************************************************/
+
+/*
+ * Prints the emulator statistics.
+ */
+static void ReportStats(EmuState *emu, const char *title)
+{
+    uint64_t now = NowMicroseconds();
+    double elapsed = (double)(now - emu->start_us) / 1e6;
+    EmuStats *s = &emu->stats;
+    if (elapsed <= 0) {
+        elapsed = 1e-6;
+    }
+    printf("%s after %.1f s:\n", title, elapsed);
+    printf("  Downlink: %" PRIu64 " messages (%.1f/s), %" PRIu64 " code packets, %" PRIu64
+           " bytes, %" PRIu64 " duplicates, %" PRIu64 " checksum errors, %" PRIu64
+           " frame errors\n",
+            s->dl_messages, (double)s->dl_messages / elapsed, s->dl_code_packets,
+            s->dl_bytes, s->dl_duplicates, s->dl_checksum_errors, s->dl_frame_errors);
+    printf("  Uplink:   %" PRIu64 " messages (%.1f/s), %" PRIu64 " acked (%.1f/s), %" PRIu64
+           " retransmits, %" PRIu64 " bytes, %" PRIu64 " overruns\n",
+            s->ul_messages, (double)s->ul_messages / elapsed, s->ul_acked,
+            (double)s->ul_acked / elapsed, s->ul_retransmits, s->ul_bytes, s->ul_overruns);
+    if (s->ul_acked) {
+        printf("  ACK turnaround: min %" PRIu64 " us, avg %" PRIu64 " us, max %" PRIu64
+               " us\n",
+                s->ack_turnaround_min, s->ack_turnaround_total / s->ul_acked,
+                s->ack_turnaround_max);
+    }
+    printf("  Injected: %" PRIu64 " rejects, %" PRIu64 " duplicates, %" PRIu64
+           " corruptions\n",
+            s->injected_rejects, s->injected_duplicates, s->injected_corruptions);
+    fflush(stdout);
+    emu->last_report_us = now;
+}
+
+/*****************************************************************
+ * Section: Main
+ *****************************************************************/
+
+static void StopHandler(int signal_number)
+{
+    (void)signal_number;
+    emulator_stop = 1;
+}
+
+static void Usage(const char *program)
+{
+    printf("Usage: %s [options]\n"
+           "  -t u50|u61  Interface type (default u50)\n"
+           "  -p path     Create a symbolic link to the pseudo-terminal slave\n"
+           "  -u uid      Unique ID as 12 hex digits (default 000E1E000001)\n"
+           "  -m 2|5      Layer mode reported after reset (default 5)\n"
+           "  -d ms       Delay before each downlink response (default 0)\n"
+           "  -n pct      Percent of downlink messages rejected (default 0)\n"
+           "  -D pct      Percent of uplink messages sent twice (default 0)\n"
+           "  -c pct      Percent of uplink code packets corrupted (default 0)\n"
+           "  -r rate     Generated uplink layer 2 frames per second (default 0)\n"
+           "  -b bytes    NPDU bytes per generated frame (default 16, max %d)\n"
+           "  -e          Echo downlink layer 2 frames uplink\n"
+           "  -a ms       Uplink ACK timeout before retransmit (default 200)\n"
+           "  -i seconds  Statistics report interval; 0 for exit only (default 5)\n"
+           "  -s seed     Random seed for fault injection\n"
+           "  -v          Trace each frame\n",
+            program, MIP_EMULATOR_MAX_NPDU);
+}
+
+static bool ParseUid(const char *text, uint8_t *uid)
+{
+    if (strlen(text) != 2 * IZOT_UNIQUE_ID_LENGTH) {
+        return false;
+    }
+    for (int i = 0; i < IZOT_UNIQUE_ID_LENGTH; i++) {
+        unsigned value;
+        if (sscanf(&text[2 * i], "%2x", &value) != 1) {
+            return false;
+        }
+        uid[i] = (uint8_t)value;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    static EmuState emu;
+    unsigned seed = (unsigned)time(NULL);
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:p:u:m:d:n:D:c:r:b:ea:i:s:vh")) != -1) {
+        switch (opt) {
+        case 't':
+            if (strcmp(optarg, "u50") == 0) {
+                options.iface_type = LON_USB_INTERFACE_U50;
+            } else if (strcmp(optarg, "u61") == 0) {
+                options.iface_type = LON_USB_INTERFACE_U61;
+            } else {
+                Usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'p':
+            options.link_path = optarg;
+            break;
+        case 'u':
+            if (!ParseUid(optarg, options.uid)) {
+                Usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'm':
+            options.initial_mode =
+                    atoi(optarg) == 2 ? LON_IFACE_MODE_LAYER2 : LON_IFACE_MODE_LAYER5;
+            break;
+        case 'd':
+            options.response_delay_ms = (unsigned)atoi(optarg);
+            break;
+        case 'n':
+            options.reject_percent = (unsigned)atoi(optarg);
+            break;
+        case 'D':
+            options.duplicate_percent = (unsigned)atoi(optarg);
+            break;
+        case 'c':
+            options.corrupt_percent = (unsigned)atoi(optarg);
+            break;
+        case 'r':
+            options.uplink_rate = (unsigned)atoi(optarg);
+            break;
+        case 'b':
+            options.uplink_npdu_size = (unsigned)atoi(optarg);
+            if (options.uplink_npdu_size > MIP_EMULATOR_MAX_NPDU) {
+                options.uplink_npdu_size = MIP_EMULATOR_MAX_NPDU;
+            }
+            break;
+        case 'e':
+            options.echo = true;
+            break;
+        case 'a':
+            options.ack_timeout_ms = (unsigned)atoi(optarg);
+            break;
+        case 'i':
+            options.report_interval = (unsigned)atoi(optarg);
+            break;
+        case 's':
+            seed = (unsigned)strtoul(optarg, NULL, 0);
+            break;
+        case 'v':
+            options.verbose = true;
+            break;
+        default:
+            Usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    srand(seed);
+
+    // Open the pseudo-terminal; the slave is held open and set to raw mode
+    // so that the master does not report EIO before the host opens it
+    emu.master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (emu.master_fd < 0 || grantpt(emu.master_fd) < 0 || unlockpt(emu.master_fd) < 0 ||
+            ptsname_r(emu.master_fd, emu.slave_name, sizeof(emu.slave_name)) != 0) {
+        fprintf(stderr, "Cannot open a pseudo-terminal, %s\n", strerror(errno));
+        return 1;
+    }
+    emu.slave_fd = open(emu.slave_name, O_RDWR | O_NOCTTY);
+    if (emu.slave_fd >= 0) {
+        struct termios tio;
+        if (tcgetattr(emu.slave_fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            tcsetattr(emu.slave_fd, TCSANOW, &tio);
+        }
+    }
+    fcntl(emu.master_fd, F_SETFL, fcntl(emu.master_fd, F_GETFL) | O_NONBLOCK);
+    if (options.link_path) {
+        unlink(options.link_path);
+        if (symlink(emu.slave_name, options.link_path) != 0) {
+            fprintf(stderr, "Cannot create %s, %s\n", options.link_path, strerror(errno));
+        }
+    }
+    printf("MIP/%s emulator on %s%s%s\n",
+            options.iface_type == LON_USB_INTERFACE_U50 ? "U50" : "U61", emu.slave_name,
+            options.link_path ? " -> " : "", options.link_path ? options.link_path : "");
+    fflush(stdout);
+
+    signal(SIGINT, StopHandler);
+    signal(SIGTERM, StopHandler);
+
+    // A MIP sends a reset message after power-up
+    emu.layer_mode = options.initial_mode;
+    emu.dl_last_seq = -1;
+    QueueResetMessage(&emu);
+    emu.start_us = emu.last_report_us = emu.ul_next_generate_us = NowMicroseconds();
+
+    while (!emulator_stop) {
+        struct pollfd pfd = {emu.master_fd, POLLIN, 0};
+        int timeout_ms = (options.uplink_rate || emu.ul_waiting_ack) ? 1 : 20;
+        if (poll(&pfd, 1, timeout_ms) > 0 && (pfd.revents & POLLIN)) {
+            uint8_t buf[4096];
+            ssize_t count = read(emu.master_fd, buf, sizeof(buf));
+            if (count > 0) {
+                ProcessDownlinkBytes(&emu, buf, (size_t)count);
+            } else if (count < 0 && errno != EAGAIN && errno != EINTR && errno != EIO) {
+                fprintf(stderr, "Cannot read from %s, %s\n", emu.slave_name,
+                        strerror(errno));
+                break;
+            }
+        }
+        uint64_t now = NowMicroseconds();
+        ServiceUplink(&emu, now);
+        if (options.report_interval &&
+                now - emu.last_report_us >= (uint64_t)options.report_interval * 1000000u) {
+            ReportStats(&emu, "Statistics");
+        }
+    }
+
+    ReportStats(&emu, "Final statistics");
+    if (options.link_path) {
+        unlink(options.link_path);
+    }
+    if (emu.slave_fd >= 0) {
+        close(emu.slave_fd);
+    }
+    close(emu.master_fd);
+    return 0;
+}
@@ -32,9 +32,60 @@ static IzotBool      commit_flag = FALSE;
 static IzotBool      scheduled = FALSE;
 static IzotBool      persistence_list[IzotPersistentSegNumSegmentTypes];
 
+#if STACK_STATIC_ALLOCATION
+// Largest application data segment of the static build
+#ifndef PERSISTENT_APP_DATA_MAX_SIZE
+#define PERSISTENT_APP_DATA_MAX_SIZE 1024
+#endif
+// Largest configuration tables of the network image
+#define PERSISTENT_TABLES_MAX_SIZE (NUM_ADDR_TBL_ENTRIES * sizeof(IzotAddress) + \
+        NV_TABLE_SIZE * sizeof(IzotDatapointConfig) + NV_ALIAS_TABLE_SIZE * sizeof(IzotAliasConfig))
+// Image buffer shared by all segments, which are stored and restored one at a time
+static IzotByte      persistent_image[sizeof(*eep) + PERSISTENT_TABLES_MAX_SIZE >
+                             PERSISTENT_APP_DATA_MAX_SIZE ?
+                             sizeof(*eep) + PERSISTENT_TABLES_MAX_SIZE :
+                             PERSISTENT_APP_DATA_MAX_SIZE];
+static IzotBool      persistent_image_in_use = FALSE;
+#endif  // STACK_STATIC_ALLOCATION
+
 /*****************************************************************
  * Section: Function Definitions
  *****************************************************************/
+/*
+ * Function: IzotPersistentImageAllocate
+ * This function returns a buffer for a serialized segment image.
+ */
+IzotByte *IzotPersistentImageAllocate(size_t length)
+{
+#if STACK_STATIC_ALLOCATION
+    if (persistent_image_in_use || length > sizeof(persistent_image)) {
+        OsalPrintLog(ERROR_LOG, LonStatusNoMemoryAvailable,
+                "IzotPersistentImageAllocate: No %u byte image buffer available",
+                (unsigned)length);
+        return NULL;
+    }
+    persistent_image_in_use = TRUE;
+    return persistent_image;
+#else
+    return (IzotByte *) OsalAllocateMemory(length);
+#endif  // STACK_STATIC_ALLOCATION
+}
+
+/*
+ * Function: IzotPersistentImageFree
+ * This function releases a buffer returned by IzotPersistentImageAllocate().
+ */
+void IzotPersistentImageFree(IzotByte *image)
+{
+#if STACK_STATIC_ALLOCATION
+    if (image == persistent_image) {
+        persistent_image_in_use = FALSE;
+    }
+#else
+    OsalFreeMemory(image);
+#endif  // STACK_STATIC_ALLOCATION
+}
+
 /*
  * Function: IzotPersistentMemGuardBandRemaining
  * This function calculates the time remaining for the flushing.
@@ -60,8 +111,10 @@ static LonStatusCode IzotPersistentSegDeserializeNetworkImage(
 {
     LonStatusCode status = LonStatusNoError;
     int image_length = IzotPersistentSegGetMaxSize(IzotPersistentSegNetworkImage);
+    size_t fixed_length = sizeof(*eep) - sizeof(eep->readOnlyData);
     if (len >= image_length) {
-        (void)memcpy((void*)(&eep->configData), (char* const)pData, image_length);
+        (void)memcpy((void*)(&eep->configData), (char* const)pData, fixed_length);
+        LCS_LoadConfigTables((const IzotByte *)pData + fixed_length);
     } else {
         status = LonStatusPersistentDataFailure;
         OsalPrintLog(ERROR_LOG, status,
@@ -79,9 +132,14 @@ static LonStatusCode IzotPersistentSegSerializeNetworkImage(
         IzotByte** pData, size_t *len)
 {
     size_t image_length = IzotPersistentSegGetMaxSize(IzotPersistentSegNetworkImage);
-    *pData = (IzotByte *) OsalAllocateMemory(image_length);
+    size_t fixed_length = sizeof(*eep) - sizeof(eep->readOnlyData);
+    *pData = IzotPersistentImageAllocate(image_length);
     *len = image_length;
-    memcpy((void *)*pData, (const void*)(&eep->configData), image_length);
+    if (*pData == NULL) {
+        return LonStatusNoMemoryAvailable;
+    }
+    memcpy((void *)*pData, (const void*)(&eep->configData), fixed_length);
+    LCS_SaveConfigTables(*pData + fixed_length);
     return LonStatusNoError;
 }
 
@@ -117,10 +175,12 @@ static LonStatusCode IzotPersistentSegSerializeAppDataImage(IzotByte** pData, si
 {
     size_t image_length = IzotPersistentSegGetMaxSize(IzotPersistentSegApplicationData);
     
-    *pData = (IzotByte *) OsalAllocateMemory(image_length);
+    *pData = IzotPersistentImageAllocate(image_length);
     *len = image_length;
     LonStatusCode status = LonStatusNoError;
-    if (izot_serialize_handler != NULL) {
+    if (*pData == NULL) {
+        status = LonStatusNoMemoryAvailable;
+    } else if (izot_serialize_handler != NULL) {
         status = izot_serialize_handler(*pData, image_length);
     } else {
         status = LonStatusStackNotInitialized;
@@ -180,9 +240,9 @@ static LonStatusCode IzotPersistentSegStore(IzotPersistentSegType persistent_seg
             OsalPrintLog(INFO_LOG, status, "IzotPersistentSegStore: %s segment stored successfully", 
                     IzotPersistentGetSegName(persistent_seg_type));
         }
-        if (segment_image != NULL) {
-            OsalFreeMemory(segment_image);
-        }
+    }
+    if (segment_image != NULL) {
+        IzotPersistentImageFree(segment_image);
     }
     return status;
 }
@@ -388,7 +448,7 @@ LonStatusCode IzotPersistentSegRestore(IzotPersistentSegType persistent_seg_type
                         hdr.version, IzotPersistentGetSegName(persistent_seg_type));
             } else {
                 image_length = hdr.length;
-                segment_image = (IzotByte *) OsalAllocateMemory(image_length);
+                segment_image = IzotPersistentImageAllocate(image_length);
                 if (segment_image == NULL ||
                     IzotPersistentSegRead(persistent_seg_type, sizeof(PersistentTransactionRecord) + sizeof(hdr), image_length, segment_image) != 0 ||
                     !ValidatePersistenceChecksum(&hdr, segment_image)) {
@@ -396,7 +456,7 @@ LonStatusCode IzotPersistentSegRestore(IzotPersistentSegType persistent_seg_type
                     OsalPrintLog(ERROR_LOG, status,
                             "IzotPersistentSegRestore: Checksum validation failed for segment %s",
                             IzotPersistentGetSegName(persistent_seg_type));
-                    OsalFreeMemory(segment_image);
+                    IzotPersistentImageFree(segment_image);
                     segment_image = NULL;
                 }
             }
@@ -438,7 +498,7 @@ LonStatusCode IzotPersistentSegRestore(IzotPersistentSegType persistent_seg_type
     }
     
     if (segment_image != NULL) {
-        OsalFreeMemory(segment_image);
+        IzotPersistentImageFree(segment_image);
     }
     
     return status;